@@ -52,15 +52,97 @@
 //   conversion operations. Otherwise (default), single precision floating
 //   point (float) is used. For most use cases, the default is preferred.
 //
+// * VIBRANT_DETERMINISTIC
+//   If defined, color conversion does not use math.h, and is compiled with
+//   strict IEEE 754 semantics, so results are bit identical across libm
+//   versions, compilers and -ffast-math. Otherwise (default), math.h is used,
+//   which is faster.
+//
+// * VIBRANT_FIXED_POINT
+//   If defined, hsl, hwb, lab, lch, oklab and oklch colors are converted to
+//   sRGB with integer arithmetic, for targets without an FPU. vbt_number_t
+//   stays a float, so this is not integer end to end:
+//   - vbt_parse(), vbt_color_resolve(), vbt_rgb() and the other color
+//     functions, their batches and vbt::parse() call no math.h function.
+//     They still read numbers, scale and clamp arguments, and convert them
+//     to fixed point in float arithmetic, a few operations per argument.
+//   - color-mix() in any space but srgb, and relative colors whose origin
+//     is of another function, convert colors with the floating point
+//     functions of vbt_to_oklab() and the others.
+//   - vbt_to_*(), vbt_in_gamut_batch(), vbt_delta_e*(), vbt_interpolate_n()
+//     and vbt_gradient_bake() are floating point, with math.h.
+//   Colors resolve to u8, within 1 of the floating point result, so float
+//   receivers get n / 255. Lab a, b and chroma saturate at +-4096, OKLab a,
+//   b and chroma at +-8. Can not be combined with VIBRANT_DETERMINISTIC,
+//   which it already is. Otherwise (default), floating point is used.
+//
+// * VIBRANT_GAMUT_MAP
+//   If defined, lab, lch, oklab and oklch colors outside of sRGB are mapped
+//   into it with the CSS Color 4 algorithm, which lowers the Oklch chroma at
+//   constant lightness and hue until the color clips to a just noticeable
+//   difference. This is a binary search of about 12 steps, and is only run
+//   for colors outside of sRGB. Otherwise (default), each channel is
+//   clamped, which may shift the hue. Can not be combined with
+//   VIBRANT_FIXED_POINT.
+//
+// * VIBRANT_GAMUT_MAP_FAST
+//   If defined, implies VIBRANT_GAMUT_MAP, but approximates the sRGB gamut
+//   by a triangle from black to white through a cusp, looked up in a table
+//   of hue buckets. The chroma is lowered to the triangle edge in a single
+//   step, and channels that are still out of range are clamped. For colors
+//   outside of sRGB, this is about 3x faster than VIBRANT_GAMUT_MAP, and 2x
+//   slower than clamping.
+//
+// * VIBRANT_THREADS
+//   If defined, add vbt_pool_t and the multi-threaded *_batch_mt functions.
+//   Requires pthreads (-pthread), so it is not available with MSVC.
+//   Otherwise (default), vibrant does not create threads or allocate memory.
+//
+// * VIBRANT_EXECUTION
+//   If defined, and compiled as C++17 or later, add the vbt::transform_*
+//   functions, which take a standard execution policy. This includes
+//   <execution>, which with libstdc++ may need linking to TBB (-ltbb).
+//
+// * VIBRANT_RANGES
+//   If defined, and compiled as C++20 or later, add the vbt::views range
+//   adaptors. This includes <ranges> and <optional>.
+//
+// * VIBRANT_SCAN
+//   If defined, and compiled as C++20 or later, add the vbt::scan_generator
+//   coroutine. This includes <coroutine>.
+//
+// * VIBRANT_CONSTEXPR
+//   If defined, and compiled as C++14 or later, the parser and conversions
+//   are compiled as constexpr into the including file, for the
+//   compile time vbt::parse() and vbt::relative(). Otherwise (default), they
+//   are only compiled with the implementation.
+//
+// C++
+//
+// With VIBRANT_CONSTEXPR and C++14 or later, vbt::parse() parses a color in
+// a constant expression, with the configuration of the including file, and
+// invalid colors fail to compile. vbt::parse(value, len, out) and
+// vbt::parse(array, out) return VBT_ERR for them instead, and call the
+// implementation at runtime. vbt::relative() does the same for a relative
+// color and an origin. vbt::literals provides vbt::parse() as a
+// user-defined literal:
+//
+//   #define VIBRANT_CONSTEXPR
+//   #include "vibrant.h"
+//
+//   using namespace vbt::literals;
+//   constexpr vbt::rgba8 a = vbt::parse("oklch(70% 0.1 200)");
+//   constexpr vbt::rgba8 b = "cornflowerblue"_vbt;
+//
 
 #ifndef VIBRANT_H
 #define VIBRANT_H
 
 #ifdef __cplusplus
-#include <cinttypes>  // uint8_t
+#include <cinttypes>  // uint8_t, uint16_t
 #include <cstddef>    // size_t
 #else
-#include <inttypes.h>  // uint8_t
+#include <inttypes.h>  // uint8_t, uint16_t
 #include <stddef.h>    // size_t
 #endif
 
@@ -80,6 +162,7 @@ extern "C" {
 #endif
 
 typedef uint8_t vbt_u8_t;
+typedef uint16_t vbt_u16_t;
 typedef size_t vbt_size_t;
 
 #if defined(VIBRANT_DOUBLE_PRECISION)
@@ -169,6 +252,101 @@ typedef struct vbt_recv_t {
 #endif
 } vbt_recv_t;
 
+// Color functions, and therefore colorspaces, supported by vibrant.
+typedef enum vbt_color_fn_t {
+  VBT_COLOR_NONE = 0,
+  // sRGB with components [0-255]. hex colors and css color names are
+  // parsed into this function.
+  VBT_COLOR_RGB,
+  VBT_COLOR_HSL,
+  VBT_COLOR_HWB,
+  VBT_COLOR_LCH,
+  VBT_COLOR_LAB,
+  VBT_COLOR_OKLCH,
+  VBT_COLOR_OKLAB,
+} vbt_color_fn_t;
+
+// Unit of a color function argument, as written in a color string.
+typedef enum vbt_unit_t {
+  VBT_UNIT_UNSET = 0,
+  VBT_UNIT_PERCENT,
+  VBT_UNIT_NUMBER,
+} vbt_unit_t;
+
+// Color difference formulas, see vbt_delta_e().
+typedef enum vbt_delta_e_t {
+  // CIE76, the distance in Lab
+  VBT_DELTA_E_76 = 0,
+  // CIEDE2000, in Lab, weighted to match how differences are perceived
+  VBT_DELTA_E_2000,
+  // the distance in Oklab, where 0.02 is about a just noticeable difference
+  VBT_DELTA_E_OK,
+} vbt_delta_e_t;
+
+// Color spaces to interpolate in, see vbt_interpolate_n(). These are the
+// <color-space> names of CSS Color 4 color-mix() and gradients.
+typedef enum vbt_space_t {
+  VBT_SPACE_SRGB = 0,
+  VBT_SPACE_SRGB_LINEAR,
+  VBT_SPACE_LAB,
+  VBT_SPACE_LCH,
+  VBT_SPACE_OKLAB,
+  VBT_SPACE_OKLCH,
+} vbt_space_t;
+
+// How hues are interpolated in VBT_SPACE_LCH and VBT_SPACE_OKLCH, the
+// <hue-interpolation-method> of CSS Color 4.
+typedef enum vbt_hue_method_t {
+  // the shorter arc of the hue circle, the CSS default
+  VBT_HUE_SHORTER = 0,
+  VBT_HUE_LONGER,
+  VBT_HUE_INCREASING,
+  VBT_HUE_DECREASING,
+} vbt_hue_method_t;
+
+// Texel formats of vbt_gradient_bake().
+typedef enum vbt_texel_format_t {
+  // 4 vbt_u8_t per texel, gamma encoded sRGB, e.g. for GL_SRGB8_ALPHA8
+  VBT_TEXEL_RGBA8 = 0,
+  // 4 vbt_u16_t IEEE 754 half floats per texel, linear-light sRGB
+  VBT_TEXEL_RGBA16F,
+  // 4 floats per texel, linear-light sRGB
+  VBT_TEXEL_RGBA32F,
+} vbt_texel_format_t;
+
+// A color in one of the colorspaces supported by vibrant. The color is
+// converted to sRGB on demand.
+//
+// arg holds the arguments of fn normalized to the ranges the matching
+// conversion function takes, ie "oklch(50% 0.1 200)" is held as fn
+// VBT_COLOR_OKLCH and arg {0.5, 0.1, 200, 1}, the arguments of
+// vbt_oklch(). unit records how each argument was written.
+//
+// The sRGB conversion runs the first time the color is resolved with
+// vbt_color_resolve(). The result is memoized in the object, so resolving
+// the color again, into any receiver, does no color math.
+//
+// Use vbt_color_init() to create a color from arguments. If fn or arg are
+// changed after a color was resolved, the color must be re-inited.
+typedef struct vbt_color_t {
+  vbt_color_fn_t fn;
+  vbt_number_t arg[4];
+  vbt_unit_t unit[4];
+  // memoized sRGB color, managed by vibrant
+  int resolved;
+  union {
+    vbt_u8_t u8[4];
+    vbt_number_t n[4];
+  } srgb;
+} vbt_color_t;
+
+// A gradient color stop, see vbt_gradient_bake().
+typedef struct vbt_gradient_stop_t {
+  vbt_color_t color;
+  // [0-1] along the gradient
+  vbt_number_t position;
+} vbt_gradient_stop_t;
+
 #ifndef VIBRANT_NO_PARSE
 
 // Parse a CSS-like color string into the sRGB colorspace.
@@ -192,6 +370,19 @@ typedef struct vbt_recv_t {
 //         rgb(255 255 255 / 50%), or using the function name suffixed with
 //         "a", rgba(255, 255, 255, 50%). alpha can be expressed as 0-1 or
 //         0%-100%.
+//
+//   any argument can be calc() with + - * / and parentheses, e.g.
+//   rgb(calc(255 / 2) 0 calc(10% * 5)). numbers and percentages can be
+//   multiplied, and divided by numbers, but not added. calc() is folded to
+//   a plain argument while parsing.
+//
+// color-mix(in <space> [<hue> hue], <color> [<p>%], <color> [<p>%]) - mix of
+//   two colors as in CSS Color 5, e.g. color-mix(in oklab, red 30%, #00f).
+//   space is srgb, srgb-linear, lab, lch, oklab or oklch, and hue is
+//   shorter, longer, increasing or decreasing, for lch and oklch. colors may
+//   be any color, including another color-mix(). the mix is done while
+//   parsing, in the native arguments of colors already in the space, and the
+//   result is a color of that space, converted to sRGB once when resolved.
 // @param recv
 // @returns VBT_SUCCESS: color successfully parsed and set in recv
 //          VBT_ERR: error parsing string or invalid arguments
@@ -199,6 +390,229 @@ VBTDEF int vbt_parse(const char* value, vbt_size_t len, vbt_recv_t* recv);
 
 VBTDEF int vbt_parse_z(const char* value, vbt_recv_t* recv);
 
+// Checks whether a string is a color vbt_parse() would accept, without
+// producing the color.
+//
+// No numeric conversion or color math is performed, which makes this the
+// cheapest way to answer "is this a color?" when the rgb value is not
+// needed (linting, input sanitizing, etc).
+//
+// @returns VBT_SUCCESS: value is a valid color string
+//          VBT_ERR: value is not a valid color string or invalid arguments
+VBTDEF int vbt_validate(const char* value, vbt_size_t len);
+
+VBTDEF int vbt_validate_z(const char* value);
+
+// Parse a CSS-like color string into a vbt_color_t, without converting it
+// to sRGB. Accepts the same strings as vbt_parse().
+//
+// Use vbt_color_resolve() to convert the color when it is needed.
+//
+// @param color
+// @returns VBT_SUCCESS: color successfully parsed and set in color
+//          VBT_ERR: error parsing string or invalid arguments
+VBTDEF int vbt_parse_color(const char* value,
+                           vbt_size_t len,
+                           vbt_color_t* color);
+
+VBTDEF int vbt_parse_color_z(const char* value, vbt_color_t* color);
+
+// limits of a compiled relative color, not part of the API
+#define VBT__RELATIVE_MAX_OPS (64)
+#define VBT__RELATIVE_MAX_CONSTS (16)
+
+// A CSS relative color, compiled by vbt_relative_compile() into a small
+// stack machine program. Its fields are managed by vibrant, and one that
+// was not compiled is verified and refused when it is applied.
+typedef struct vbt_relative_t {
+  vbt_color_fn_t fn;
+  vbt_u8_t op_count;
+  vbt_u8_t ops[VBT__RELATIVE_MAX_OPS];
+  vbt_number_t consts[VBT__RELATIVE_MAX_CONSTS];
+} vbt_relative_t;
+
+// Compiles a CSS relative color once, to apply it to any number of origin
+// colors with vbt_relative_apply() or vbt_relative_apply_batch(), without
+// parsing it again.
+//
+// <fn>(from <origin> <channel> <channel> <channel> [/ <channel>])
+//
+// fn is one of the functions of vbt_parse(). origin is a placeholder, var or
+// var(...), for the color the template is applied to. each channel is a
+// number or percentage, a channel keyword of fn (r, g, b for rgb(), h, s, l
+// for hsl(), l, c, h for oklch(), ...) or alpha, or calc() of numbers,
+// percentages and channel keywords with + - * / and parentheses, parsed
+// like calc() arguments, where channel keywords are numbers and a
+// percentage result scales like a percentage argument of fn. the alpha
+// channel defaults to the alpha of the origin. channel keywords are the
+// origin's arguments in fn: arguments as written for an origin of fn,
+// otherwise converted from sRGB like vbt_to_oklch() and the others do.
+//
+// vbt_relative_t rel;
+// vbt_relative_compile_z("oklch(from var l c calc(h + 180))", &rel);
+// vbt_relative_apply_batch(&rel, base, 10000, complements, NULL);
+//
+// @param rel
+// @returns VBT_SUCCESS: relative color successfully compiled
+//          VBT_ERR: error parsing string, a limit exceeded or invalid
+//                   arguments
+VBTDEF int vbt_relative_compile(const char* value,
+                                vbt_size_t len,
+                                vbt_relative_t* rel);
+
+VBTDEF int vbt_relative_compile_z(const char* value, vbt_relative_t* rel);
+
+// Applies rel to origin. color is a color of rel's function, not resolved,
+// see vbt_parse_color().
+//
+// @param rel
+// @param origin
+// @param color
+// @returns VBT_SUCCESS: color successfully set
+//          VBT_ERR: origin can't be converted, rel is not a compiled
+//                   program or invalid arguments
+VBTDEF int vbt_relative_apply(const vbt_relative_t* rel,
+                              vbt_color_t* origin,
+                              vbt_color_t* color);
+
+// Batch version of vbt_relative_apply(). origins[i] is applied into
+// colors[i], and its result is written to err[i]. The program runs once per
+// chunk of colors, each instruction over the whole chunk, so the cost of
+// interpreting it is shared and the arithmetic vectorizes. The program is
+// verified once per call before it runs.
+//
+// @param err per item VBT_SUCCESS or VBT_ERR, can be NULL
+// @returns VBT_SUCCESS: all items successfully applied
+//          VBT_ERR: at least one item failed or invalid arguments
+VBTDEF int vbt_relative_apply_batch(const vbt_relative_t* rel,
+                                    vbt_color_t* origins,
+                                    vbt_size_t count,
+                                    vbt_color_t* colors,
+                                    int* err);
+
+// limits of a custom property, not part of the API
+#define VBT__VAR_MAX_NAME (64)
+#define VBT__VAR_MAX_VALUE (128)
+#define VBT__VAR_MAX_DEPS (16)
+
+// A custom property of a vbt_vars_t. Its fields are managed by vibrant.
+typedef struct vbt_var_t {
+  char name[VBT__VAR_MAX_NAME];
+  char value[VBT__VAR_MAX_VALUE];
+  vbt_u8_t name_len;
+  vbt_u8_t value_len;
+  vbt_u8_t defined;
+  vbt_u8_t state;
+  vbt_u8_t dep_count;
+  uint32_t hash;
+  uint32_t bucket;  // 1 + first property of the hash bucket of this slot
+  uint32_t next;    // 1 + next property in the bucket of this one
+  uint32_t stamp;
+  uint32_t deps[VBT__VAR_MAX_DEPS];
+  uint32_t dep_stamps[VBT__VAR_MAX_DEPS];
+  vbt_color_t color;
+} vbt_var_t;
+
+// Custom properties, the --name of var(--name) in CSS, stored in the array
+// given to vbt_vars_init(). Its fields are managed by vibrant.
+typedef struct vbt_vars_t {
+  vbt_var_t* vars;
+  vbt_size_t count;
+  vbt_size_t capacity;
+  uint32_t stamp;
+} vbt_vars_t;
+
+// Initializes vars with storage for capacity custom properties. Each
+// definition, and each name referenced before it is defined, takes one.
+//
+// Custom properties hold text, substituted for var(<name> [, <fallback>])
+// as in CSS: the fallback is used when name is not defined or invalid, and
+// properties that reference each other in a cycle are invalid. The color a
+// property resolves to is cached, along with the properties it references,
+// and is only resolved again once one of them changes, cycles included.
+// vars is not thread safe.
+//
+// vbt_var_t storage[256];
+// vbt_vars_t vars;
+// vbt_vars_init(&vars, storage, 256);
+// vbt_vars_define_z(&vars, "--hue", "250");
+// vbt_vars_define_z(&vars, "--accent", "oklch(0.7 0.1 var(--hue))");
+// vbt_parse_vars_z(&vars, "var(--accent)", &recv);
+//
+// @param vars
+// @param storage
+// @param capacity
+// @returns VBT_SUCCESS: vars successfully initialized
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_vars_init(vbt_vars_t* vars,
+                         vbt_var_t* storage,
+                         vbt_size_t capacity);
+
+// Defines the custom property name as value, or removes its definition when
+// value is NULL. Both are copied. Colors that reference name are resolved
+// again the next time they are used, unless value is unchanged. Removing a
+// property that was never defined takes no room in vars.
+//
+// @param vars
+// @param name starts with "--", at most 64 bytes
+// @param value at most 128 bytes
+// @returns VBT_SUCCESS: property successfully defined
+//          VBT_ERR: vars full or invalid arguments
+VBTDEF int vbt_vars_define(vbt_vars_t* vars,
+                           const char* name,
+                           vbt_size_t name_len,
+                           const char* value,
+                           vbt_size_t value_len);
+
+VBTDEF int vbt_vars_define_z(vbt_vars_t* vars,
+                             const char* name,
+                             const char* value);
+
+// Gets the color the custom property name resolves to, from the cache
+// when nothing it references has changed. color is not resolved, see
+// vbt_parse_color().
+//
+// @param vars
+// @param color
+// @returns VBT_SUCCESS: color successfully set
+//          VBT_ERR: name is not defined, is invalid, is not a color or
+//                   invalid arguments
+VBTDEF int vbt_vars_get(vbt_vars_t* vars,
+                        const char* name,
+                        vbt_size_t len,
+                        vbt_color_t* color);
+
+VBTDEF int vbt_vars_get_z(vbt_vars_t* vars,
+                          const char* name,
+                          vbt_color_t* color);
+
+// vbt_parse() with var() references resolved in vars. A value that is a
+// single var() is served from the cache.
+//
+// @param vars
+// @param recv
+// @returns VBT_SUCCESS: color successfully parsed and set in recv
+//          VBT_ERR: error parsing string, an invalid var() without a
+//                   fallback or invalid arguments
+VBTDEF int vbt_parse_vars(vbt_vars_t* vars,
+                          const char* value,
+                          vbt_size_t len,
+                          vbt_recv_t* recv);
+
+VBTDEF int vbt_parse_vars_z(vbt_vars_t* vars,
+                            const char* value,
+                            vbt_recv_t* recv);
+
+// vbt_parse_color() with var() references resolved in vars.
+VBTDEF int vbt_parse_color_vars(vbt_vars_t* vars,
+                                const char* value,
+                                vbt_size_t len,
+                                vbt_color_t* color);
+
+VBTDEF int vbt_parse_color_vars_z(vbt_vars_t* vars,
+                                  const char* value,
+                                  vbt_color_t* color);
+
 #endif  // VIBRANT_NO_PARSE
 
 // Builds an sRGB color from components.
@@ -375,12 +789,272 @@ VBTDEF int vbt_oklab(vbt_number_t lightness,
                      vbt_number_t alpha,
                      vbt_recv_t* recv);
 
+// Converts color to sRGB, unless the conversion is already memoized in
+// color, and sets it in recv.
+//
+// @param color
+// @param recv
+// @returns VBT_SUCCESS: color successfully converted and set in recv
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_color_resolve(vbt_color_t* color, vbt_recv_t* recv);
+
+// Converts color to sRGB and memoizes the result in color, without setting
+// it anywhere. vbt_color_resolve() does this before it writes to recv.
+//
+// @param color
+// @returns VBT_SUCCESS: color successfully converted
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_color_eval(vbt_color_t* color);
+
+// Inverse conversions. Each converts color to sRGB, see vbt_color_eval(),
+// and from there to another color space. out receives the arguments of the
+// matching function plus alpha, and passing them back gives the same color:
+//
+// vbt_number_t lch[4];
+// vbt_to_oklch(&color, lch);
+// vbt_oklch(lch[0], lch[1], lch[2], lch[3], &recv);
+//
+// hue is in [0-360), and 0 for grays. hsl and hwb components are in
+// [0-100], oklab and oklch lightness in [0-1].
+//
+// @param color
+// @param out 4 numbers
+// @returns VBT_SUCCESS: color successfully converted
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_to_hsl(vbt_color_t* color, vbt_number_t* out);
+VBTDEF int vbt_to_hwb(vbt_color_t* color, vbt_number_t* out);
+VBTDEF int vbt_to_lab(vbt_color_t* color, vbt_number_t* out);
+VBTDEF int vbt_to_lch(vbt_color_t* color, vbt_number_t* out);
+VBTDEF int vbt_to_oklab(vbt_color_t* color, vbt_number_t* out);
+VBTDEF int vbt_to_oklch(vbt_color_t* color, vbt_number_t* out);
+
+// Batch versions of the inverse conversions, for sRGB already in memory.
+// rgba holds count colors of 4 [0-1] numbers, and out receives 4 numbers
+// per color. The loops have no branches, only selects, so that compilers
+// can vectorize them, math.h calls included with a vector math library,
+// e.g. gcc -O3 -ffast-math with glibc.
+//
+// @param rgba
+// @param count
+// @param out
+// @returns VBT_SUCCESS: colors successfully converted
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_to_hsl_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out);
+VBTDEF int vbt_to_hwb_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out);
+VBTDEF int vbt_to_lab_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out);
+VBTDEF int vbt_to_lch_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out);
+VBTDEF int vbt_to_oklab_batch(const vbt_number_t* rgba,
+                              vbt_size_t count,
+                              vbt_number_t* out);
+VBTDEF int vbt_to_oklch_batch(const vbt_number_t* rgba,
+                              vbt_size_t count,
+                              vbt_number_t* out);
+
+// Tests a batch of colors for being inside of sRGB, which is when converting
+// them does not clamp. Only the linear-light sRGB stage of the conversion is
+// run, with no transfer function and no receiver. args holds count colors of
+// 4 numbers, the arguments of the fn function plus alpha, which is ignored.
+// Bit i % 8 of mask[i / 8] is set when color i is inside of sRGB, and unused
+// bits of the last byte are cleared. Invalid colors are outside.
+//
+// uint8_t mask[(1000 + 7) / 8];
+// vbt_in_gamut_batch(VBT_COLOR_OKLCH, oklch, 1000, mask);
+//
+// @param fn VBT_COLOR_LAB, VBT_COLOR_LCH, VBT_COLOR_OKLAB or VBT_COLOR_OKLCH
+// @param args
+// @param count
+// @param mask (count + 7) / 8 bytes
+// @returns VBT_SUCCESS: colors successfully tested
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_in_gamut_batch(vbt_color_fn_t fn,
+                              const vbt_number_t* args,
+                              vbt_size_t count,
+                              vbt_u8_t* mask);
+
+// Difference between colors a and b, converted to Lab for VBT_DELTA_E_76
+// and VBT_DELTA_E_2000, or to Oklab for VBT_DELTA_E_OK.
+//
+// @param metric
+// @param a
+// @param b
+// @param out
+// @returns VBT_SUCCESS: difference successfully computed
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_delta_e(vbt_delta_e_t metric,
+                       vbt_color_t* a,
+                       vbt_color_t* b,
+                       vbt_number_t* out);
+
+// Batch versions of vbt_delta_e(), for colors already in Lab (or Oklab for
+// VBT_DELTA_E_OK), e.g. from vbt_to_lab_batch(). Colors are 4 numbers, and
+// alpha is ignored. vbt_delta_e_batch() compares x[i] to y[i], and
+// vbt_delta_e_ref_batch() compares the single color ref to each y[i]. out
+// receives a number per color. Like the other batches, the loops vectorize.
+//
+// vbt_number_t lab[1000 * 4], diff[1000];
+// vbt_to_lab_batch(rgba, 1000, lab);
+// vbt_delta_e_ref_batch(VBT_DELTA_E_2000, &lab[0], lab, 1000, diff);
+//
+// @param metric
+// @param x (or ref)
+// @param y
+// @param count
+// @param out
+// @returns VBT_SUCCESS: differences successfully computed
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_delta_e_batch(vbt_delta_e_t metric,
+                             const vbt_number_t* x,
+                             const vbt_number_t* y,
+                             vbt_size_t count,
+                             vbt_number_t* out);
+VBTDEF int vbt_delta_e_ref_batch(vbt_delta_e_t metric,
+                                 const vbt_number_t* ref,
+                                 const vbt_number_t* y,
+                                 vbt_size_t count,
+                                 vbt_number_t* out);
+
+// Interpolates count colors between evenly spaced stops in space, as CSS
+// Color 4 does for color-mix() and gradients, e.g. for a gradient ramp. The
+// first color is stops[0] and the last is stops[stop_count - 1]. out
+// receives 4 [0-1] sRGB numbers per color, the same as vbt_color_resolve()
+// gives for the interpolated color.
+//
+// Stops in space, or in its polar or rectangular form, are interpolated from
+// their arguments, other stops from their sRGB value. A hue of a color with
+// no chroma takes the hue of the other stop. Each segment between two stops
+// is a constant step per color, and the loop vectorizes like the batches.
+// Hues are converted like vbt_color_resolve() does: colors with an integer
+// hue are converted again afterwards, with its table of sin and cos.
+//
+// vbt_number_t ramp[256 * 4];
+// vbt_interpolate_n(VBT_SPACE_OKLCH, VBT_HUE_SHORTER, 1, stops, 2, 256, ramp);
+//
+// @param space
+// @param hue VBT_HUE_*, for VBT_SPACE_LCH and VBT_SPACE_OKLCH
+// @param premultiplied 1 to interpolate with premultiplied alpha, as CSS does
+// @param stops
+// @param stop_count at least 2
+// @param count
+// @param out count * 4 numbers
+// @returns VBT_SUCCESS: colors successfully interpolated
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_interpolate_n(vbt_space_t space,
+                             vbt_hue_method_t hue,
+                             int premultiplied,
+                             vbt_color_t* stops,
+                             vbt_size_t stop_count,
+                             vbt_size_t count,
+                             vbt_number_t* out);
+
+// Bakes a gradient into a 1D texture of width texels, like a CSS
+// linear-gradient() with premultiplied alpha. Texel i is the gradient at its
+// center, (i + 0.5) / width. Before the first stop and after the last the
+// gradient is the color of that stop, and a position less than the one
+// before it is moved to it, as in CSS. Colors are interpolated like
+// vbt_interpolate_n() does, and written straight into texels, in chunks
+// that vectorize.
+//
+// Dithering adds a different offset under 1 to the color of each RGBA8 texel
+// before it is rounded down, in a golden ratio sequence, which hides the
+// banding of smooth gradients in 8 bits. Alpha is rounded, as a dithered
+// alpha would show through as noise. The float formats are not dithered.
+//
+// vbt_u8_t texels[256 * 4];
+// vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 3,
+//                   VBT_TEXEL_RGBA8, 1, 256, texels);
+//
+// @param space
+// @param hue VBT_HUE_*, for VBT_SPACE_LCH and VBT_SPACE_OKLCH
+// @param stops
+// @param stop_count at least 1
+// @param format
+// @param dither 1 to dither VBT_TEXEL_RGBA8
+// @param width
+// @param texels width texels of format
+// @returns VBT_SUCCESS: gradient successfully baked
+//          VBT_ERR: invalid arguments
+VBTDEF int vbt_gradient_bake(vbt_space_t space,
+                             vbt_hue_method_t hue,
+                             vbt_gradient_stop_t* stops,
+                             vbt_size_t stop_count,
+                             vbt_texel_format_t format,
+                             int dither,
+                             vbt_size_t width,
+                             void* texels);
+
+// Batch versions of vbt_parse() and vbt_color_resolve(). Item i is read from
+// values[i] (or colors[i]) and written to recv[i], and its result to err[i].
+//
+// @param lens lengths of values, or NULL if values are zero terminated
+// @param err per item VBT_SUCCESS or VBT_ERR, can be NULL
+// @returns VBT_SUCCESS: all items successfully converted
+//          VBT_ERR: at least one item failed or invalid arguments
+VBTDEF int vbt_color_resolve_batch(vbt_color_t* colors,
+                                   vbt_size_t count,
+                                   vbt_recv_t* recv,
+                                   int* err);
+
+#ifndef VIBRANT_NO_PARSE
+VBTDEF int vbt_parse_batch(const char* const* values,
+                           const vbt_size_t* lens,
+                           vbt_size_t count,
+                           vbt_recv_t* recv,
+                           int* err);
+#endif  // VIBRANT_NO_PARSE
+
+#ifdef VIBRANT_THREADS
+
+// A pthread pool for the *_batch_mt functions. A batch is split into chunks
+// which are spread over the workers, and idle workers steal chunks from busy
+// ones, so skewed inputs still keep every core busy. The calling thread is
+// one of the workers. A pool runs one batch at a time, concurrent calls wait.
+typedef struct vbt_pool_t vbt_pool_t;
+
+// @param threads number of workers, 0 for one per online cpu
+// @returns the pool, or NULL if it could not be created
+VBTDEF vbt_pool_t* vbt_pool_create(unsigned threads);
+
+VBTDEF void vbt_pool_destroy(vbt_pool_t* pool);
+
+// Destroys the built-in pool used when *_batch_mt() is given a NULL pool,
+// e.g. before unloading a library. It is created again on its next use.
+// Must not be called while a *_batch_mt() call is using it.
+VBTDEF void vbt_pool_destroy_default(void);
+
+// Same as vbt_color_resolve_batch() and vbt_parse_batch(), run on pool. The
+// output is identical to the single threaded functions. When pool is NULL,
+// a built-in pool with one worker per online cpu is used.
+VBTDEF int vbt_color_resolve_batch_mt(vbt_pool_t* pool,
+                                      vbt_color_t* colors,
+                                      vbt_size_t count,
+                                      vbt_recv_t* recv,
+                                      int* err);
+
+#ifndef VIBRANT_NO_PARSE
+VBTDEF int vbt_parse_batch_mt(vbt_pool_t* pool,
+                              const char* const* values,
+                              const vbt_size_t* lens,
+                              vbt_size_t count,
+                              vbt_recv_t* recv,
+                              int* err);
+#endif  // VIBRANT_NO_PARSE
+
+#endif  // VIBRANT_THREADS
+
 #ifdef __cplusplus
 }
 #endif
 
-// Utility functions/macros for initing vbt_recv_t objects across
-// C and C++ builds.
+// Utility functions/macros for initing vbt_recv_t and vbt_color_t objects
+// across C and C++ builds.
 #ifdef __cplusplus
 inline vbt_recv_t vbt_recv_init() noexcept {
   return {};
@@ -406,6 +1080,22 @@ inline vbt_recv_t vbt_recv_init_ref_f64(double* r,
                                         double* a) noexcept {
   return {r, g, b, a};
 }
+inline vbt_color_t vbt_color_init(vbt_color_fn_t fn,
+                                  vbt_number_t arg0,
+                                  vbt_number_t arg1,
+                                  vbt_number_t arg2,
+                                  vbt_number_t alpha) noexcept {
+  vbt_color_t color{};
+  color.fn = fn;
+  color.arg[0] = arg0;
+  color.arg[1] = arg1;
+  color.arg[2] = arg2;
+  color.arg[3] = alpha;
+  for (vbt_unit_t& unit : color.unit) {
+    unit = VBT_UNIT_NUMBER;
+  }
+  return color;
+}
 #else
 #define vbt_recv_init() vbt_recv_init_tag(VBT_RECV_VAL_U8)
 #define vbt_recv_init_tag(TAG) \
@@ -416,327 +1106,7152 @@ inline vbt_recv_t vbt_recv_init_ref_f64(double* r,
   ((vbt_recv_t){.tag = VBT_RECV_REF_F32, .u.ref.f32 = {R, G, B, A}})
 #define vbt_recv_init_ref_f64(R, G, B, A) \
   ((vbt_recv_t){.tag = VBT_RECV_REF_F64, .u.ref.f64 = {R, G, B, A}})
+#define vbt_color_init(FN, ARG0, ARG1, ARG2, ALPHA)         \
+  ((vbt_color_t){.fn = FN,                                  \
+                 .arg = {ARG0, ARG1, ARG2, ALPHA},          \
+                 .unit = {VBT_UNIT_NUMBER, VBT_UNIT_NUMBER, \
+                          VBT_UNIT_NUMBER, VBT_UNIT_NUMBER}})
 #endif
 
-#endif  // VIBRANT_H
-
-#ifdef VIBRANT_IMPLEMENTATION
+// vbt_color_t.resolved
+#define VBT__RESOLVED_NONE (0)
+#define VBT__RESOLVED_U8 (1)
+#define VBT__RESOLVED_01 (2)
 
-#ifdef __cplusplus
-#include <cmath>  // fmod, isfinite, pow, cos, sin
+#if defined(_MSC_VER) && !defined(__cplusplus)
+#define VBT__INLINE __inline
 #else
-#include <math.h>  // fmod, isfinite, pow, cos, sin
+#define VBT__INLINE inline
 #endif
 
-#if defined(VIBRANT_DOUBLE_PRECISION)
-#define vbt__fmod fmod
-#define vbt__pow pow
-#define vbt__cos cos
-#define vbt__sin sin
-#define vbt__cbrt cbrt
-#else
-#define vbt__fmod fmodf
-#define vbt__pow powf
-#define vbt__cos cosf
-#define vbt__sin sinf
-#define vbt__cbrt cbrtf
-#endif
-#ifdef __cplusplus
-#define vbt__isfinite std::isfinite
+// VIBRANT_CONSTEXPR compiles the core of the implementation as constexpr,
+// see vbt::parse()
+#if defined(VIBRANT_CONSTEXPR) && !defined(VIBRANT_NO_PARSE) && \
+    defined(__cplusplus) &&                                      \
+    (__cplusplus >= 201402L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201402L))
+#define VBT__CONSTEXPR_CORE
+#define VBT__CONSTEXPR constexpr
 #else
-#define vbt__isfinite isfinite
+#define VBT__CONSTEXPR
 #endif
 
-#define VBT__PI ((vbt_number_t)3.14159265358979323846)
-
-// sRGB D65 reference white
-#define VBT__D65_X ((vbt_number_t)0.95047)
-#define VBT__D65_Y ((vbt_number_t)1.0)
-#define VBT__D65_Z ((vbt_number_t)1.08883)
+// Typed receivers. These write a color straight into rgba[4], or into a
+// packed 0xRRGGBBAA uint32_t, with no vbt_recv_t and no tag dispatch. The
+// values are the same as the matching VBT_RECV_VAL_* receiver.
+//
+// In C11, the *_to() macros below pick the function from the type of the
+// destination pointer:
+//
+// float rgba[4];
+// vbt_parse_z_to("red", rgba);
+// vbt_oklab_to(0.5f, 0.1f, 0.1f, 1.0f, rgba);
+
+// [0-1] to [0-255], same as vbt__write_01()
+static VBT__INLINE VBT__CONSTEXPR vbt_u8_t vbt__unit_to_u8(
+    vbt_number_t value) {
+  return (vbt_u8_t)(value * (vbt_number_t)255 + (vbt_number_t)0.5);
+}
 
-// CIE Standard Illuminant D50
-#define VBT__CIE_E ((vbt_number_t)(216.0 / 24389.0))
-#define VBT__CIE_K ((vbt_number_t)(24389.0 / 27.0))
+static VBT__INLINE int vbt_color_resolve_u8(vbt_color_t* color,
+                                            vbt_u8_t* rgba) {
+  if (!rgba || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
 
-#define VBT__MAX_STR_LEN (128)
-#define VBT__NUMBER_MAX ((vbt_number_t)(16777216))
-#define VBT__NUMBER_DECIMAL_LIMIT (9)
-#define VBT__DEG_MIN ((vbt_number_t)(0))
-#define VBT__DEG_MAX ((vbt_number_t)(360))
-#define VBT__PERCENT_MIN ((vbt_number_t)(0))
-#define VBT__PERCENT_MAX ((vbt_number_t)(100))
-#define VBT__NOT_A_FUNCTION (-1000)
+  for (int i = 0; i < 4; i++) {
+    rgba[i] = color->resolved == VBT__RESOLVED_U8
+                  ? color->srgb.u8[i]
+                  : vbt__unit_to_u8(color->srgb.n[i]);
+  }
 
-#define VBT__ARR_LEN(a) (sizeof(a) / sizeof(a[0]))
-#define VBT__MIN(a, b) ((a) < (b) ? (a) : (b))
-#define VBT__MAX(a, b) ((a) > (b) ? (a) : (b))
-#define VBT__CLAMP(val, min, max) \
-  ((val) < (min) ? (min) : ((val) > (max) ? (max) : (val)))
-#define VBT__CLAMP_01(val) VBT__CLAMP(val, (vbt_number_t)(0), (vbt_number_t)(1))
-#define VBT__CLAMP_0100(val) VBT__CLAMP(val, VBT__PERCENT_MIN, VBT__PERCENT_MAX)
-#define VBT__CLAMP_0360(val) VBT__CLAMP(val, VBT__DEG_MIN, VBT__DEG_MAX)
+  return VBT_SUCCESS;
+}
 
-// [0-1] to [0-255]
-// assume clamped, round might be more accurate?
-#define VBT__01_TO_255(comp) \
-  (vbt_u8_t)(comp * (vbt_number_t)(255) + (vbt_number_t)(0.5))
+static VBT__INLINE int vbt_color_resolve_f32(vbt_color_t* color,
+                                             float* rgba) {
+  if (!rgba || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
 
-typedef int vbt_bool_t;
-#define VBT__TRUE (1)
-#define VBT__FALSE (0)
+  for (int i = 0; i < 4; i++) {
+    rgba[i] = color->resolved == VBT__RESOLVED_U8
+                  ? (float)color->srgb.u8[i] / 255.0f
+                  : (float)color->srgb.n[i];
+  }
 
-// clang-format off
-static int vbt__write_u8(vbt_recv_t* recv, vbt_u8_t r, vbt_u8_t g, vbt_u8_t b, vbt_u8_t a);
-static int vbt__write_01(vbt_recv_t* recv, vbt_number_t r, vbt_number_t g, vbt_number_t b, vbt_number_t a);
-static vbt_number_t vbt__normalize_angle(vbt_number_t hue);
-static void vbt__hsl_to_rgb(vbt_number_t hue, vbt_number_t saturation, vbt_number_t lightness, vbt_number_t* r, vbt_number_t* g, vbt_number_t* b);
-static vbt_number_t vbt__hsl_to_rgb_fn(vbt_number_t h, vbt_number_t s, vbt_number_t l, vbt_number_t n);
-// clang-format on
+  return VBT_SUCCESS;
+}
 
-VBTDEF int vbt_rgb(vbt_u8_t red,
-                   vbt_u8_t green,
-                   vbt_u8_t blue,
-                   vbt_number_t alpha,
-                   vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_color_resolve_f64(vbt_color_t* color,
+                                             double* rgba) {
+  if (!rgba || vbt_color_eval(color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  return vbt__write_u8(recv, red, green, blue,
-                       VBT__01_TO_255(VBT__CLAMP_01(alpha)));
+  for (int i = 0; i < 4; i++) {
+    rgba[i] = color->resolved == VBT__RESOLVED_U8
+                  ? (double)color->srgb.u8[i] / 255.0
+                  : (double)color->srgb.n[i];
+  }
+
+  return VBT_SUCCESS;
 }
 
-VBTDEF int vbt_hsl(vbt_number_t hue,
-                   vbt_number_t saturation,
-                   vbt_number_t lightness,
-                   vbt_number_t alpha,
-                   vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(hue) || !vbt__isfinite(saturation) ||
-      !vbt__isfinite(lightness) || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_color_resolve_u32(vbt_color_t* color,
+                                             uint32_t* rgba) {
+  vbt_u8_t c[4];
+
+  if (!rgba || vbt_color_resolve_u8(color, c) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  vbt_number_t r;
-  vbt_number_t g;
-  vbt_number_t b;
+  *rgba = ((uint32_t)c[0] << 24) | ((uint32_t)c[1] << 16) |
+          ((uint32_t)c[2] << 8) | (uint32_t)c[3];
+  return VBT_SUCCESS;
+}
 
-  vbt__hsl_to_rgb(vbt__normalize_angle(hue), VBT__CLAMP_0100(saturation),
-                  VBT__CLAMP_0100(lightness), &r, &g, &b);
+#ifndef VIBRANT_NO_PARSE
 
-  return vbt__write_01(recv, r, g, b, VBT__CLAMP_01(alpha));
-}
+static VBT__INLINE int vbt_parse_u8(const char* value,
+                                    vbt_size_t len,
+                                    vbt_u8_t* rgba) {
+  vbt_color_t color;
 
-// https://www.w3.org/TR/css-color-4/#hwb-to-rgb
-/*
-function hwbToRgb(hue, white, black) {
-    white /= 100;
-    black /= 100;
-    if (white + black >= 1) {
-        let gray = white / (white + black);
-        return [gray, gray, gray];
-    }
-    let rgb = hslToRgb(hue, 100, 50);
-    for (let i = 0; i < 3; i++) {
-        rgb[i] *= (1 - white - black);
-        rgb[i] += white;
-    }
-    return rgb;
-}
-*/
-VBTDEF int vbt_hwb(vbt_number_t hue,
-                   vbt_number_t whiteness,
-                   vbt_number_t blackness,
-                   vbt_number_t alpha,
-                   vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(hue) || !vbt__isfinite(whiteness) ||
-      !vbt__isfinite(blackness) || !vbt__isfinite(alpha)) {
+  if (vbt_parse_color(value, len, &color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  const vbt_number_t h = vbt__normalize_angle(hue);
-  const vbt_number_t w = VBT__CLAMP_0100(whiteness) / VBT__PERCENT_MAX;
-  const vbt_number_t b = VBT__CLAMP_0100(blackness) / VBT__PERCENT_MAX;
-  const vbt_number_t wb = w + b;
-  const vbt_number_t clamped_alpha = VBT__CLAMP_01(alpha);
+  return vbt_color_resolve_u8(&color, rgba);
+}
 
-  if (wb >= (vbt_number_t)1) {
-    vbt_number_t gray = w / wb;
-    return vbt__write_01(recv, gray, gray, gray, clamped_alpha);
+static VBT__INLINE int vbt_parse_f32(const char* value,
+                                     vbt_size_t len,
+                                     float* rgba) {
+  vbt_color_t color;
+
+  if (vbt_parse_color(value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
   }
 
-  vbt_number_t rgb[3];
+  return vbt_color_resolve_f32(&color, rgba);
+}
 
-  vbt__hsl_to_rgb(h, 100, 50, &rgb[0], &rgb[1], &rgb[2]);
+static VBT__INLINE int vbt_parse_f64(const char* value,
+                                     vbt_size_t len,
+                                     double* rgba) {
+  vbt_color_t color;
 
-  for (size_t i = 0; i < VBT__ARR_LEN(rgb); i++) {
-    rgb[i] *= ((vbt_number_t)1.0 - w - b);
-    rgb[i] += w;
+  if (vbt_parse_color(value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
   }
 
-  return vbt__write_01(recv, rgb[0], rgb[1], rgb[2], clamped_alpha);
+  return vbt_color_resolve_f64(&color, rgba);
 }
 
-VBTDEF int vbt_lch(vbt_number_t lightness,
-                   vbt_number_t chroma,
-                   vbt_number_t hue,
-                   vbt_number_t alpha,
-                   vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(lightness) || !vbt__isfinite(chroma) ||
-      !vbt__isfinite(hue) || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_parse_u32(const char* value,
+                                     vbt_size_t len,
+                                     uint32_t* rgba) {
+  vbt_color_t color;
+
+  if (vbt_parse_color(value, len, &color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  const vbt_number_t h_rad = hue * VBT__PI / (vbt_number_t)180.0;
-  const vbt_number_t a = chroma * vbt__cos(h_rad);
-  const vbt_number_t b = chroma * vbt__sin(h_rad);
-
-  return vbt_lab(lightness, a, b, alpha, recv);
+  return vbt_color_resolve_u32(&color, rgba);
 }
 
-VBTDEF int vbt_lab(vbt_number_t lightness,
-                   vbt_number_t a,
-                   vbt_number_t b,
-                   vbt_number_t alpha,
-                   vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(lightness) || !vbt__isfinite(a) ||
-      !vbt__isfinite(b) || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_parse_z_u8(const char* value, vbt_u8_t* rgba) {
+  vbt_color_t color;
+
+  if (vbt_parse_color_z(value, &color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  const vbt_number_t lightness_clamped = VBT__CLAMP_0100(lightness);
-  const vbt_number_t fy =
-      (lightness_clamped + (vbt_number_t)16.0) / (vbt_number_t)116.0;
-  const vbt_number_t fx = a / (vbt_number_t)500.0 + fy;
-  const vbt_number_t fz = fy - b / (vbt_number_t)200.0;
-
-  const vbt_number_t fx3 = fx * fx * fx;
-  const vbt_number_t fz3 = fz * fz * fz;
+  return vbt_color_resolve_u8(&color, rgba);
+}
 
-  const vbt_number_t xr =
-      (fx3 > VBT__CIE_E)
-          ? fx3
-          : ((vbt_number_t)116.0 * fx - (vbt_number_t)16.0) / VBT__CIE_K;
-  const vbt_number_t yr = (lightness_clamped > VBT__CIE_K * VBT__CIE_E)
-                              ? vbt__pow(fy, (vbt_number_t)3.0)
-                              : lightness_clamped / VBT__CIE_K;
-  const vbt_number_t zr =
-      (fz3 > VBT__CIE_E)
-          ? fz3
-          : ((vbt_number_t)116.0 * fz - (vbt_number_t)16.0) / VBT__CIE_K;
+static VBT__INLINE int vbt_parse_z_f32(const char* value, float* rgba) {
+  vbt_color_t color;
 
-  const vbt_number_t x = xr * VBT__D65_X;
-  const vbt_number_t y = yr * VBT__D65_Y;
-  const vbt_number_t z = zr * VBT__D65_Z;
+  if (vbt_parse_color_z(value, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
 
-  const vbt_number_t r_lin = (vbt_number_t)3.2404542 * x -
-                             (vbt_number_t)1.5371385 * y -
-                             (vbt_number_t)0.4985314 * z;
-  const vbt_number_t g_lin = (vbt_number_t)-0.9692660 * x +
-                             (vbt_number_t)1.8760108 * y +
-                             (vbt_number_t)0.0415560 * z;
-  const vbt_number_t b_lin = (vbt_number_t)0.0556434 * x -
-                             (vbt_number_t)0.2040259 * y +
-                             (vbt_number_t)1.0572252 * z;
-
-  vbt_number_t r =
-      (r_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(r_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * r_lin;
-  vbt_number_t g =
-      (g_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(g_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * g_lin;
-  vbt_number_t b_val =
-      (b_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(b_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * b_lin;
-
-  r = VBT__CLAMP_01(r);
-  g = VBT__CLAMP_01(g);
-  b_val = VBT__CLAMP_01(b_val);
-
-  return vbt__write_01(recv, r, g, b_val, VBT__CLAMP_01(alpha));
+  return vbt_color_resolve_f32(&color, rgba);
 }
 
-VBTDEF int vbt_oklch(vbt_number_t lightness,
-                     vbt_number_t chroma,
-                     vbt_number_t hue,
-                     vbt_number_t alpha,
-                     vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(lightness) || !vbt__isfinite(chroma) ||
-      !vbt__isfinite(hue) || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_parse_z_f64(const char* value, double* rgba) {
+  vbt_color_t color;
+
+  if (vbt_parse_color_z(value, &color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  const vbt_number_t h_rad = hue * VBT__PI / (vbt_number_t)180.0;
-  const vbt_number_t a = chroma * vbt__cos(h_rad);
-  const vbt_number_t b = chroma * vbt__sin(h_rad);
-
-  return vbt_oklab(lightness, a, b, alpha, recv);
+  return vbt_color_resolve_f64(&color, rgba);
 }
 
-VBTDEF int vbt_oklab(vbt_number_t lightness,
-                     vbt_number_t a,
-                     vbt_number_t b,
-                     vbt_number_t alpha,
-                     vbt_recv_t* recv) {
-  if (!recv || !vbt__isfinite(lightness) || !vbt__isfinite(a) ||
-      !vbt__isfinite(b) || !vbt__isfinite(alpha)) {
+static VBT__INLINE int vbt_parse_z_u32(const char* value, uint32_t* rgba) {
+  vbt_color_t color;
+
+  if (vbt_parse_color_z(value, &color) != VBT_SUCCESS) {
     return VBT_ERR;
   }
 
-  const vbt_number_t lightness_clamped = VBT__CLAMP_0100(lightness);
-  const vbt_number_t l_ = lightness_clamped + (vbt_number_t)0.3963377774 * a +
-                          (vbt_number_t)0.2158037573 * b;
-  const vbt_number_t m_ = lightness_clamped - (vbt_number_t)0.1055613423 * a -
-                          (vbt_number_t)0.0638541728 * b;
-  const vbt_number_t s_ = lightness_clamped - (vbt_number_t)0.0894841775 * a -
-                          (vbt_number_t)1.2914855480 * b;
-
-  const vbt_number_t l = l_ * l_ * l_;
-  const vbt_number_t m = m_ * m_ * m_;
-  const vbt_number_t s = s_ * s_ * s_;
-
-  const vbt_number_t r_lin = (vbt_number_t)4.0767416621 * l -
-                             (vbt_number_t)3.3077115913 * m +
-                             (vbt_number_t)0.2309699292 * s;
-  const vbt_number_t g_lin = (vbt_number_t)-1.2684380046 * l +
-                             (vbt_number_t)2.6097574011 * m -
-                             (vbt_number_t)0.3413193965 * s;
-  const vbt_number_t b_lin = (vbt_number_t)-0.0041960863 * l -
-                             (vbt_number_t)0.7034186147 * m +
-                             (vbt_number_t)1.7076147009 * s;
-
-  vbt_number_t r =
-      (r_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(r_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * r_lin;
-  vbt_number_t g =
-      (g_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(g_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * g_lin;
-  vbt_number_t b_val =
-      (b_lin > (vbt_number_t)0.0031308)
-          ? (vbt_number_t)1.055 *
-                    vbt__pow(b_lin, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
-                (vbt_number_t)0.055
-          : (vbt_number_t)12.92 * b_lin;
-
-  r = VBT__CLAMP_01(r);
-  g = VBT__CLAMP_01(g);
-  b_val = VBT__CLAMP_01(b_val);
-
-  return vbt__write_01(recv, r, g, b_val, VBT__CLAMP_01(alpha));
+  return vbt_color_resolve_u32(&color, rgba);
+}
+
+#endif  // VIBRANT_NO_PARSE
+
+#if !defined(__cplusplus) && defined(__STDC_VERSION__) && \
+    __STDC_VERSION__ >= 201112L
+
+// clang-format off
+#define VBT__GENERIC(DST, FN)      \
+  _Generic((DST),                  \
+           vbt_u8_t*: FN##_u8,     \
+           float*: FN##_f32,       \
+           double*: FN##_f64,      \
+           uint32_t*: FN##_u32)
+// clang-format on
+
+#define vbt_color_resolve_to(COLOR, DST) \
+  VBT__GENERIC(DST, vbt_color_resolve)(COLOR, DST)
+
+#define vbt_rgb_to(R, G, B, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_RGB, R, G, B, ALPHA), DST)
+#define vbt_hsl_to(H, S, L, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_HSL, H, S, L, ALPHA), DST)
+#define vbt_hwb_to(H, W, B, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_HWB, H, W, B, ALPHA), DST)
+#define vbt_lch_to(L, C, H, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_LCH, L, C, H, ALPHA), DST)
+#define vbt_lab_to(L, A, B, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_LAB, L, A, B, ALPHA), DST)
+#define vbt_oklch_to(L, C, H, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_OKLCH, L, C, H, ALPHA), DST)
+#define vbt_oklab_to(L, A, B, ALPHA, DST) \
+  vbt_color_resolve_to(&vbt_color_init(VBT_COLOR_OKLAB, L, A, B, ALPHA), DST)
+
+#ifndef VIBRANT_NO_PARSE
+#define vbt_parse_to(VALUE, LEN, DST) \
+  VBT__GENERIC(DST, vbt_parse)(VALUE, LEN, DST)
+#define vbt_parse_z_to(VALUE, DST) VBT__GENERIC(DST, vbt_parse_z)(VALUE, DST)
+#endif  // VIBRANT_NO_PARSE
+
+#endif  // __STDC_VERSION__ >= 201112L
+
+// C++ API with the receiver format as a type. Each format corresponds to a
+// vbt_recv_tag_t, but the write is picked by the compiler and inlined, with
+// no tag dispatch.
+//
+// vbt::rgba8 color;
+// vbt::ref_f32 ref{&v.x, &v.y, &v.z, &v.w};
+//
+// vbt::parse_z("red", color);
+// vbt::oklab(0.5, 0.1, 0.1, 1, ref);
+#ifdef __cplusplus
+namespace vbt {
+
+// VBT_RECV_VAL_U8
+struct rgba8 {
+  vbt_u8_t r;
+  vbt_u8_t g;
+  vbt_u8_t b;
+  vbt_u8_t a;
+};
+
+// VBT_RECV_VAL_F32
+struct rgba_f32 {
+  float r;
+  float g;
+  float b;
+  float a;
+};
+
+// VBT_RECV_VAL_F64
+struct rgba_f64 {
+  double r;
+  double g;
+  double b;
+  double a;
+};
+
+// VBT_RECV_REF_U8, VBT_RECV_REF_F32 and VBT_RECV_REF_F64. unlike
+// vbt_recv_t refs, the pointers are not checked and must not be NULL.
+struct ref_u8 {
+  vbt_u8_t *r, *g, *b, *a;
+};
+
+struct ref_f32 {
+  float *r, *g, *b, *a;
+};
+
+struct ref_f64 {
+  double *r, *g, *b, *a;
+};
+
+constexpr bool operator==(const rgba8& lhs, const rgba8& rhs) noexcept {
+  return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b && lhs.a == rhs.a;
+}
+
+constexpr bool operator!=(const rgba8& lhs, const rgba8& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+namespace detail {
+
+// [0-1] to [0-255], same as vbt__write_01()
+constexpr vbt_u8_t unit_to_u8(vbt_number_t value) noexcept {
+  return (vbt_u8_t)(value * (vbt_number_t)255 + (vbt_number_t)0.5);
+}
+
+// converts memoized sRGB components to a receiver component type
+template <typename T>
+struct component;
+
+template <>
+struct component<vbt_u8_t> {
+  static vbt_u8_t from_u8(vbt_u8_t value) noexcept { return value; }
+  static vbt_u8_t from_01(vbt_number_t value) noexcept {
+    return unit_to_u8(value);
+  }
+};
+
+template <>
+struct component<float> {
+  static float from_u8(vbt_u8_t value) noexcept {
+    return (float)value / 255.0f;
+  }
+  static float from_01(vbt_number_t value) noexcept { return (float)value; }
+};
+
+template <>
+struct component<double> {
+  static double from_u8(vbt_u8_t value) noexcept {
+    return (double)value / 255.0;
+  }
+  static double from_01(vbt_number_t value) noexcept { return (double)value; }
+};
+
+// color must be evaluated, see vbt_color_eval()
+template <typename T>
+inline void write_srgb(const vbt_color_t& color,
+                       T& r,
+                       T& g,
+                       T& b,
+                       T& a) noexcept {
+  typedef component<T> c;
+
+  if (color.resolved == VBT__RESOLVED_U8) {
+    const vbt_u8_t* rgba = color.srgb.u8;
+    r = c::from_u8(rgba[0]);
+    g = c::from_u8(rgba[1]);
+    b = c::from_u8(rgba[2]);
+    a = c::from_u8(rgba[3]);
+  } else {
+    const vbt_number_t* rgba = color.srgb.n;
+    r = c::from_01(rgba[0]);
+    g = c::from_01(rgba[1]);
+    b = c::from_01(rgba[2]);
+    a = c::from_01(rgba[3]);
+  }
+}
+
+inline void write(const vbt_color_t& color, rgba8& out) noexcept {
+  write_srgb(color, out.r, out.g, out.b, out.a);
+}
+
+inline void write(const vbt_color_t& color, rgba_f32& out) noexcept {
+  write_srgb(color, out.r, out.g, out.b, out.a);
+}
+
+inline void write(const vbt_color_t& color, rgba_f64& out) noexcept {
+  write_srgb(color, out.r, out.g, out.b, out.a);
+}
+
+inline void write(const vbt_color_t& color, const ref_u8& out) noexcept {
+  write_srgb(color, *out.r, *out.g, *out.b, *out.a);
+}
+
+inline void write(const vbt_color_t& color, const ref_f32& out) noexcept {
+  write_srgb(color, *out.r, *out.g, *out.b, *out.a);
+}
+
+inline void write(const vbt_color_t& color, const ref_f64& out) noexcept {
+  write_srgb(color, *out.r, *out.g, *out.b, *out.a);
+}
+
+}  // namespace detail
+
+// Same as vbt_color_resolve(), with out as the receiver.
+template <typename Format>
+inline int color_resolve(vbt_color_t& color, Format& out) noexcept {
+  if (vbt_color_eval(&color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  detail::write(color, out);
+  return VBT_SUCCESS;
+}
+
+template <typename Format>
+inline int rgb(vbt_u8_t red,
+               vbt_u8_t green,
+               vbt_u8_t blue,
+               vbt_number_t alpha,
+               Format& out) noexcept {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_RGB, red, green, blue, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int hsl(vbt_number_t hue,
+               vbt_number_t saturation,
+               vbt_number_t lightness,
+               vbt_number_t alpha,
+               Format& out) noexcept {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_HSL, hue, saturation, lightness, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int hwb(vbt_number_t hue,
+               vbt_number_t whiteness,
+               vbt_number_t blackness,
+               vbt_number_t alpha,
+               Format& out) noexcept {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_HWB, hue, whiteness, blackness, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int lch(vbt_number_t lightness,
+               vbt_number_t chroma,
+               vbt_number_t hue,
+               vbt_number_t alpha,
+               Format& out) noexcept {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_LCH, lightness, chroma, hue, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int lab(vbt_number_t lightness,
+               vbt_number_t a,
+               vbt_number_t b,
+               vbt_number_t alpha,
+               Format& out) noexcept {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_LAB, lightness, a, b, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int oklch(vbt_number_t lightness,
+                 vbt_number_t chroma,
+                 vbt_number_t hue,
+                 vbt_number_t alpha,
+                 Format& out) noexcept {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_OKLCH, lightness, chroma, hue, alpha);
+  return color_resolve(color, out);
+}
+
+template <typename Format>
+inline int oklab(vbt_number_t lightness,
+                 vbt_number_t a,
+                 vbt_number_t b,
+                 vbt_number_t alpha,
+                 Format& out) noexcept {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_OKLAB, lightness, a, b, alpha);
+  return color_resolve(color, out);
+}
+
+#ifndef VIBRANT_NO_PARSE
+
+// Same as vbt_parse(), with out as the receiver.
+template <typename Format>
+inline int parse(const char* value, vbt_size_t len, Format& out) noexcept {
+  vbt_color_t color;
+
+  if (vbt_parse_color(value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return color_resolve(color, out);
+}
+
+// Same as vbt_parse_z(), with out as the receiver.
+template <typename Format>
+inline int parse_z(const char* value, Format& out) noexcept {
+  vbt_color_t color;
+
+  if (vbt_parse_color_z(value, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return color_resolve(color, out);
+}
+
+#endif  // VIBRANT_NO_PARSE
+
+}  // namespace vbt
+#endif  // __cplusplus
+
+// sin of 0 to 90 degrees, correctly rounded. sin and cos of any integer
+// angle follow by symmetry.
+// clang-format off
+#define VBT__SIN_DEG_TABLE \
+    0.0, 0.01745240643728351, 0.03489949670250097, 0.052335956242943835, \
+    0.0697564737441253, 0.08715574274765818, 0.10452846326765347, \
+    0.12186934340514748, 0.13917310096006544, 0.15643446504023087, \
+    0.17364817766693036, 0.1908089953765448, 0.20791169081775934, \
+    0.224951054343865, 0.24192189559966773, 0.25881904510252074, \
+    0.27563735581699916, 0.2923717047227367, 0.30901699437494745, \
+    0.32556815445715664, 0.3420201433256687, 0.35836794954530027, \
+    0.374606593415912, 0.39073112848927377, 0.4067366430758002, \
+    0.42261826174069944, 0.4383711467890774, 0.4539904997395468, \
+    0.46947156278589075, 0.484809620246337, 0.5, 0.5150380749100542, \
+    0.5299192642332049, 0.5446390350150271, 0.5591929034707468, \
+    0.573576436351046, 0.5877852522924731, 0.6018150231520483, \
+    0.6156614753256583, 0.6293203910498375, 0.6427876096865394, \
+    0.6560590289905073, 0.6691306063588582, 0.6819983600624985, \
+    0.6946583704589973, 0.7071067811865476, 0.7193398003386512, \
+    0.7313537016191705, 0.7431448254773942, 0.754709580222772, \
+    0.766044443118978, 0.7771459614569709, 0.7880107536067219, \
+    0.7986355100472928, 0.8090169943749475, 0.8191520442889918, \
+    0.8290375725550417, 0.838670567945424, 0.848048096156426, \
+    0.8571673007021123, 0.8660254037844386, 0.8746197071393959, \
+    0.882947592858927, 0.8910065241883679, 0.898794046299167, \
+    0.9063077870366499, 0.9135454576426009, 0.9205048534524404, \
+    0.9271838545667874, 0.9335804264972017, 0.9396926207859084, \
+    0.9455185755993168, 0.9510565162951535, 0.9563047559630354, \
+    0.9612616959383189, 0.9659258262890683, 0.9702957262759965, \
+    0.9743700647852352, 0.9781476007338057, 0.981627183447664, \
+    0.984807753012208, 0.9876883405951378, 0.9902680687415704, \
+    0.992546151641322, 0.9945218953682733, 0.9961946980917455, \
+    0.9975640502598242, 0.9986295347545738, 0.9993908270190958, \
+    0.9998476951563913, 1.0
+// clang-format on
+
+// parser limits
+#define VBT__MAX_STR_LEN (128)
+#define VBT__NUMBER_MAX_INT (16777216)
+#define VBT__NUMBER_MAX_DIGITS (19)
+#define VBT__NUMBER_LONG_DIGITS (130)
+#define VBT__NUMBER_MIN_EXP10 (-32)
+#define VBT__NUMBER_EXP_LIMIT (10000)
+#define VBT__COLOR_NAME_MIN_LEN (3)
+#define VBT__COLOR_NAME_MAX_LEN (20)
+
+// C++17 parallel algorithms. With VIBRANT_EXECUTION, the vbt::transform_*
+// functions convert ranges of colors like std::transform, and take a
+// standard execution policy:
+//
+// std::vector<std::string_view> values = ...;
+// std::vector<vbt::rgba8> colors(values.size());
+//
+// vbt::transform_parse(std::execution::par_unseq, values.begin(),
+//                      values.end(), colors.begin());
+#if defined(__cplusplus) && defined(VIBRANT_EXECUTION) && \
+    (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#if __has_include(<version>)
+#include <version>
+#endif
+// some standard libraries, like Apple's libc++, have no execution policies
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm)
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <iterator>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace vbt {
+namespace detail {
+
+template <typename Policy>
+using enable_if_policy_t =
+    std::enable_if_t<std::is_execution_policy_v<std::decay_t<Policy>>, int>;
+
+// the Format written through an output iterator. refs would be written
+// through the NULL pointers of a value initialized ref, so they are
+// rejected.
+template <typename It>
+struct value_format {
+  typedef typename std::iterator_traits<It>::value_type type;
+  static_assert(std::is_same_v<type, rgba8> ||
+                    std::is_same_v<type, rgba_f32> ||
+                    std::is_same_v<type, rgba_f64>,
+                "out must be vbt::rgba8, vbt::rgba_f32 or vbt::rgba_f64");
+};
+
+template <typename It>
+using value_format_t = typename value_format<It>::type;
+
+// a random access iterator over the indices [0, n), so a parallel
+// algorithm can split a loop over several ranges
+class index_iterator {
+ public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef std::ptrdiff_t value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const std::ptrdiff_t* pointer;
+  typedef std::ptrdiff_t reference;
+
+  index_iterator() noexcept = default;
+  explicit index_iterator(std::ptrdiff_t i) noexcept : i_(i) {}
+
+  reference operator*() const noexcept { return i_; }
+  reference operator[](difference_type n) const noexcept { return i_ + n; }
+
+  index_iterator& operator++() noexcept {
+    ++i_;
+    return *this;
+  }
+  index_iterator operator++(int) noexcept { return index_iterator(i_++); }
+  index_iterator& operator--() noexcept {
+    --i_;
+    return *this;
+  }
+  index_iterator operator--(int) noexcept { return index_iterator(i_--); }
+  index_iterator& operator+=(difference_type n) noexcept {
+    i_ += n;
+    return *this;
+  }
+  index_iterator& operator-=(difference_type n) noexcept {
+    i_ -= n;
+    return *this;
+  }
+
+  friend index_iterator operator+(index_iterator it,
+                                  difference_type n) noexcept {
+    return index_iterator(it.i_ + n);
+  }
+  friend index_iterator operator+(difference_type n,
+                                  index_iterator it) noexcept {
+    return index_iterator(it.i_ + n);
+  }
+  friend index_iterator operator-(index_iterator it,
+                                  difference_type n) noexcept {
+    return index_iterator(it.i_ - n);
+  }
+  friend difference_type operator-(index_iterator a,
+                                   index_iterator b) noexcept {
+    return a.i_ - b.i_;
+  }
+  friend bool operator==(index_iterator a, index_iterator b) noexcept {
+    return a.i_ == b.i_;
+  }
+  friend bool operator!=(index_iterator a, index_iterator b) noexcept {
+    return a.i_ != b.i_;
+  }
+  friend bool operator<(index_iterator a, index_iterator b) noexcept {
+    return a.i_ < b.i_;
+  }
+  friend bool operator>(index_iterator a, index_iterator b) noexcept {
+    return a.i_ > b.i_;
+  }
+  friend bool operator<=(index_iterator a, index_iterator b) noexcept {
+    return a.i_ <= b.i_;
+  }
+  friend bool operator>=(index_iterator a, index_iterator b) noexcept {
+    return a.i_ >= b.i_;
+  }
+
+ private:
+  std::ptrdiff_t i_ = 0;
+};
+
+}  // namespace detail
+
+// Converts each color in [first, last) into out. Elements are vbt_color_t
+// objects. Colors that fail to convert are set to Format{}, transparent
+// black.
+//
+// @returns the end of the output range, same as std::transform()
+template <typename Policy,
+          typename ForwardIt1,
+          typename ForwardIt2,
+          detail::enable_if_policy_t<Policy> = 0>
+ForwardIt2 transform_color(Policy&& policy,
+                           ForwardIt1 first,
+                           ForwardIt1 last,
+                           ForwardIt2 out) {
+  typedef detail::value_format_t<ForwardIt2> Format;
+
+  return std::transform(std::forward<Policy>(policy), first, last, out,
+                        [](vbt_color_t color) noexcept {
+                          Format result{};
+                          color_resolve(color, result);
+                          return result;
+                        });
+}
+
+// Same as above, with tuple-like elements (std::tuple, std::array, ...)
+// holding the 4 arguments of fn. ie {l, c, h, alpha} for VBT_COLOR_OKLCH,
+// the arguments of vbt_oklch().
+template <typename Policy,
+          typename ForwardIt1,
+          typename ForwardIt2,
+          detail::enable_if_policy_t<Policy> = 0>
+ForwardIt2 transform_color(Policy&& policy,
+                           vbt_color_fn_t fn,
+                           ForwardIt1 first,
+                           ForwardIt1 last,
+                           ForwardIt2 out) {
+  typedef detail::value_format_t<ForwardIt2> Format;
+
+  return std::transform(
+      std::forward<Policy>(policy), first, last, out,
+      [fn](const auto& args) noexcept {
+        using std::get;
+        vbt_color_t color = vbt_color_init(
+            fn, (vbt_number_t)get<0>(args), (vbt_number_t)get<1>(args),
+            (vbt_number_t)get<2>(args), (vbt_number_t)get<3>(args));
+        Format result{};
+        color_resolve(color, result);
+        return result;
+      });
+}
+
+#ifndef VIBRANT_NO_PARSE
+
+// Parses each string in [first, last) into out. Elements are anything a
+// std::string_view can be made from. Strings that fail to parse are set to
+// Format{}, transparent black.
+//
+// @returns the end of the output range, same as std::transform()
+template <typename Policy,
+          typename ForwardIt1,
+          typename ForwardIt2,
+          detail::enable_if_policy_t<Policy> = 0>
+ForwardIt2 transform_parse(Policy&& policy,
+                           ForwardIt1 first,
+                           ForwardIt1 last,
+                           ForwardIt2 out) {
+  typedef detail::value_format_t<ForwardIt2> Format;
+
+  return std::transform(std::forward<Policy>(policy), first, last, out,
+                        [](const auto& value) noexcept {
+                          const std::string_view str(value);
+                          Format result{};
+                          parse(str.data(), str.size(), result);
+                          return result;
+                        });
+}
+
+// Same as above, and sets the result of each string, VBT_SUCCESS or
+// VBT_ERR, in err. first, out and err must be random access.
+//
+// @returns the end of the output range
+template <typename Policy,
+          typename RandomIt1,
+          typename RandomIt2,
+          typename RandomIt3,
+          detail::enable_if_policy_t<Policy> = 0>
+RandomIt2 transform_parse(Policy&& policy,
+                          RandomIt1 first,
+                          RandomIt1 last,
+                          RandomIt2 out,
+                          RandomIt3 err) {
+  typedef detail::value_format_t<RandomIt2> Format;
+
+  std::for_each(std::forward<Policy>(policy), detail::index_iterator(0),
+                detail::index_iterator(last - first),
+                [first, out, err](std::ptrdiff_t i) noexcept {
+                  const std::string_view str(first[i]);
+                  Format result{};
+                  err[i] = parse(str.data(), str.size(), result);
+                  out[i] = result;
+                });
+
+  return out + (last - first);
+}
+
+#endif  // VIBRANT_NO_PARSE
+
+}  // namespace vbt
+#endif  // __cpp_lib_execution
+#endif  // VIBRANT_EXECUTION
+
+// C++20 ranges. With VIBRANT_RANGES, vbt::views::parse and
+// vbt::views::convert are range adaptors that parse or convert the elements
+// of a range as they are read, into an std::optional<Format> that is empty
+// when the element is not a valid color:
+//
+// auto valid = [](const auto& color) { return color.has_value(); };
+//
+// for (auto color : values | vbt::views::parse |
+//                       std::views::take_while(valid)) {
+// }
+#if defined(__cplusplus) && defined(VIBRANT_RANGES) && \
+    (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#include <version>
+#if defined(__cpp_lib_ranges)
+#include <optional>
+#include <ranges>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace vbt {
+namespace detail {
+
+template <typename Format>
+concept value_format =
+    std::same_as<Format, rgba8> || std::same_as<Format, rgba_f32> ||
+    std::same_as<Format, rgba_f64>;
+
+#ifndef VIBRANT_NO_PARSE
+template <value_format Format>
+struct parse_fn {
+  template <typename T>
+  std::optional<Format> operator()(const T& value) const noexcept {
+    const std::string_view str(value);
+    Format result;
+
+    if (parse(str.data(), str.size(), result) != VBT_SUCCESS) {
+      return std::nullopt;
+    }
+
+    return result;
+  }
+};
+#endif  // VIBRANT_NO_PARSE
+
+template <vbt_color_fn_t Space, value_format Format>
+struct convert_fn {
+  template <typename T>
+  std::optional<Format> operator()(const T& args) const noexcept {
+    using std::get;
+    vbt_color_t color = vbt_color_init(
+        Space, (vbt_number_t)get<0>(args), (vbt_number_t)get<1>(args),
+        (vbt_number_t)get<2>(args), (vbt_number_t)get<3>(args));
+    Format result;
+
+    if (color_resolve(color, result) != VBT_SUCCESS) {
+      return std::nullopt;
+    }
+
+    return result;
+  }
+};
+
+// std::views::transform with Fn, except the iterator caches the converted
+// element. a filter or take_while reads an element, and then the consumer
+// reads it again, but it is only converted once.
+template <std::ranges::input_range V, typename Fn>
+  requires std::ranges::view<V>
+class convert_view : public std::ranges::view_interface<convert_view<V, Fn>> {
+ public:
+  using value_type =
+      std::invoke_result_t<const Fn&, std::ranges::range_reference_t<V>>;
+
+  class iterator {
+   public:
+    using iterator_concept =
+        std::conditional_t<std::ranges::forward_range<V>,
+                           std::forward_iterator_tag,
+                           std::input_iterator_tag>;
+    using value_type = convert_view::value_type;
+    using difference_type = std::ranges::range_difference_t<V>;
+
+    iterator() = default;
+    constexpr explicit iterator(std::ranges::iterator_t<V> current)
+        : current_(std::move(current)) {}
+
+    constexpr const std::ranges::iterator_t<V>& base() const noexcept {
+      return current_;
+    }
+
+    constexpr value_type operator*() const {
+      if (!cached_) {
+        value_ = Fn{}(*current_);
+        cached_ = true;
+      }
+      return value_;
+    }
+
+    constexpr iterator& operator++() {
+      ++current_;
+      cached_ = false;
+      return *this;
+    }
+
+    constexpr void operator++(int)
+      requires(!std::ranges::forward_range<V>)
+    {
+      ++*this;
+    }
+
+    constexpr iterator operator++(int)
+      requires std::ranges::forward_range<V>
+    {
+      iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    friend constexpr bool operator==(const iterator& lhs, const iterator& rhs)
+      requires std::equality_comparable<std::ranges::iterator_t<V>>
+    {
+      return lhs.current_ == rhs.current_;
+    }
+
+   private:
+    std::ranges::iterator_t<V> current_ = std::ranges::iterator_t<V>();
+    mutable value_type value_ = value_type();
+    mutable bool cached_ = false;
+  };
+
+  class sentinel {
+   public:
+    sentinel() = default;
+    constexpr explicit sentinel(std::ranges::sentinel_t<V> end)
+        : end_(std::move(end)) {}
+
+    friend constexpr bool operator==(const iterator& it, const sentinel& s) {
+      return it.base() == s.end_;
+    }
+
+   private:
+    std::ranges::sentinel_t<V> end_ = std::ranges::sentinel_t<V>();
+  };
+
+  convert_view()
+    requires std::default_initializable<V>
+  = default;
+  constexpr explicit convert_view(V base) : base_(std::move(base)) {}
+
+  constexpr V base() const&
+    requires std::copy_constructible<V>
+  {
+    return base_;
+  }
+  constexpr V base() && { return std::move(base_); }
+
+  constexpr iterator begin() { return iterator(std::ranges::begin(base_)); }
+
+  constexpr auto end() {
+    if constexpr (std::ranges::common_range<V>) {
+      return iterator(std::ranges::end(base_));
+    } else {
+      return sentinel(std::ranges::end(base_));
+    }
+  }
+
+  constexpr auto size()
+    requires std::ranges::sized_range<V>
+  {
+    return std::ranges::size(base_);
+  }
+
+ private:
+  V base_ = V();
+};
+
+// range adaptor for convert_view, called or piped
+template <typename Fn>
+struct convert_adaptor {
+  template <std::ranges::viewable_range R>
+  constexpr auto operator()(R&& range) const {
+    return convert_view<std::views::all_t<R>, Fn>(
+        std::views::all(std::forward<R>(range)));
+  }
+
+  template <std::ranges::viewable_range R>
+  friend constexpr auto operator|(R&& range, const convert_adaptor& self) {
+    return self(std::forward<R>(range));
+  }
+};
+
+}  // namespace detail
+
+namespace views {
+
+#ifndef VIBRANT_NO_PARSE
+// Parses elements, anything a std::string_view can be made from, into
+// std::optional<Format>.
+template <detail::value_format Format>
+inline constexpr detail::convert_adaptor<detail::parse_fn<Format>> parse_as{};
+
+inline constexpr auto parse = parse_as<rgba8>;
+#endif  // VIBRANT_NO_PARSE
+
+// Converts tuple-like elements (std::tuple, std::array, ...) holding the 4
+// arguments of Space, ie {l, c, h, alpha} for VBT_COLOR_OKLCH, into
+// std::optional<Format>.
+template <vbt_color_fn_t Space, detail::value_format Format = rgba8>
+inline constexpr detail::convert_adaptor<detail::convert_fn<Space, Format>>
+    convert{};
+
+}  // namespace views
+}  // namespace vbt
+
+#endif  // __cpp_lib_ranges
+#endif  // VIBRANT_RANGES
+
+// C++20 coroutines. With VIBRANT_SCAN, vbt::scan_generator() finds the
+// colors in a buffer, and yields them one at a time. A large input can be
+// scanned in chunks, the scan is resumed with the next chunk, and colors
+// split across chunks are still found:
+//
+// vbt::scanner scan = vbt::scan_generator(chunk, false);
+//
+// for (;;) {
+//   for (const vbt::scan_record& record : scan) {
+//     // record.offset, record.length, record.color
+//   }
+//   if (scan.done()) {
+//     break;
+//   }
+//   chunk = read_next_chunk();
+//   scan.feed(chunk, is_last_chunk);
+// }
+#if defined(__cplusplus) && defined(VIBRANT_SCAN) && \
+    !defined(VIBRANT_NO_PARSE) && \
+    (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#include <version>
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_coroutine)
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <string_view>
+#include <utility>
+
+namespace vbt {
+
+// A color found by vbt::scan_generator().
+struct scan_record {
+  // offset of the color in the input, counted across all chunks
+  vbt_size_t offset;
+  vbt_size_t length;
+  rgba8 color;
+};
+
+// The generator returned by vbt::scan_generator(). Chunks only have to
+// live until the scan needs input, a color split across chunks is copied
+// into the coroutine.
+class scanner {
+ public:
+  struct promise_type {
+    const scan_record* record = nullptr;
+    std::string_view chunk;
+    bool last = true;
+    bool needs_input = false;
+
+    scanner get_return_object() noexcept {
+      return scanner(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    std::suspend_always final_suspend() const noexcept { return {}; }
+    std::suspend_always yield_value(const scan_record& value) noexcept {
+      record = &value;
+      return {};
+    }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+
+  // gives the coroutine its promise, without suspending
+  struct promise_access {
+    promise_type* promise = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+      promise = &handle.promise();
+      return false;
+    }
+    promise_type& await_resume() const noexcept { return *promise; }
+  };
+
+  class iterator {
+   public:
+    using iterator_concept = std::input_iterator_tag;
+    using value_type = scan_record;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(scanner* scan) noexcept : scan_(scan) {}
+
+    const scan_record& operator*() const noexcept { return scan_->value(); }
+    const scan_record* operator->() const noexcept { return &scan_->value(); }
+
+    iterator& operator++() noexcept {
+      scan_->next();
+      return *this;
+    }
+    void operator++(int) noexcept { scan_->next(); }
+
+    friend bool operator==(const iterator& it, std::default_sentinel_t) {
+      return it.at_end();
+    }
+
+   private:
+    bool at_end() const noexcept { return !scan_->handle_.promise().record; }
+
+    scanner* scan_ = nullptr;
+  };
+
+  scanner(scanner&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  scanner& operator=(scanner&& other) noexcept {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  ~scanner() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Scans up to the next color.
+  //
+  // @returns true: a color was found, see value()
+  //          false: the chunk is scanned, see needs_input() and done()
+  bool next() noexcept {
+    promise_type& promise = handle_.promise();
+    promise.record = nullptr;
+
+    if (!handle_.done() && !promise.needs_input) {
+      handle_.resume();
+    }
+
+    return promise.record != nullptr;
+  }
+
+  // the color found by the last next()
+  const scan_record& value() const noexcept {
+    return *handle_.promise().record;
+  }
+
+  bool needs_input() const noexcept { return handle_.promise().needs_input; }
+
+  bool done() const noexcept { return handle_.done(); }
+
+  // Continues the scan with the next chunk of the input, when the scan
+  // needs_input(). If last is true, the scan ends with chunk.
+  void feed(std::string_view chunk, bool last = false) noexcept {
+    promise_type& promise = handle_.promise();
+    promise.chunk = chunk;
+    promise.last = last;
+    promise.needs_input = false;
+  }
+
+  // Ends the input, without another chunk.
+  void finish() noexcept { feed(std::string_view(), true); }
+
+  // The colors up to the end of the current chunk. The scan only resumes
+  // when there is no current color, so calling begin() again does not skip
+  // one.
+  iterator begin() noexcept {
+    if (!handle_.promise().record) {
+      next();
+    }
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const noexcept { return {}; }
+
+ private:
+  explicit scanner(std::coroutine_handle<promise_type> handle) noexcept
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+// bytes of a color name, hex color or color function name
+inline bool is_scan_word(unsigned char c) noexcept {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '#' || c == '-' || c == '_';
+}
+
+// outside of scan_generator(), gcc 12 crashes on local types in coroutines
+enum scan_state { SCAN_NONE, SCAN_WORD, SCAN_ARGS };
+
+}  // namespace detail
+
+// Scans chunk for colors, and yields a scan_record for each color, in
+// order. A color is a word, ie "red" or "#fff", or a word followed by a
+// parenthesized list, ie "rgb(1 2 3)", which may nest, as in
+// "color-mix(in srgb, rgb(1 2 3), red)". Words inside other words, as in
+// "bored", are not colors.
+//
+// @param chunk the first chunk of the input
+// @param last if false, more chunks are fed to the scanner with feed(),
+//        otherwise chunk is the whole input
+inline scanner scan_generator(std::string_view chunk, bool last = true) {
+  detail::scan_state state = detail::SCAN_NONE;
+  scanner::promise_type& promise = co_await scanner::promise_access{};
+  // the current word, copied so that it can span chunks
+  char token[VBT__MAX_STR_LEN];
+  vbt_size_t len = 0;
+  // parentheses open in the list
+  int depth = 0;
+  bool overflow = false;
+  bool candidate = false;
+  vbt_size_t base = 0;
+  scan_record record = {0, 0, {0, 0, 0, 0}};
+
+  for (;;) {
+    for (vbt_size_t i = 0; i <= chunk.size(); i++) {
+      bool end = false;
+
+      if (i == chunk.size()) {
+        // the input ends a word, otherwise it continues in the next chunk
+        if (!last || state == detail::SCAN_NONE) {
+          break;
+        }
+        end = true;
+      } else {
+        const unsigned char c = (unsigned char)chunk[i];
+
+        if (state == detail::SCAN_NONE) {
+          if (!detail::is_scan_word(c)) {
+            continue;
+          }
+          state = detail::SCAN_WORD;
+          record.offset = base + i;
+          len = 0;
+          depth = 0;
+          overflow = false;
+          candidate = c == '#' || (c >= 'a' && c <= 'z') ||
+                      (c >= 'A' && c <= 'Z');
+        } else if (state == detail::SCAN_WORD && !detail::is_scan_word(c)) {
+          if (c != '(') {
+            end = true;
+          }
+          state = c == '(' ? detail::SCAN_ARGS : state;
+        }
+
+        if (!end) {
+          if (len < VBT__MAX_STR_LEN) {
+            token[len++] = (char)c;
+          } else {
+            overflow = true;
+          }
+          if (state == detail::SCAN_ARGS) {
+            depth += c == '(' ? 1 : (c == ')' ? -1 : 0);
+          }
+          // an unclosed '(' ends after the longest possible color
+          end = state == detail::SCAN_ARGS && (depth == 0 || overflow);
+        }
+      }
+
+      if (end) {
+        state = detail::SCAN_NONE;
+        if (candidate && !overflow &&
+            parse(token, len, record.color) == VBT_SUCCESS) {
+          record.length = len;
+          co_yield record;
+        }
+      }
+    }
+
+    if (last) {
+      break;
+    }
+
+    base += chunk.size();
+    promise.needs_input = true;
+    co_await std::suspend_always{};
+    chunk = promise.chunk;
+    last = promise.last;
+  }
+}
+
+}  // namespace vbt
+
+#endif  // __cpp_impl_coroutine
+#endif  // VIBRANT_SCAN
+
+#ifndef VIBRANT_NO_PARSE
+
+// Parser tables. They are shared by the implementation and the C++ constexpr
+// parser below and are not part of the API.
+
+// first byte classes, see VBT__FIRST_BYTE_CLASS_TABLE
+#define VBT__BYTE_INVALID (0)
+#define VBT__BYTE_HEX (1)
+#define VBT__BYTE_NAME (2)
+#define VBT__BYTE_FUNCTION (3)
+
+typedef struct vbt__css_color_t {
+  const char* name;
+  vbt_u8_t color[4];
+} vbt__css_color_t;
+
+typedef struct vbt__css_function_t {
+  const char* name;
+  vbt_size_t len;
+} vbt__css_function_t;
+
+// indexed by vbt_color_fn_t
+#define VBT__CSS_FUNCTION_TABLE \
+  {NULL, 0},                    \
+  {"rgb", 3},                   \
+  {"hsl", 3},                   \
+  {"hwb", 3},                   \
+  {"lch", 3},                   \
+  {"lab", 3},                   \
+  {"oklch", 5},                 \
+  {"oklab", 5},
+
+#define VBT__CSS_COLOR(NAME, R, G, B, A) {NAME, {R, G, B, A}}
+#define VBT__CSS_COLOR_EMPTY {NULL, {0, 0, 0, 0}}
+
+// byte classes of a css function body, see VBT__FN_BYTE_CLASS_TABLE
+typedef enum vbt__fn_class_t {
+  VBT__FC_OTHER = 0,
+  VBT__FC_SPACE,
+  VBT__FC_NUMBER,
+  VBT__FC_COMMA,
+  VBT__FC_SLASH,
+  VBT__FC_PERCENT,
+  VBT__FC_OPEN,
+  VBT__FC_CLOSE,
+  VBT__FC_A,
+  VBT__FC_CALC,  // 'c' of calc(), a value like a number
+  VBT__FC_END,
+  VBT__FC_COUNT
+} vbt__fn_class_t;
+
+// states of the css function dfa. C_ states are in comma mode, S_ states in
+// space mode. the mode is picked by the first delimiter.
+typedef enum vbt__fn_state_t {
+  VBT__FS_ERR = 0,
+  VBT__FS_NAME,
+  VBT__FS_ALPHA,
+  VBT__FS_PRE_OPEN,
+  VBT__FS_PRE_0,
+  VBT__FS_VAL_0,
+  VBT__FS_PCT_0,
+  VBT__FS_WS_0,
+  VBT__FS_C_PRE_1,
+  VBT__FS_C_VAL_1,
+  VBT__FS_C_PCT_1,
+  VBT__FS_C_WS_1,
+  VBT__FS_C_PRE_2,
+  VBT__FS_C_VAL_2,
+  VBT__FS_C_PCT_2,
+  VBT__FS_C_WS_2,
+  VBT__FS_C_PRE_3,
+  VBT__FS_S_VAL_1,
+  VBT__FS_S_PCT_1,
+  VBT__FS_S_WS_1,
+  VBT__FS_S_VAL_2,
+  VBT__FS_S_PCT_2,
+  VBT__FS_S_WS_2,
+  VBT__FS_SLASH,
+  VBT__FS_PRE_3,
+  VBT__FS_VAL_3,
+  VBT__FS_PCT_3,
+  VBT__FS_WS_3,
+  VBT__FS_CLOSE,
+  VBT__FS_DONE,
+  VBT__FS_COUNT
+} vbt__fn_state_t;
+
+// what the parser does when it enters a state
+typedef enum vbt__fn_action_t {
+  VBT__FA_ERR = 0,
+  VBT__FA_NEXT,     // consume the byte
+  VBT__FA_ALPHA,    // consume 'a' of rgba(), hsla(), ...
+  VBT__FA_SLASH,    // consume '/', alpha follows
+  VBT__FA_VALUE,    // parse a number or calc(), the byte after it picks the
+                    // next state
+  VBT__FA_PERCENT,  // consume '%', the last value is a percentage
+  VBT__FA_DONE
+} vbt__fn_action_t;
+
+// clang-format off
+// classifies the first byte of a value: '#' starts a hex color, the letters
+// c, r, h, l and o may start a function or a color name, and every other
+// letter some css color name starts with (in either case) can only be a name.
+// any other byte can't start a color.
+#define VBT__FIRST_BYTE_CLASS_TABLE               \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 2, 2, 2, 2, 0, 2, 2, 2, 2, 0, 2, 2, 2, 2, 2, \
+  2, 0, 2, 2, 2, 0, 2, 2, 0, 2, 0, 0, 0, 0, 0, 0, \
+  0, 2, 2, 3, 2, 0, 2, 2, 3, 2, 0, 2, 3, 2, 2, 3, \
+  2, 0, 3, 2, 2, 0, 2, 2, 0, 2, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+
+// classifies the bytes of a css function body as vbt__fn_class_t
+#define VBT__FN_BYTE_CLASS_TABLE                  \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  1, 0, 0, 0, 0, 5, 0, 0, 6, 7, 0, 2, 3, 2, 2, 4, \
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 8, 0, 9, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, \
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+
+// [state][byte class] -> next state
+#define VBT__FN_DFA_TABLE                                                    \
+  /* VBT__FS_ERR */                                                          \
+  {VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_NAME */                                                         \
+  {VBT__FS_ERR, VBT__FS_PRE_OPEN, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,     \
+   VBT__FS_ERR, VBT__FS_PRE_0, VBT__FS_ERR, VBT__FS_ALPHA, VBT__FS_ERR,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_ALPHA */                                                        \
+  {VBT__FS_ERR, VBT__FS_PRE_OPEN, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,     \
+   VBT__FS_ERR, VBT__FS_PRE_0, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_PRE_OPEN */                                                     \
+  {VBT__FS_ERR, VBT__FS_PRE_OPEN, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,     \
+   VBT__FS_ERR, VBT__FS_PRE_0, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_PRE_0 */                                                        \
+  {VBT__FS_ERR, VBT__FS_PRE_0, VBT__FS_VAL_0, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_VAL_0,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_VAL_0 */                                                        \
+  {VBT__FS_ERR, VBT__FS_WS_0, VBT__FS_ERR, VBT__FS_C_PRE_1, VBT__FS_ERR,     \
+   VBT__FS_PCT_0, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_PCT_0 */                                                        \
+  {VBT__FS_ERR, VBT__FS_WS_0, VBT__FS_ERR, VBT__FS_C_PRE_1, VBT__FS_ERR,     \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_WS_0 */                                                         \
+  {VBT__FS_ERR, VBT__FS_WS_0, VBT__FS_S_VAL_1, VBT__FS_C_PRE_1, VBT__FS_ERR, \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_S_VAL_1,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_PRE_1 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_PRE_1, VBT__FS_C_VAL_1, VBT__FS_ERR, VBT__FS_ERR,  \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_C_VAL_1,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_VAL_1 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_WS_1, VBT__FS_ERR, VBT__FS_C_PRE_2, VBT__FS_ERR,   \
+   VBT__FS_C_PCT_1, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_PCT_1 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_WS_1, VBT__FS_ERR, VBT__FS_C_PRE_2, VBT__FS_ERR,   \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_WS_1 */                                                       \
+  {VBT__FS_ERR, VBT__FS_C_WS_1, VBT__FS_ERR, VBT__FS_C_PRE_2, VBT__FS_ERR,   \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_PRE_2 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_PRE_2, VBT__FS_C_VAL_2, VBT__FS_ERR, VBT__FS_ERR,  \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_C_VAL_2,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_VAL_2 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_WS_2, VBT__FS_ERR, VBT__FS_C_PRE_3, VBT__FS_SLASH, \
+   VBT__FS_C_PCT_2, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,    \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_PCT_2 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_WS_2, VBT__FS_ERR, VBT__FS_C_PRE_3, VBT__FS_SLASH, \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_WS_2 */                                                       \
+  {VBT__FS_ERR, VBT__FS_C_WS_2, VBT__FS_ERR, VBT__FS_C_PRE_3, VBT__FS_SLASH, \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_C_PRE_3 */                                                      \
+  {VBT__FS_ERR, VBT__FS_C_PRE_3, VBT__FS_VAL_3, VBT__FS_ERR, VBT__FS_ERR,    \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_VAL_3,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_VAL_1 */                                                      \
+  {VBT__FS_ERR, VBT__FS_S_WS_1, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,       \
+   VBT__FS_S_PCT_1, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_PCT_1 */                                                      \
+  {VBT__FS_ERR, VBT__FS_S_WS_1, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,       \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_WS_1 */                                                       \
+  {VBT__FS_ERR, VBT__FS_S_WS_1, VBT__FS_S_VAL_2, VBT__FS_ERR, VBT__FS_ERR,   \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_S_VAL_2,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_VAL_2 */                                                      \
+  {VBT__FS_ERR, VBT__FS_S_WS_2, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_SLASH,     \
+   VBT__FS_S_PCT_2, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,    \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_PCT_2 */                                                      \
+  {VBT__FS_ERR, VBT__FS_S_WS_2, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_SLASH,     \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_S_WS_2 */                                                       \
+  {VBT__FS_ERR, VBT__FS_S_WS_2, VBT__FS_VAL_3, VBT__FS_ERR, VBT__FS_SLASH,   \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_VAL_3,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_SLASH */                                                        \
+  {VBT__FS_ERR, VBT__FS_PRE_3, VBT__FS_VAL_3, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_VAL_3,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_PRE_3 */                                                        \
+  {VBT__FS_ERR, VBT__FS_PRE_3, VBT__FS_VAL_3, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_VAL_3,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_VAL_3 */                                                        \
+  {VBT__FS_ERR, VBT__FS_WS_3, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,         \
+   VBT__FS_PCT_3, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,      \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_PCT_3 */                                                        \
+  {VBT__FS_ERR, VBT__FS_WS_3, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,         \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_WS_3 */                                                         \
+  {VBT__FS_ERR, VBT__FS_WS_3, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,         \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR},                                                             \
+  /* VBT__FS_CLOSE */                                                        \
+  {VBT__FS_ERR, VBT__FS_CLOSE, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,        \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_DONE},                                                            \
+  /* VBT__FS_DONE */                                                         \
+  {VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR, VBT__FS_ERR,          \
+   VBT__FS_ERR},
+
+// indexed by vbt__fn_state_t
+#define VBT__FN_STATE_ACTION_TABLE                                             \
+  VBT__FA_ERR, VBT__FA_NEXT, VBT__FA_ALPHA, VBT__FA_NEXT, VBT__FA_NEXT,        \
+  VBT__FA_VALUE, VBT__FA_PERCENT, VBT__FA_NEXT, VBT__FA_NEXT, VBT__FA_VALUE,   \
+  VBT__FA_PERCENT, VBT__FA_NEXT, VBT__FA_NEXT, VBT__FA_VALUE, VBT__FA_PERCENT, \
+  VBT__FA_NEXT, VBT__FA_NEXT, VBT__FA_VALUE, VBT__FA_PERCENT, VBT__FA_NEXT,    \
+  VBT__FA_VALUE, VBT__FA_PERCENT, VBT__FA_NEXT, VBT__FA_SLASH, VBT__FA_NEXT,   \
+  VBT__FA_VALUE, VBT__FA_PERCENT, VBT__FA_NEXT, VBT__FA_NEXT, VBT__FA_DONE,
+
+// gperf generated perfect hash of the css color names, see vbt__hash
+#define VBT__CSS_COLOR_ASSO_VALUES                                           \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 5,   160, 0,   35,  0,   50,  10,  40,  0,   561, \
+  170, 10,  95,  85,  60,  80,  135, 0,   20,  45,  10,  50,  205, 35,  95,  \
+  561, 35,  561, 561, 561, 561, 561, 5,   160, 0,   35,  0,   50,  10,  40,  \
+  0,   561, 170, 10,  95,  85,  60,  80,  135, 0,   20,  45,  10,  50,  205, \
+  35,  95,  561, 35,  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, \
+  561, 561, 561,
+
+#define VBT__CSS_COLOR_LENGTHS                            \
+   0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   4,  0,  0,  0,  0,  0, 10,  0,  0,  0,  4,  5,  0,  0, \
+   0,  9, 10,  0,  0,  0,  9,  0,  0,  0,  0,  9,  0,  6, \
+   0,  0,  9,  0,  0,  0,  8,  4,  5,  0,  0,  3,  0,  0, \
+  11,  0,  0, 14,  0,  0,  7,  0, 14,  0,  6,  0,  0,  9, \
+   0,  0,  7,  0,  4,  0,  0,  0,  0,  9, 10,  0,  0,  0, \
+   0,  0,  0,  0,  8,  9,  0,  0,  0,  0,  0,  5, 11,  0, \
+   0,  4,  0,  6,  0,  0,  9,  0, 11,  0,  8, 14,  0,  6, \
+   0,  8,  9,  0,  6,  7,  0,  9,  0,  0,  7,  0,  4,  0, \
+  11,  0,  3,  4, 10,  6,  0, 13,  0,  0, 11,  0,  0,  0, \
+   5, 11,  0, 13,  9,  0,  0,  0,  0,  0,  0,  0,  7, 13, \
+  14,  0,  0,  0,  0,  4, 10, 11,  0, 13,  4,  5,  0,  0, \
+   0,  0, 20,  6,  0,  0,  9,  5,  6,  0,  0,  9, 10,  0, \
+   0,  8,  9,  0,  0,  0,  8,  9,  0,  0, 12,  0,  9,  0, \
+   6,  7,  0,  9, 10,  0,  7,  0,  9,  0,  0, 12,  8,  9, \
+   0,  0,  0,  0,  4,  5,  0,  0,  0,  9,  5,  0,  0,  0, \
+   9, 10,  0,  0,  0,  9,  0,  6,  7,  8,  0,  5,  6,  0, \
+   0,  9,  0, 11,  0,  0,  0,  0,  0,  0, 13,  9,  0,  0, \
+  12, 13,  0,  0,  0,  0, 13,  0,  0,  0,  0,  0,  0, 10, \
+   0,  0,  0,  0,  0,  0,  0,  8, 14,  0,  0,  0,  0,  9, \
+   0,  0, 12, 13,  9,  0,  0,  0,  0,  4,  0,  0,  0, 13, \
+   0,  0,  0,  0,  0,  0,  5,  0,  0,  0,  9,  0,  0, 12, \
+   8,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   7,  0,  0,  0,  0,  0,  0,  0, 10,  0,  0,  0,  0,  5, \
+   0,  0,  0,  0, 10,  0, 12, 13,  0,  0,  0, 12,  0,  0, \
+  15,  0,  7,  0, 14, 10,  0,  0,  0,  0,  0,  0,  0,  0, \
+   9,  0,  0,  0,  8,  4, 15,  0,  0,  0,  0,  0,  0, 17, \
+  13,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  6, \
+   0,  0, 14,  0,  0,  0,  0,  0, 10, 16,  0,  0,  0,  0, \
+  11,  0,  0,  9,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+  10,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0, 11,  0,  0,  0,  0,  0,  0,  0,  0, 10,  0,  0, \
+   0,  0,  0, 11,  0,  0,  0, 15,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0, 11,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  9,  0,  0,  0,  0,  0,  0, \
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, \
+  10,
+
+// C(name, r, g, b, a) for every hash value, X for unused ones
+#define VBT__CSS_COLOR_WORDLIST(C, X)            \
+  X, X, X, X,                                    \
+  C("cyan", 0, 255, 255, 255),                   \
+  X, X, X, X, X,                                 \
+  X, X, X, X,                                    \
+  C("gray", 128, 128, 128, 255),                 \
+  X, X, X, X, X,                                 \
+  C("chartreuse", 127, 255, 0, 255),             \
+  X, X, X,                                       \
+  C("grey", 128, 128, 128, 255),                 \
+  C("green", 0, 128, 0, 255),                    \
+  X, X, X,                                       \
+  C("lightgrey", 211, 211, 211, 255),            \
+  C("lightgreen", 144, 238, 144, 255),           \
+  X, X, X,                                       \
+  C("lightgray", 211, 211, 211, 255),            \
+  X, X, X, X,                                    \
+  C("slategrey", 112, 128, 144, 255),            \
+  X,                                             \
+  C("sienna", 160, 82, 45, 255),                 \
+  X, X,                                          \
+  C("slategray", 112, 128, 144, 255),            \
+  X, X, X,                                       \
+  C("seashell", 255, 245, 238, 255),             \
+  C("teal", 0, 128, 128, 255),                   \
+  C("coral", 255, 127, 80, 255),                 \
+  X, X,                                          \
+  C("red", 255, 0, 0, 255),                      \
+  X, X,                                          \
+  C("lightsalmon", 255, 160, 122, 255),          \
+  X, X,                                          \
+  C("lightslategrey", 119, 136, 153, 255),       \
+  X, X,                                          \
+  C("fuchsia", 255, 0, 255, 255),                \
+  X,                                             \
+  C("lightslategray", 119, 136, 153, 255),       \
+  X,                                             \
+  C("orange", 255, 165, 0, 255),                 \
+  X, X,                                          \
+  C("orangered", 255, 69, 0, 255),               \
+  X, X,                                          \
+  C("skyblue", 135, 206, 235, 255),              \
+  X,                                             \
+  C("lime", 0, 255, 0, 255),                     \
+  X, X, X, X,                                    \
+  C("limegreen", 50, 205, 50, 255),              \
+  C("lightcoral", 240, 128, 128, 255),           \
+  X, X, X, X, X, X,                              \
+  X,                                             \
+  C("lavender", 230, 230, 250, 255),             \
+  C("darkgreen", 0, 100, 0, 255),                \
+  X, X, X, X, X,                                 \
+  C("linen", 250, 240, 230, 255),                \
+  C("springgreen", 0, 255, 127, 255),            \
+  X, X,                                          \
+  C("gold", 255, 215, 0, 255),                   \
+  X,                                             \
+  C("orchid", 218, 112, 214, 255),               \
+  X, X,                                          \
+  C("firebrick", 178, 34, 34, 255),              \
+  X,                                             \
+  C("darkmagenta", 139, 0, 139, 255),            \
+  X,                                             \
+  C("darkblue", 0, 0, 139, 255),                 \
+  C("lightsteelblue", 176, 196, 222, 255),       \
+  X,                                             \
+  C("silver", 192, 192, 192, 255),               \
+  X,                                             \
+  C("seagreen", 46, 139, 87, 255),               \
+  C("lawngreen", 124, 252, 0, 255),              \
+  X,                                             \
+  C("indigo", 75, 0, 130, 255),                  \
+  C("oldlace", 253, 245, 230, 255),              \
+  X,                                             \
+  C("lightcyan", 224, 255, 255, 255),            \
+  X, X,                                          \
+  C("darkred", 139, 0, 0, 255),                  \
+  X,                                             \
+  C("navy", 0, 0, 128, 255),                     \
+  X,                                             \
+  C("lightyellow", 255, 255, 224, 255),          \
+  X,                                             \
+  C("tan", 210, 180, 140, 255),                  \
+  C("peru", 205, 133, 63, 255),                  \
+  C("darkorchid", 153, 50, 204, 255),            \
+  C("purple", 128, 0, 128, 255),                 \
+  X,                                             \
+  C("lightseagreen", 32, 178, 170, 255),         \
+  X, X,                                          \
+  C("greenyellow", 173, 255, 47, 255),           \
+  X, X, X,                                       \
+  C("ivory", 255, 255, 240, 255),                \
+  C("transparent", 0, 0, 0, 0),                  \
+  X,                                             \
+  C("rebeccapurple", 102, 51, 153, 255),         \
+  C("indianred", 205, 92, 92, 255),              \
+  X, X, X, X,                                    \
+  X, X, X,                                       \
+  C("magenta", 255, 0, 255, 255),                \
+  C("lavenderblush", 255, 240, 245, 255),        \
+  C("darkolivegreen", 85, 107, 47, 255),         \
+  X, X, X, X,                                    \
+  C("snow", 255, 250, 250, 255),                 \
+  C("darkviolet", 148, 0, 211, 255),             \
+  C("forestgreen", 34, 139, 34, 255),            \
+  X,                                             \
+  C("darkslateblue", 72, 61, 139, 255),          \
+  C("pink", 255, 192, 203, 255),                 \
+  C("black", 0, 0, 0, 255),                      \
+  X, X, X, X,                                    \
+  C("lightgoldenrodyellow", 250, 250, 210, 255), \
+  C("tomato", 255, 99, 71, 255),                 \
+  X, X,                                          \
+  C("palegreen", 152, 251, 152, 255),            \
+  C("khaki", 240, 230, 140, 255),                \
+  C("bisque", 255, 228, 196, 255),               \
+  X, X,                                          \
+  C("turquoise", 64, 224, 208, 255),             \
+  C("darkorange", 255, 140, 0, 255),             \
+  X, X,                                          \
+  C("darkgrey", 169, 169, 169, 255),             \
+  C("lightpink", 255, 182, 193, 255),            \
+  X, X, X,                                       \
+  C("darkgray", 169, 169, 169, 255),             \
+  C("mintcream", 245, 255, 250, 255),            \
+  X, X,                                          \
+  C("darkseagreen", 143, 188, 143, 255),         \
+  X,                                             \
+  C("mistyrose", 255, 228, 225, 255),            \
+  X,                                             \
+  C("salmon", 250, 128, 114, 255),               \
+  C("dimgrey", 105, 105, 105, 255),              \
+  X,                                             \
+  C("lightblue", 173, 216, 230, 255),            \
+  C("darksalmon", 233, 150, 122, 255),           \
+  X,                                             \
+  C("dimgray", 105, 105, 105, 255),              \
+  X,                                             \
+  C("chocolate", 210, 105, 30, 255),             \
+  X, X,                                          \
+  C("lemonchiffon", 255, 250, 205, 255),         \
+  C("moccasin", 255, 228, 181, 255),             \
+  C("slateblue", 106, 90, 205, 255),             \
+  X, X, X, X,                                    \
+  C("aqua", 0, 255, 255, 255),                   \
+  C("azure", 240, 255, 255, 255),                \
+  X, X, X,                                       \
+  C("steelblue", 70, 130, 180, 255),             \
+  C("wheat", 245, 222, 179, 255),                \
+  X, X, X,                                       \
+  C("royalblue", 65, 105, 225, 255),             \
+  C("aquamarine", 127, 255, 212, 255),           \
+  X, X, X,                                       \
+  C("peachpuff", 255, 218, 185, 255),            \
+  X,                                             \
+  C("maroon", 128, 0, 0, 255),                   \
+  C("thistle", 216, 191, 216, 255),              \
+  C("cornsilk", 255, 248, 220, 255),             \
+  X,                                             \
+  C("olive", 128, 128, 0, 255),                  \
+  C("violet", 238, 130, 238, 255),               \
+  X, X,                                          \
+  C("cadetblue", 95, 158, 160, 255),             \
+  X,                                             \
+  C("saddlebrown", 139, 69, 19, 255),            \
+  X, X, X, X, X, X,                              \
+  C("darkslategrey", 47, 79, 79, 255),           \
+  C("goldenrod", 218, 165, 32, 255),             \
+  X, X,                                          \
+  C("midnightblue", 25, 25, 112, 255),           \
+  C("darkslategray", 47, 79, 79, 255),           \
+  X, X, X, X,                                    \
+  C("darkturquoise", 0, 206, 209, 255),          \
+  X, X, X, X, X, X,                              \
+  C("dodgerblue", 30, 144, 255, 255),            \
+  X, X, X, X,                                    \
+  X, X, X,                                       \
+  C("darkcyan", 0, 139, 139, 255),               \
+  C("mediumseagreen", 60, 179, 113, 255),        \
+  X, X, X, X,                                    \
+  C("olivedrab", 107, 142, 35, 255),             \
+  X, X,                                          \
+  C("antiquewhite", 250, 235, 215, 255),         \
+  C("palevioletred", 219, 112, 147, 255),        \
+  C("rosybrown", 188, 143, 143, 255),            \
+  X, X, X, X,                                    \
+  C("plum", 221, 160, 221, 255),                 \
+  X, X, X,                                       \
+  C("darkgoldenrod", 184, 134, 11, 255),         \
+  X, X, X, X, X, X,                              \
+  C("brown", 165, 42, 42, 255),                  \
+  X, X, X,                                       \
+  C("darkkhaki", 189, 183, 107, 255),            \
+  X, X,                                          \
+  C("lightskyblue", 135, 206, 250, 255),         \
+  C("deeppink", 255, 20, 147, 255),              \
+  X, X, X, X,                                    \
+  X, X, X, X,                                    \
+  X, X, X, X,                                    \
+  X,                                             \
+  C("crimson", 220, 20, 60, 255),                \
+  X, X, X, X,                                    \
+  X, X, X,                                       \
+  C("sandybrown", 244, 164, 96, 255),            \
+  X, X, X, X,                                    \
+  C("beige", 245, 245, 220, 255),                \
+  X, X, X, X,                                    \
+  C("papayawhip", 255, 239, 213, 255),           \
+  X,                                             \
+  C("mediumpurple", 147, 112, 219, 255),         \
+  C("paleturquoise", 175, 238, 238, 255),        \
+  X, X, X,                                       \
+  C("mediumorchid", 186, 85, 211, 255),          \
+  X, X,                                          \
+  C("mediumvioletred", 199, 21, 133, 255),       \
+  X,                                             \
+  C("hotpink", 255, 105, 180, 255),              \
+  X,                                             \
+  C("cornflowerblue", 100, 149, 237, 255),       \
+  C("powderblue", 176, 224, 230, 255),           \
+  X, X, X, X,                                    \
+  X, X, X, X,                                    \
+  C("aliceblue", 240, 248, 255, 255),            \
+  X, X, X,                                       \
+  C("honeydew", 240, 255, 240, 255),             \
+  C("blue", 0, 0, 255, 255),                     \
+  C("mediumturquoise", 72, 209, 204, 255),       \
+  X, X, X, X, X, X,                              \
+  C("mediumspringgreen", 0, 250, 154, 255),      \
+  C("palegoldenrod", 238, 232, 170, 255),        \
+  X,                                             \
+  C("white", 255, 255, 255, 255),                \
+  X, X, X, X, X, X,                              \
+  X, X, X, X,                                    \
+  C("yellow", 255, 255, 0, 255),                 \
+  X, X,                                          \
+  C("blanchedalmond", 255, 235, 205, 255),       \
+  X, X, X, X, X,                                 \
+  C("ghostwhite", 248, 248, 255, 255),           \
+  C("mediumaquamarine", 102, 205, 170, 255),     \
+  X, X, X, X,                                    \
+  C("yellowgreen", 154, 205, 50, 255),           \
+  X, X,                                          \
+  C("gainsboro", 220, 220, 220, 255),            \
+  X, X, X, X, X, X,                              \
+  X, X, X, X,                                    \
+  C("mediumblue", 0, 0, 205, 255),               \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X,                                       \
+  C("navajowhite", 255, 222, 173, 255),          \
+  X, X, X, X,                                    \
+  X, X, X, X,                                    \
+  C("blueviolet", 138, 43, 226, 255),            \
+  X, X, X, X, X,                                 \
+  C("floralwhite", 255, 250, 240, 255),          \
+  X, X, X,                                       \
+  C("mediumslateblue", 123, 104, 238, 255),      \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X,                                             \
+  C("deepskyblue", 0, 191, 255, 255),            \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X,                                       \
+  C("burlywood", 222, 184, 135, 255),            \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X, X, X, X, X,                              \
+  X, X,                                          \
+  C("whitesmoke", 245, 245, 245, 255)
+// clang-format on
+
+
+#endif  // VIBRANT_NO_PARSE
+
+#endif  // VIBRANT_H
+
+// The core of the implementation: color evaluation and conversion, and the
+// parser. It is written in the subset of C that is also C++14 constexpr, so
+// that vbt::parse() runs the same code as vbt_parse() in a constant
+// expression. It is compiled with the implementation, and with
+// VIBRANT_CONSTEXPR into every file that includes vibrant.h, once.
+#if !defined(VBT__CORE) && \
+    (defined(VIBRANT_IMPLEMENTATION) || defined(VBT__CONSTEXPR_CORE))
+#define VBT__CORE
+
+#ifdef __cplusplus
+#include <cfloat>  // FLT_EVAL_METHOD
+#include <cmath>   // fmod, floor, isfinite, pow, sin, cbrt, sqrt, atan2, exp
+#else
+#include <float.h>  // FLT_EVAL_METHOD
+#include <math.h>   // fmod, floor, isfinite, pow, sin, cbrt, sqrt, atan2, exp
+#endif
+
+#if defined(VIBRANT_DOUBLE_PRECISION)
+#define VBT__LIBM(fn) fn
+#define VBT__NUMBER_MANT_DIG (53)
+#else
+#define VBT__LIBM(fn) fn##f
+#define VBT__NUMBER_MANT_DIG (24)
+#endif
+
+#ifdef VBT__CONSTEXPR_CORE
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VBT__CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#if !defined(VBT__CONSTANT_EVALUATED) && \
+    ((defined(__GNUC__) && __GNUC__ >= 9) || \
+     (defined(_MSC_VER) && _MSC_VER >= 1925))
+#define VBT__CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+// a compiler that can not tell uses the vbt__det_* functions at runtime too
+#ifndef VBT__CONSTANT_EVALUATED
+#define VBT__CONSTANT_EVALUATED() (1)
+#endif
+
+// the builtin is false in any function that is not constexpr, asking through
+// a constexpr function keeps the compiler from warning about it there
+static VBT__INLINE constexpr bool vbt__constant_evaluated(void) {
+  return VBT__CONSTANT_EVALUATED();
+}
+#endif  // VBT__CONSTEXPR_CORE
+
+// math.h is not constexpr. in a constant expression, the core calls the
+// vbt__det_* functions instead, which VIBRANT_DETERMINISTIC always calls.
+// floor, ldexp and isfinite are exact, and only replaced in constant
+// expressions.
+#ifdef VBT__CONSTEXPR_CORE
+#define VBT__CONSTEXPR_MATH(det, libm) (vbt__constant_evaluated() ? det : libm)
+#else
+#define VBT__CONSTEXPR_MATH(det, libm) (libm)
+#endif
+#ifdef __cplusplus
+#define VBT__ISFINITE std::isfinite
+#else
+#define VBT__ISFINITE isfinite
+#endif
+#ifdef VIBRANT_DETERMINISTIC
+#define VBT__MATH(det, libm) ((vbt_number_t)(det))
+#else
+#define VBT__MATH(det, libm) VBT__CONSTEXPR_MATH((vbt_number_t)(det), libm)
+#endif
+
+#define vbt__fmod(x, y) VBT__MATH(vbt__det_fmod(x, y), VBT__LIBM(fmod)(x, y))
+#define vbt__pow(x, y) VBT__MATH(vbt__det_pow(x, y), VBT__LIBM(pow)(x, y))
+#define vbt__sin(x) VBT__MATH(vbt__det_sin(x), VBT__LIBM(sin)(x))
+#define vbt__cbrt(x) VBT__MATH(vbt__det_cbrt(x), VBT__LIBM(cbrt)(x))
+#define vbt__sqrt(x) VBT__MATH(vbt__det_sqrt(x), VBT__LIBM(sqrt)(x))
+#define vbt__atan2(y, x) \
+  VBT__MATH(vbt__det_atan2(y, x), VBT__LIBM(atan2)(y, x))
+#define vbt__exp(x) VBT__MATH(vbt__det_exp(x), VBT__LIBM(exp)(x))
+#define vbt__floor(x) \
+  VBT__CONSTEXPR_MATH((vbt_number_t)vbt__det_floor(x), VBT__LIBM(floor)(x))
+#define vbt__ldexp(x, e) \
+  VBT__CONSTEXPR_MATH((vbt_number_t)vbt__det_scale(x, e), \
+                      VBT__LIBM(ldexp)(x, e))
+#define vbt__isfinite(x) \
+  VBT__CONSTEXPR_MATH(vbt__det_isfinite(x), VBT__ISFINITE(x))
+
+#if defined(VIBRANT_FIXED_POINT) && defined(VIBRANT_DETERMINISTIC)
+#error "VIBRANT_FIXED_POINT is deterministic, do not define both"
+#endif
+
+#if defined(VIBRANT_GAMUT_MAP_FAST) && !defined(VIBRANT_GAMUT_MAP)
+#define VIBRANT_GAMUT_MAP
+#endif
+
+#if defined(VIBRANT_FIXED_POINT) && defined(VIBRANT_GAMUT_MAP)
+#error "VIBRANT_GAMUT_MAP needs floating point, not VIBRANT_FIXED_POINT"
+#endif
+
+#ifdef VIBRANT_DETERMINISTIC
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+#error "VIBRANT_DETERMINISTIC requires FLT_EVAL_METHOD == 0 (SSE2 on x86)"
+#endif
+
+// the implementation is compiled with strict IEEE 754 semantics, whatever
+// the flags of the including file: no fast-math and no contraction of
+// a * b + c into an fma, which would round differently.
+#if defined(__clang__) || defined(_MSC_VER)
+#pragma float_control(precise, on, push)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math", "fp-contract=off")
+#endif
+#endif  // VIBRANT_DETERMINISTIC
+
+// keeps rarely taken paths out of their callers
+#if defined(VBT__CONSTEXPR_CORE)
+// constexpr functions are inline
+#define VBT__NOINLINE
+#elif defined(_MSC_VER)
+#define VBT__NOINLINE __declspec(noinline)
+#elif defined(__GNUC__) || defined(__clang__)
+#define VBT__NOINLINE __attribute__((noinline))
+#else
+#define VBT__NOINLINE
+#endif
+
+// inlines kernels into loops, so that the loops can be vectorized
+#if defined(_MSC_VER)
+#define VBT__FORCEINLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#define VBT__FORCEINLINE inline __attribute__((always_inline))
+#else
+#define VBT__FORCEINLINE VBT__INLINE
+#endif
+
+#define VBT__PI ((vbt_number_t)3.14159265358979323846)
+
+// sRGB D65 reference white
+#define VBT__D65_X ((vbt_number_t)0.95047)
+#define VBT__D65_Y ((vbt_number_t)1.0)
+#define VBT__D65_Z ((vbt_number_t)1.08883)
+
+// CIE Standard Illuminant D50
+#define VBT__CIE_E ((vbt_number_t)(216.0 / 24389.0))
+#define VBT__CIE_K ((vbt_number_t)(24389.0 / 27.0))
+
+#define VBT__NUMBER_MAX ((vbt_number_t)(VBT__NUMBER_MAX_INT))
+#define VBT__DEG_MIN ((vbt_number_t)(0))
+#define VBT__DEG_MAX ((vbt_number_t)(360))
+#define VBT__PERCENT_MIN ((vbt_number_t)(0))
+#define VBT__PERCENT_MAX ((vbt_number_t)(100))
+
+#define VBT__ARR_LEN(a) (sizeof(a) / sizeof(a[0]))
+#define VBT__MIN(a, b) ((a) < (b) ? (a) : (b))
+#define VBT__MAX(a, b) ((a) > (b) ? (a) : (b))
+#define VBT__CLAMP(val, min, max) \
+  ((val) < (min) ? (min) : ((val) > (max) ? (max) : (val)))
+#define VBT__CLAMP_01(val) VBT__CLAMP(val, (vbt_number_t)(0), (vbt_number_t)(1))
+#define VBT__CLAMP_0100(val) VBT__CLAMP(val, VBT__PERCENT_MIN, VBT__PERCENT_MAX)
+#define VBT__CLAMP_0360(val) VBT__CLAMP(val, VBT__DEG_MIN, VBT__DEG_MAX)
+
+// texels vbt_gradient_bake() converts at a time, on the stack
+#define VBT__BAKE_CHUNK (64)
+// hues vbt__sincos_chunk() converts at a time, on the stack
+#define VBT__HUE_CHUNK (256)
+
+// linear-light sRGB this far out of [0-1] is in gamut, as it is only out by
+// rounding
+#define VBT__GAMUT_TOLERANCE ((vbt_number_t)0.000075)
+
+// [0-1] to [0-255]
+// assume clamped, round might be more accurate?
+#define VBT__01_TO_255(comp) \
+  (vbt_u8_t)(comp * (vbt_number_t)(255) + (vbt_number_t)(0.5))
+
+typedef int vbt_bool_t;
+#define VBT__TRUE (1)
+#define VBT__FALSE (0)
+
+// zero initializer of a struct, which a C++14 constexpr function needs
+#ifdef __cplusplus
+#define VBT__ZERO {}
+#else
+#define VBT__ZERO {0}
+#endif
+
+#ifdef VIBRANT_FIXED_POINT
+// fixed point number with 24 fraction bits, see vbt__fx_color_eval()
+typedef int64_t vbt__fx_t;
+#endif
+
+// clang-format off
+static VBT__CONSTEXPR vbt_u8_t vbt__number_to_u8(vbt_number_t value);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__normalize_angle(vbt_number_t hue);
+static VBT__CONSTEXPR void vbt__sincos_deg(vbt_number_t angle, vbt_number_t* s, vbt_number_t* c);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__sincos_quadrant(vbt_number_t a, vbt_number_t* s, vbt_number_t* c);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__sincos_table(int deg, vbt_number_t* s, vbt_number_t* c);
+#ifdef VIBRANT_FIXED_POINT
+static VBT__CONSTEXPR int vbt__fx_color_eval(vbt_color_fn_t fn, const vbt_number_t* arg, vbt_u8_t* rgba8);
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_from_number(vbt_number_t value, vbt_number_t min, vbt_number_t max);
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_mul(vbt__fx_t a, vbt__fx_t b);
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_normalize_angle(vbt_number_t angle);
+static VBT__CONSTEXPR void vbt__fx_sincos_deg(vbt__fx_t angle, vbt__fx_t* s, vbt__fx_t* c);
+static VBT__CONSTEXPR vbt_u8_t vbt__fx_to_u8(vbt__fx_t value);
+static VBT__CONSTEXPR vbt_u8_t vbt__fx_linear_to_u8(vbt__fx_t c);
+static VBT__CONSTEXPR void vbt__fx_hsl_to_rgb(vbt__fx_t h, vbt__fx_t s, vbt__fx_t l, vbt__fx_t* rgb);
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_hsl_to_rgb_fn(vbt__fx_t h, vbt__fx_t s, vbt__fx_t l, int n);
+static VBT__CONSTEXPR void vbt__fx_hwb_to_rgb(vbt__fx_t h, vbt__fx_t w, vbt__fx_t b, vbt_u8_t* rgb);
+static VBT__CONSTEXPR void vbt__fx_lab_to_rgb(vbt__fx_t lightness, vbt__fx_t a, vbt__fx_t b, vbt_u8_t* rgb);
+static VBT__CONSTEXPR void vbt__fx_oklab_to_rgb(vbt__fx_t lightness, vbt__fx_t a, vbt__fx_t b, vbt_u8_t* rgb);
+#else
+static VBT__CONSTEXPR void vbt__hsl_to_rgb(vbt_number_t hue, vbt_number_t saturation, vbt_number_t lightness, vbt_number_t* r, vbt_number_t* g, vbt_number_t* b);
+static VBT__CONSTEXPR vbt_number_t vbt__hsl_to_rgb_fn(vbt_number_t h, vbt_number_t s, vbt_number_t l, vbt_number_t n);
+static VBT__CONSTEXPR void vbt__hwb_to_rgb(vbt_number_t hue, vbt_number_t whiteness, vbt_number_t blackness, vbt_number_t* rgb);
+static VBT__CONSTEXPR void vbt__lab_to_rgb(vbt_number_t lightness, vbt_number_t a, vbt_number_t b, vbt_number_t* rgb);
+static VBT__CONSTEXPR void vbt__oklab_to_rgb(vbt_number_t lightness, vbt_number_t a, vbt_number_t b, vbt_number_t* rgb);
+#endif
+#ifdef VIBRANT_GAMUT_MAP
+static VBT__CONSTEXPR void vbt__gamut_map(vbt_number_t* lin, const vbt_number_t* oklab);
+static VBT__CONSTEXPR void vbt__gamut_map_chroma(vbt_number_t* lin, const vbt_number_t* lab, vbt_number_t chroma);
+static VBT__CONSTEXPR vbt_number_t vbt__gamut_clip(const vbt_number_t* lin, const vbt_number_t* lab, vbt_number_t* clipped);
+#ifdef VIBRANT_GAMUT_MAP_FAST
+static VBT__CONSTEXPR void vbt__gamut_cusp_lookup(vbt_number_t a, vbt_number_t b, vbt_number_t* cusp);
+#endif
+#endif
+#if defined(VIBRANT_DETERMINISTIC) || defined(VBT__CONSTEXPR_CORE)
+static VBT__CONSTEXPR double vbt__det_fmod(double x, double y);
+static VBT__CONSTEXPR double vbt__det_scale(double x, int e);
+static VBT__CONSTEXPR double vbt__det_pow(double x, double y);
+static VBT__CONSTEXPR double vbt__det_sin(double x);
+static VBT__CONSTEXPR double vbt__det_cbrt(double x);
+static VBT__CONSTEXPR double vbt__det_sqrt(double x);
+static VBT__CONSTEXPR double vbt__det_atan2(double y, double x);
+static VBT__CONSTEXPR double vbt__det_exp(double x);
+#endif
+#ifdef VBT__CONSTEXPR_CORE
+static VBT__CONSTEXPR double vbt__det_floor(double x);
+static VBT__CONSTEXPR bool vbt__det_isfinite(double x);
+static VBT__CONSTEXPR double vbt__det_sqrt_newton(double x);
+#endif
+static VBT__CONSTEXPR int vbt__color_kernel(vbt_color_fn_t fn, const vbt_number_t* arg, vbt_u8_t* rgba8, vbt_number_t* rgba);
+static VBT__CONSTEXPR int vbt__color_srgb(const vbt_color_t* color, vbt_number_t* rgba);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__srgb_to_linear(vbt_number_t c);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__linear_to_srgb(vbt_number_t c);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__srgb_hue(vbt_number_t r, vbt_number_t g, vbt_number_t b, vbt_number_t max, vbt_number_t d);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__lab_f(vbt_number_t t);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__to_polar(vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_hsl(const vbt_number_t* rgba, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_hwb(const vbt_number_t* rgba, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_lab(const vbt_number_t* rgba, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_lch(const vbt_number_t* rgba, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__linear_to_oklab(vbt_number_t r, vbt_number_t g, vbt_number_t b, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__linear_to_lab(vbt_number_t r, vbt_number_t g, vbt_number_t b, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__lab_to_linear(vbt_number_t lightness, vbt_number_t a, vbt_number_t b, vbt_number_t* lin);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__oklab_to_linear(vbt_number_t lightness, vbt_number_t a, vbt_number_t b, vbt_number_t* lin);
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_bool_t vbt__in_gamut(const vbt_number_t* lin);
+static VBT__CONSTEXPR int vbt__interpolation_stop(vbt_space_t space, const vbt_color_t* color, vbt_number_t* out);
+static VBT__CONSTEXPR void vbt__interpolation_steps(vbt_space_t space, vbt_hue_method_t hue, int premultiplied, const vbt_number_t* from, const vbt_number_t* to, vbt_number_t t0, vbt_number_t dt, vbt_number_t* start, vbt_number_t* step);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_oklab(const vbt_number_t* rgba, vbt_number_t* out);
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_oklch(const vbt_number_t* rgba, vbt_number_t* out);
+// clang-format on
+
+// converts a color to sRGB, as u8 for rgb colors, and as [0-1] numbers for
+// all other colors, or as u8 with VIBRANT_FIXED_POINT. returns how the color
+// is resolved, or VBT__RESOLVED_NONE when it is invalid.
+static VBT__CONSTEXPR int vbt__color_kernel(vbt_color_fn_t fn,
+                                            const vbt_number_t* arg,
+                                            vbt_u8_t* rgba8,
+                                            vbt_number_t* rgba) {
+  if (!vbt__isfinite(arg[0]) || !vbt__isfinite(arg[1]) ||
+      !vbt__isfinite(arg[2]) || !vbt__isfinite(arg[3])) {
+    return VBT__RESOLVED_NONE;
+  }
+
+#ifdef VIBRANT_FIXED_POINT
+  if (fn != VBT_COLOR_RGB) {
+    return vbt__fx_color_eval(fn, arg, rgba8) == VBT_SUCCESS
+               ? VBT__RESOLVED_U8
+               : VBT__RESOLVED_NONE;
+  }
+#endif
+
+  switch (fn) {
+    case VBT_COLOR_RGB: {
+      rgba8[0] = vbt__number_to_u8(arg[0]);
+      rgba8[1] = vbt__number_to_u8(arg[1]);
+      rgba8[2] = vbt__number_to_u8(arg[2]);
+      rgba8[3] = VBT__01_TO_255(VBT__CLAMP_01(arg[3]));
+
+      return VBT__RESOLVED_U8;
+    }
+#ifndef VIBRANT_FIXED_POINT
+    case VBT_COLOR_HSL: {
+      vbt__hsl_to_rgb(vbt__normalize_angle(arg[0]), VBT__CLAMP_0100(arg[1]),
+                      VBT__CLAMP_0100(arg[2]), &rgba[0], &rgba[1], &rgba[2]);
+      break;
+    }
+    case VBT_COLOR_HWB: {
+      vbt__hwb_to_rgb(arg[0], arg[1], arg[2], rgba);
+      break;
+    }
+    case VBT_COLOR_LCH: {
+      vbt_number_t s = 0, c = 0;
+      vbt__sincos_deg(arg[2], &s, &c);
+      vbt__lab_to_rgb(arg[0], arg[1] * c, arg[1] * s, rgba);
+      break;
+    }
+    case VBT_COLOR_LAB: {
+      vbt__lab_to_rgb(arg[0], arg[1], arg[2], rgba);
+      break;
+    }
+    case VBT_COLOR_OKLCH: {
+      vbt_number_t s = 0, c = 0;
+      vbt__sincos_deg(arg[2], &s, &c);
+      vbt__oklab_to_rgb(arg[0], arg[1] * c, arg[1] * s, rgba);
+      break;
+    }
+    case VBT_COLOR_OKLAB: {
+      vbt__oklab_to_rgb(arg[0], arg[1], arg[2], rgba);
+      break;
+    }
+#endif
+    default: {
+      return VBT__RESOLVED_NONE;
+    }
+  }
+
+  rgba[3] = VBT__CLAMP_01(arg[3]);
+
+  return VBT__RESOLVED_01;
+}
+
+// color to [0-1] sRGB. a color that is not resolved yet is converted, but
+// not memoized, as color may be const.
+static VBT__CONSTEXPR int vbt__color_srgb(const vbt_color_t* color,
+                                          vbt_number_t* rgba) {
+  vbt_u8_t rgba8[4] = {0, 0, 0, 0};
+  int resolved = color->resolved;
+
+  if (resolved == VBT__RESOLVED_NONE) {
+    resolved = vbt__color_kernel(color->fn, color->arg, rgba8, rgba);
+  } else {
+    for (int i = 0; i < 4; i++) {
+      if (resolved == VBT__RESOLVED_U8) {
+        rgba8[i] = color->srgb.u8[i];
+      } else {
+        rgba[i] = color->srgb.n[i];
+      }
+    }
+  }
+
+  if (resolved == VBT__RESOLVED_U8) {
+    for (int i = 0; i < 4; i++) {
+      rgba[i] = (vbt_number_t)rgba8[i] / (vbt_number_t)255;
+    }
+  }
+
+  return resolved == VBT__RESOLVED_NONE ? VBT_ERR : VBT_SUCCESS;
+}
+
+#ifndef VIBRANT_FIXED_POINT
+
+// https://www.w3.org/TR/css-color-4/#hwb-to-rgb
+/*
+function hwbToRgb(hue, white, black) {
+    white /= 100;
+    black /= 100;
+    if (white + black >= 1) {
+        let gray = white / (white + black);
+        return [gray, gray, gray];
+    }
+    let rgb = hslToRgb(hue, 100, 50);
+    for (let i = 0; i < 3; i++) {
+        rgb[i] *= (1 - white - black);
+        rgb[i] += white;
+    }
+    return rgb;
+}
+*/
+static VBT__CONSTEXPR void vbt__hwb_to_rgb(vbt_number_t hue,
+                                           vbt_number_t whiteness,
+                                           vbt_number_t blackness,
+                                           vbt_number_t* rgb) {
+  const vbt_number_t h = vbt__normalize_angle(hue);
+  const vbt_number_t w = VBT__CLAMP_0100(whiteness) / VBT__PERCENT_MAX;
+  const vbt_number_t b = VBT__CLAMP_0100(blackness) / VBT__PERCENT_MAX;
+  const vbt_number_t wb = w + b;
+
+  if (wb >= (vbt_number_t)1) {
+    vbt_number_t gray = w / wb;
+    rgb[0] = gray;
+    rgb[1] = gray;
+    rgb[2] = gray;
+    return;
+  }
+
+  vbt__hsl_to_rgb(h, 100, 50, &rgb[0], &rgb[1], &rgb[2]);
+
+  for (size_t i = 0; i < 3; i++) {
+    rgb[i] *= ((vbt_number_t)1.0 - w - b);
+    rgb[i] += w;
+  }
+}
+
+static VBT__CONSTEXPR void vbt__lab_to_rgb(vbt_number_t lightness,
+                                           vbt_number_t a,
+                                           vbt_number_t b,
+                                           vbt_number_t* rgb) {
+  vbt_number_t lin[3] = {0};
+
+  vbt__lab_to_linear(VBT__CLAMP_0100(lightness), a, b, lin);
+
+#ifdef VIBRANT_GAMUT_MAP
+  vbt__gamut_map(lin, NULL);
+#endif
+
+  rgb[0] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[0]));
+  rgb[1] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[1]));
+  rgb[2] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[2]));
+}
+
+static VBT__CONSTEXPR void vbt__oklab_to_rgb(vbt_number_t lightness,
+                                             vbt_number_t a,
+                                             vbt_number_t b,
+                                             vbt_number_t* rgb) {
+  vbt_number_t lab[3] = {0};
+  vbt_number_t lin[3] = {0};
+
+  lab[0] = VBT__CLAMP_0100(lightness);
+  lab[1] = a;
+  lab[2] = b;
+  vbt__oklab_to_linear(lab[0], lab[1], lab[2], lin);
+
+#ifdef VIBRANT_GAMUT_MAP
+  vbt__gamut_map(lin, lab);
+#endif
+
+  rgb[0] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[0]));
+  rgb[1] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[1]));
+  rgb[2] = VBT__CLAMP_01(vbt__linear_to_srgb(lin[2]));
+}
+
+#endif  // VIBRANT_FIXED_POINT
+
+// gamma encoded sRGB component to linear-light, the inverse of
+// vbt__linear_to_srgb()
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__srgb_to_linear(
+    vbt_number_t c) {
+  return (c > (vbt_number_t)0.04045)
+             ? vbt__pow((c + (vbt_number_t)0.055) / (vbt_number_t)1.055,
+                        (vbt_number_t)2.4)
+             : c / (vbt_number_t)12.92;
+}
+
+// linear-light sRGB component to gamma encoded sRGB
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__linear_to_srgb(
+    vbt_number_t c) {
+  return (c > (vbt_number_t)0.0031308)
+             ? (vbt_number_t)1.055 *
+                       vbt__pow(c, (vbt_number_t)1.0 / (vbt_number_t)2.4) -
+                   (vbt_number_t)0.055
+             : (vbt_number_t)12.92 * c;
+}
+
+// https://www.w3.org/TR/css-color-4/#rgb-to-hsl
+// hue in degrees of an sRGB color with the given max component and
+// max - min, 0 for grays
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__srgb_hue(
+    vbt_number_t r,
+    vbt_number_t g,
+    vbt_number_t b,
+    vbt_number_t max,
+    vbt_number_t d) {
+  const vbt_number_t h =
+      max == r ? (g - b) / d
+               : (max == g ? (b - r) / d + (vbt_number_t)2.0
+                           : (r - g) / d + (vbt_number_t)4.0);
+  const vbt_number_t deg = h * (vbt_number_t)60.0;
+
+  return d > 0 ? (deg < 0 ? deg + VBT__DEG_MAX : deg) : (vbt_number_t)0;
+}
+
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_hsl(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  const vbt_number_t r = rgba[0];
+  const vbt_number_t g = rgba[1];
+  const vbt_number_t b = rgba[2];
+  const vbt_number_t max = VBT__MAX(r, VBT__MAX(g, b));
+  const vbt_number_t min = VBT__MIN(r, VBT__MIN(g, b));
+  const vbt_number_t d = max - min;
+  const vbt_number_t l = (max + min) / (vbt_number_t)2.0;
+  const vbt_number_t m = VBT__MIN(l, (vbt_number_t)1.0 - l);
+
+  out[0] = vbt__srgb_hue(r, g, b, max, d);
+  out[1] = m > 0 ? d / (vbt_number_t)2.0 / m * VBT__PERCENT_MAX
+                 : (vbt_number_t)0;
+  out[2] = l * VBT__PERCENT_MAX;
+  out[3] = rgba[3];
+}
+
+// https://www.w3.org/TR/css-color-4/#rgb-to-hwb
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_hwb(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  const vbt_number_t r = rgba[0];
+  const vbt_number_t g = rgba[1];
+  const vbt_number_t b = rgba[2];
+  const vbt_number_t max = VBT__MAX(r, VBT__MAX(g, b));
+  const vbt_number_t min = VBT__MIN(r, VBT__MIN(g, b));
+
+  out[0] = vbt__srgb_hue(r, g, b, max, max - min);
+  out[1] = min * VBT__PERCENT_MAX;
+  out[2] = ((vbt_number_t)1.0 - max) * VBT__PERCENT_MAX;
+  out[3] = rgba[3];
+}
+
+// the inverse of the companding in vbt__lab_to_rgb()
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__lab_f(vbt_number_t t) {
+  return (t > VBT__CIE_E)
+             ? vbt__cbrt(t)
+             : (VBT__CIE_K * t + (vbt_number_t)16.0) / (vbt_number_t)116.0;
+}
+
+// a and b in out[1] and out[2] to chroma and hue in degrees
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__to_polar(vbt_number_t* out) {
+  const vbt_number_t a = out[1];
+  const vbt_number_t b = out[2];
+  const vbt_number_t h = vbt__atan2(b, a) * (vbt_number_t)180.0 / VBT__PI;
+
+  out[1] = vbt__sqrt(a * a + b * b);
+  out[2] = h < 0 ? h + VBT__DEG_MAX : h;
+}
+
+// the inverse matrix of vbt__lab_to_rgb()
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__linear_to_lab(
+    vbt_number_t r,
+    vbt_number_t g,
+    vbt_number_t b,
+    vbt_number_t* out) {
+  const vbt_number_t x = (vbt_number_t)0.4124564 * r +
+                         (vbt_number_t)0.3575761 * g +
+                         (vbt_number_t)0.1804375 * b;
+  const vbt_number_t y = (vbt_number_t)0.2126729 * r +
+                         (vbt_number_t)0.7151522 * g +
+                         (vbt_number_t)0.0721750 * b;
+  const vbt_number_t z = (vbt_number_t)0.0193339 * r +
+                         (vbt_number_t)0.1191920 * g +
+                         (vbt_number_t)0.9503041 * b;
+
+  const vbt_number_t fx = vbt__lab_f(x / VBT__D65_X);
+  const vbt_number_t fy = vbt__lab_f(y / VBT__D65_Y);
+  const vbt_number_t fz = vbt__lab_f(z / VBT__D65_Z);
+
+  out[0] = (vbt_number_t)116.0 * fy - (vbt_number_t)16.0;
+  out[1] = (vbt_number_t)500.0 * (fx - fy);
+  out[2] = (vbt_number_t)200.0 * (fy - fz);
+}
+
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_lab(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  vbt__linear_to_lab(vbt__srgb_to_linear(rgba[0]),
+                     vbt__srgb_to_linear(rgba[1]),
+                     vbt__srgb_to_linear(rgba[2]), out);
+  out[3] = rgba[3];
+}
+
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_lch(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  vbt__srgb_to_lab(rgba, out);
+  vbt__to_polar(out);
+}
+
+// the inverse matrices of vbt__oklab_to_rgb()
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__linear_to_oklab(
+    vbt_number_t r,
+    vbt_number_t g,
+    vbt_number_t b,
+    vbt_number_t* out) {
+  const vbt_number_t l = vbt__cbrt((vbt_number_t)0.4122214708 * r +
+                                   (vbt_number_t)0.5363325363 * g +
+                                   (vbt_number_t)0.0514459929 * b);
+  const vbt_number_t m = vbt__cbrt((vbt_number_t)0.2119034982 * r +
+                                   (vbt_number_t)0.6806995451 * g +
+                                   (vbt_number_t)0.1073969566 * b);
+  const vbt_number_t s = vbt__cbrt((vbt_number_t)0.0883024619 * r +
+                                   (vbt_number_t)0.2817188376 * g +
+                                   (vbt_number_t)0.6299787005 * b);
+
+  out[0] = (vbt_number_t)0.2104542553 * l + (vbt_number_t)0.7936177850 * m -
+           (vbt_number_t)0.0040720468 * s;
+  out[1] = (vbt_number_t)1.9779984951 * l - (vbt_number_t)2.4285922050 * m +
+           (vbt_number_t)0.4505937099 * s;
+  out[2] = (vbt_number_t)0.0259040371 * l + (vbt_number_t)0.7827717662 * m -
+           (vbt_number_t)0.8086757660 * s;
+}
+
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_oklab(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  vbt__linear_to_oklab(vbt__srgb_to_linear(rgba[0]),
+                       vbt__srgb_to_linear(rgba[1]),
+                       vbt__srgb_to_linear(rgba[2]), out);
+  out[3] = rgba[3];
+}
+
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__srgb_to_oklch(
+    const vbt_number_t* rgba,
+    vbt_number_t* out) {
+  vbt__srgb_to_oklab(rgba, out);
+  vbt__to_polar(out);
+}
+
+// CIE Lab to linear-light sRGB, which may be out of [0-1]
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__lab_to_linear(
+    vbt_number_t lightness,
+    vbt_number_t a,
+    vbt_number_t b,
+    vbt_number_t* lin) {
+  const vbt_number_t fy =
+      (lightness + (vbt_number_t)16.0) / (vbt_number_t)116.0;
+  const vbt_number_t fx = a / (vbt_number_t)500.0 + fy;
+  const vbt_number_t fz = fy - b / (vbt_number_t)200.0;
+
+  const vbt_number_t fx3 = fx * fx * fx;
+  const vbt_number_t fz3 = fz * fz * fz;
+
+  const vbt_number_t xr =
+      (fx3 > VBT__CIE_E)
+          ? fx3
+          : ((vbt_number_t)116.0 * fx - (vbt_number_t)16.0) / VBT__CIE_K;
+  const vbt_number_t yr = (lightness > VBT__CIE_K * VBT__CIE_E)
+                              ? vbt__pow(fy, (vbt_number_t)3.0)
+                              : lightness / VBT__CIE_K;
+  const vbt_number_t zr =
+      (fz3 > VBT__CIE_E)
+          ? fz3
+          : ((vbt_number_t)116.0 * fz - (vbt_number_t)16.0) / VBT__CIE_K;
+
+  const vbt_number_t x = xr * VBT__D65_X;
+  const vbt_number_t y = yr * VBT__D65_Y;
+  const vbt_number_t z = zr * VBT__D65_Z;
+
+  lin[0] = (vbt_number_t)3.2404542 * x - (vbt_number_t)1.5371385 * y -
+           (vbt_number_t)0.4985314 * z;
+  lin[1] = (vbt_number_t)-0.9692660 * x + (vbt_number_t)1.8760108 * y +
+           (vbt_number_t)0.0415560 * z;
+  lin[2] = (vbt_number_t)0.0556434 * x - (vbt_number_t)0.2040259 * y +
+           (vbt_number_t)1.0572252 * z;
+}
+
+// OKLab to linear-light sRGB, which may be out of [0-1]
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__oklab_to_linear(
+    vbt_number_t lightness,
+    vbt_number_t a,
+    vbt_number_t b,
+    vbt_number_t* lin) {
+  const vbt_number_t l_ = lightness + (vbt_number_t)0.3963377774 * a +
+                          (vbt_number_t)0.2158037573 * b;
+  const vbt_number_t m_ = lightness - (vbt_number_t)0.1055613423 * a -
+                          (vbt_number_t)0.0638541728 * b;
+  const vbt_number_t s_ = lightness - (vbt_number_t)0.0894841775 * a -
+                          (vbt_number_t)1.2914855480 * b;
+
+  const vbt_number_t l = l_ * l_ * l_;
+  const vbt_number_t m = m_ * m_ * m_;
+  const vbt_number_t s = s_ * s_ * s_;
+
+  lin[0] = (vbt_number_t)4.0767416621 * l - (vbt_number_t)3.3077115913 * m +
+           (vbt_number_t)0.2309699292 * s;
+  lin[1] = (vbt_number_t)-1.2684380046 * l + (vbt_number_t)2.6097574011 * m -
+           (vbt_number_t)0.3413193965 * s;
+  lin[2] = (vbt_number_t)-0.0041960863 * l - (vbt_number_t)0.7034186147 * m +
+           (vbt_number_t)1.7076147009 * s;
+}
+
+// linear-light sRGB in [0-1], give or take rounding
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_bool_t vbt__in_gamut(
+    const vbt_number_t* lin) {
+  const vbt_number_t lo = -VBT__GAMUT_TOLERANCE;
+  const vbt_number_t hi = (vbt_number_t)1 + VBT__GAMUT_TOLERANCE;
+
+  // & instead of &&, which would be a branch per channel
+  return (lin[0] >= lo) & (lin[0] <= hi) & (lin[1] >= lo) & (lin[1] <= hi) &
+         (lin[2] >= lo) & (lin[2] <= hi);
+}
+
+// color to space, with alpha. hue in [0-360)
+static VBT__CONSTEXPR int vbt__interpolation_stop(vbt_space_t space,
+                                                  const vbt_color_t* color,
+                                                  vbt_number_t* out) {
+  const vbt_number_t* arg = color->arg;
+  vbt_color_fn_t rect = VBT_COLOR_NONE;
+  vbt_color_fn_t polar = VBT_COLOR_NONE;
+  vbt_number_t rgba[4] = {0};
+
+  if (space == VBT_SPACE_LAB || space == VBT_SPACE_LCH) {
+    rect = VBT_COLOR_LAB;
+    polar = VBT_COLOR_LCH;
+  } else if (space == VBT_SPACE_OKLAB || space == VBT_SPACE_OKLCH) {
+    rect = VBT_COLOR_OKLAB;
+    polar = VBT_COLOR_OKLCH;
+  }
+
+  // keep the arguments, which may be outside of sRGB
+  if (color->fn == rect || color->fn == polar) {
+    const vbt_bool_t to_polar =
+        space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH;
+
+    out[0] = arg[0];
+    out[1] = arg[1];
+    out[2] = arg[2];
+    out[3] = VBT__CLAMP_01(arg[3]);
+
+    if (color->fn == polar && to_polar) {
+      out[2] = vbt__fmod(arg[2], VBT__DEG_MAX);
+      out[2] += out[2] < 0 ? VBT__DEG_MAX : 0;
+    } else if (color->fn == polar) {
+      vbt_number_t s = 0, c = 0;
+
+      vbt__sincos_deg(arg[2], &s, &c);
+      out[1] = arg[1] * c;
+      out[2] = arg[1] * s;
+    } else if (to_polar) {
+      vbt__to_polar(out);
+    }
+
+    return VBT_SUCCESS;
+  }
+
+  if (vbt__color_srgb(color, rgba) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  switch (space) {
+    case VBT_SPACE_SRGB: {
+      for (int i = 0; i < 4; i++) {
+        out[i] = rgba[i];
+      }
+      break;
+    }
+    case VBT_SPACE_SRGB_LINEAR: {
+      for (int i = 0; i < 3; i++) {
+        out[i] = vbt__srgb_to_linear(rgba[i]);
+      }
+      out[3] = rgba[3];
+      break;
+    }
+    case VBT_SPACE_LAB: {
+      vbt__srgb_to_lab(rgba, out);
+      break;
+    }
+    case VBT_SPACE_LCH: {
+      vbt__srgb_to_lch(rgba, out);
+      break;
+    }
+    case VBT_SPACE_OKLAB: {
+      vbt__srgb_to_oklab(rgba, out);
+      break;
+    }
+    default: {
+      vbt__srgb_to_oklch(rgba, out);
+      break;
+    }
+  }
+
+  return VBT_SUCCESS;
+}
+
+// start and step of the colors from stop from to stop to, at t0 + i * dt.
+// hues are fixed up with the hue method, and colors are premultiplied.
+// https://www.w3.org/TR/css-color-4/#interpolation
+static VBT__CONSTEXPR void vbt__interpolation_steps(vbt_space_t space,
+                                                    vbt_hue_method_t hue,
+                                                    int premultiplied,
+                                                    const vbt_number_t* from,
+                                                    const vbt_number_t* to,
+                                                    vbt_number_t t0,
+                                                    vbt_number_t dt,
+                                                    vbt_number_t* start,
+                                                    vbt_number_t* step) {
+  const vbt_bool_t polar = space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH;
+  // chroma under which a hue is powerless, 100x in LCH
+  const vbt_number_t achromatic =
+      (space == VBT_SPACE_LCH ? 100 : 1) * (vbt_number_t)0.0002;
+  vbt_number_t a[4] = {0};
+  vbt_number_t b[4] = {0};
+
+  for (int i = 0; i < 4; i++) {
+    a[i] = from[i];
+    b[i] = to[i];
+  }
+
+  if (polar) {
+    vbt_number_t dh = 0;
+
+    a[2] = a[1] < achromatic ? b[2] : a[2];
+    b[2] = b[1] < achromatic ? a[2] : b[2];
+    dh = b[2] - a[2];
+
+    // https://www.w3.org/TR/css-color-4/#hue-interpolation
+    switch (hue) {
+      case VBT_HUE_SHORTER: {
+        a[2] += dh > 180 ? VBT__DEG_MAX : 0;
+        b[2] += dh < -180 ? VBT__DEG_MAX : 0;
+        break;
+      }
+      case VBT_HUE_LONGER: {
+        a[2] += dh > 0 && dh < 180 ? VBT__DEG_MAX : 0;
+        b[2] += dh > -180 && dh <= 0 ? VBT__DEG_MAX : 0;
+        break;
+      }
+      case VBT_HUE_INCREASING: {
+        b[2] += dh < 0 ? VBT__DEG_MAX : 0;
+        break;
+      }
+      default: {
+        a[2] += dh > 0 ? VBT__DEG_MAX : 0;
+        break;
+      }
+    }
+  }
+
+  if (premultiplied) {
+    for (int i = 0; i < (polar ? 2 : 3); i++) {
+      a[i] *= a[3];
+      b[i] *= b[3];
+    }
+  }
+
+  for (int i = 0; i < 4; i++) {
+    start[i] = a[i] + t0 * (b[i] - a[i]);
+    step[i] = dt * (b[i] - a[i]);
+  }
+}
+
+#if defined(VIBRANT_DETERMINISTIC) || defined(VBT__CONSTEXPR_CORE)
+
+// math.h results differ across libm versions and compilers. the functions
+// below replace it with +, -, * and / in a fixed order, evaluated in double
+// precision, which every IEEE 754 platform rounds the same way. they are
+// also the math.h of constant expressions, see VBT__MATH().
+
+#define VBT__DET_PI (3.14159265358979323846)
+// ln(2) split in a part exact in 32 bits, and the rest
+#define VBT__DET_LN2_HI (6.93147180369123816490e-01)
+#define VBT__DET_LN2_LO (1.90821492927058770002e-10)
+
+// 1 / n, the series below multiply instead of divide
+static VBT__CONSTEXPR const double vbt__det_inv[] = {
+    0,        1.0 / 1,  1.0 / 2,  1.0 / 3,  1.0 / 4,  1.0 / 5,  1.0 / 6,
+    1.0 / 7,  1.0 / 8,  1.0 / 9,  1.0 / 10, 1.0 / 11, 1.0 / 12, 1.0 / 13,
+    1.0 / 14, 1.0 / 15, 1.0 / 16, 1.0 / 17, 1.0 / 18, 1.0 / 19, 1.0 / 20,
+    1.0 / 21, 1.0 / 22, 1.0 / 23, 1.0 / 24, 1.0 / 25,
+};
+
+// x - y * trunc(x / y), exactly. y > 0.
+static VBT__CONSTEXPR double vbt__det_fmod(double x, double y) {
+  double r = x < 0 ? -x : x;
+  double d = y;
+
+  // nan for inf and nan, like fmod()
+  if (x - x != 0) {
+    return x - x;
+  }
+
+  if (r < y) {
+    return x;
+  }
+
+  while (d <= r * 0.5) {
+    d *= 2;
+  }
+
+  // r < 2 * d holds throughout, so each r - d is exact (Sterbenz lemma)
+  for (; d >= y; d *= 0.5) {
+    if (r >= d) {
+      r -= d;
+    }
+  }
+
+  return x < 0 ? -r : r;
+}
+
+// x * 2^e, exact for normal results
+static VBT__CONSTEXPR double vbt__det_scale(double x, int e) {
+  for (; e > 0; e--) {
+    x *= 2;
+  }
+
+  for (; e < 0; e++) {
+    x *= 0.5;
+  }
+
+  return x;
+}
+
+// e^x = 2^n * e^r, |r| <= ln2 / 2
+static VBT__CONSTEXPR double vbt__det_exp(double x) {
+  // nan, and the limits of double, which also keep n in range
+  if (x != x) {
+    return x;
+  }
+
+  if (x > 710) {
+    return HUGE_VAL;
+  }
+
+  if (x < -746) {
+    return 0;
+  }
+
+  const int n = (int)(x / VBT__DET_LN2_HI + (x < 0 ? -0.5 : 0.5));
+  const double r = (x - n * VBT__DET_LN2_HI) - n * VBT__DET_LN2_LO;
+  double p = 1;
+
+  // 1 + r (1 + r/2 (1 + r/3 (...)))
+  for (int i = 14; i >= 1; i--) {
+    p = 1 + r * p * vbt__det_inv[i];
+  }
+
+  return vbt__det_scale(p, n);
+}
+
+// ln(x) = ln(m) + e * ln2, m in [sqrt(1/2), sqrt(2)). ln(m) = 2 atanh(y),
+// y = (m - 1) / (m + 1).
+static VBT__CONSTEXPR double vbt__det_log(double x) {
+  int e = 0;
+
+  // like log(): -inf at 0, nan below, and inf and nan unchanged
+  if (x == 0) {
+    return -HUGE_VAL;
+  }
+
+  if (x < 0) {
+    return (x - x) / 0.0;
+  }
+
+  if (x - x != 0) {
+    return x;
+  }
+
+  for (; x >= 1.4142135623730950488; e++) {
+    x *= 0.5;
+  }
+
+  for (; x < 0.70710678118654752440; e--) {
+    x *= 2;
+  }
+
+  const double y = (x - 1) / (x + 1);
+  const double y2 = y * y;
+  double p = vbt__det_inv[25];
+
+  // y (1 + y^2/3 + y^4/5 + ...)
+  for (int i = 23; i >= 1; i -= 2) {
+    p = vbt__det_inv[i] + y2 * p;
+  }
+
+  return e * VBT__DET_LN2_HI + (2 * y * p + e * VBT__DET_LN2_LO);
+}
+
+// x >= 0
+static VBT__CONSTEXPR double vbt__det_pow(double x, double y) {
+  return vbt__det_exp(y * vbt__det_log(x));
+}
+
+// sin(x), |x| <= pi / 2
+static VBT__CONSTEXPR double vbt__det_sin_poly(double x) {
+  const double x2 = x * x;
+  double p = 1;
+
+  // x (1 - x^2/(2*3) (1 - x^2/(4*5) (...)))
+  for (int k = 11; k >= 1; k--) {
+    p = 1 - x2 * p * vbt__det_inv[2 * k] * vbt__det_inv[2 * k + 1];
+  }
+
+  return x * p;
+}
+
+static VBT__CONSTEXPR double vbt__det_sin(double x) {
+  x = vbt__det_fmod(x, 2 * VBT__DET_PI);
+
+  // to [-pi, pi], then to [-pi/2, pi/2] with sin(pi - x) = sin(x)
+  x = x > VBT__DET_PI ? x - 2 * VBT__DET_PI
+                      : (x < -VBT__DET_PI ? x + 2 * VBT__DET_PI : x);
+  x = x > VBT__DET_PI / 2 ? VBT__DET_PI - x
+                          : (x < -VBT__DET_PI / 2 ? -VBT__DET_PI - x : x);
+
+  return vbt__det_sin_poly(x);
+}
+
+static VBT__CONSTEXPR double vbt__det_cbrt(double x) {
+  if (x == 0) {
+    return 0;
+  }
+
+  return x < 0 ? -vbt__det_pow(-x, vbt__det_inv[3])
+               : vbt__det_pow(x, vbt__det_inv[3]);
+}
+
+// IEEE 754 requires sqrt() to be correctly rounded, so it is deterministic
+static VBT__CONSTEXPR double vbt__det_sqrt(double x) {
+#ifdef VBT__CONSTEXPR_CORE
+  if (VBT__CONSTANT_EVALUATED()) {
+    return vbt__det_sqrt_newton(x);
+  }
+#endif
+
+  return x > 0 ? sqrt(x) : 0;
+}
+
+// atan(x), 0 <= x <= 1. above tan(pi/12), atan(x) = pi/6 + atan(y), with
+// y = (x sqrt(3) - 1) / (x + sqrt(3)) in [-tan(pi/12), tan(pi/12)].
+static VBT__CONSTEXPR double vbt__det_atan(double x) {
+  double base = 0;
+
+  if (x > 0.26794919243112270) {
+    x = (x * 1.7320508075688772935 - 1) / (x + 1.7320508075688772935);
+    base = VBT__DET_PI / 6;
+  }
+
+  const double x2 = x * x;
+  double p = vbt__det_inv[25];
+
+  // x (1 - x^2/3 + x^4/5 - ...)
+  for (int i = 23; i >= 1; i -= 2) {
+    p = vbt__det_inv[i] - x2 * p;
+  }
+
+  return base + x * p;
+}
+
+static VBT__CONSTEXPR double vbt__det_atan2(double y, double x) {
+  const double ay = y < 0 ? -y : y;
+  const double ax = x < 0 ? -x : x;
+  double a = 0;
+
+  if (ay == 0 && ax == 0) {
+    return 0;
+  }
+
+  a = ay <= ax ? vbt__det_atan(ay / ax)
+               : VBT__DET_PI / 2 - vbt__det_atan(ax / ay);
+  a = x < 0 ? VBT__DET_PI - a : a;
+
+  return y < 0 ? -a : a;
+}
+
+#ifdef VBT__CONSTEXPR_CORE
+
+// floor(x), exact
+static VBT__CONSTEXPR double vbt__det_floor(double x) {
+  // 2^52 and above, inf and nan are integers or unchanged
+  if (!(x < 4503599627370496.0 && x > -4503599627370496.0)) {
+    return x;
+  }
+
+  const double t = (double)(long long)x;
+  return t > x ? t - 1 : t;
+}
+
+static VBT__CONSTEXPR bool vbt__det_isfinite(double x) {
+  return x - x == 0;
+}
+
+// sqrt(x) within an ulp, for constant expressions. x is scaled to [1/4, 1),
+// where Newton's method converges in a few steps.
+static VBT__CONSTEXPR double vbt__det_sqrt_newton(double x) {
+  int e = 0;
+  double y = 0;
+
+  if (!(x > 0) || x - x != 0) {
+    return x > 0 ? x : 0;
+  }
+
+  for (; x >= 1; e++) {
+    x *= 0.25;
+  }
+
+  for (; x < 0.25; e--) {
+    x *= 4;
+  }
+
+  y = (x + 1) * 0.5;
+
+  for (int i = 0; i < 6; i++) {
+    y = 0.5 * (y + x / y);
+  }
+
+  return vbt__det_scale(y, e);
+}
+
+#endif  // VBT__CONSTEXPR_CORE
+
+#endif  // VIBRANT_DETERMINISTIC || VBT__CONSTEXPR_CORE
+
+#ifdef VIBRANT_GAMUT_MAP
+
+// CSS Color 4 gamut mapping constants, in OKLab units
+#define VBT__GAMUT_JND ((vbt_number_t)0.02)
+#define VBT__GAMUT_EPSILON ((vbt_number_t)0.0001)
+
+#ifdef VIBRANT_GAMUT_MAP_FAST
+
+#define VBT__GAMUT_CUSP_STEPS 16
+
+// the Oklch hues of red, yellow, green, cyan, blue, magenta and red + 360.
+// the cusp turns a corner of the sRGB cube at each of them.
+// clang-format off
+static VBT__CONSTEXPR const double vbt__gamut_corner_hue[7] = {
+    29.233885, 109.769232, 142.495339, 194.768948, 264.052021, 328.363418,
+    389.233885,
+};
+
+// OKLab lightness and chroma of the most colorful sRGB color of a hue, in
+// VBT__GAMUT_CUSP_STEPS even steps from each corner hue to the next.
+static VBT__CONSTEXPR const double vbt__gamut_cusp[6 * VBT__GAMUT_CUSP_STEPS + 1][2] = {
+    {0.627955, 0.257683}, {0.654669, 0.233846}, {0.678096, 0.215904},
+    {0.699198, 0.202212}, {0.718649, 0.191736}, {0.736955, 0.183796},
+    {0.754516, 0.177941}, {0.771667, 0.173869}, {0.788715, 0.171388},
+    {0.805954, 0.170385}, {0.823695, 0.170821}, {0.842282, 0.172719},
+    {0.862130, 0.176174}, {0.883761, 0.181362}, {0.907876, 0.188566},
+    {0.935460, 0.198222}, {0.967983, 0.211006}, {0.962359, 0.212735},
+    {0.956722, 0.214788}, {0.951057, 0.217180}, {0.945349, 0.219932},
+    {0.939582, 0.223064}, {0.933739, 0.226602}, {0.927802, 0.230579},
+    {0.921752, 0.235030}, {0.915570, 0.239998}, {0.909234, 0.245532},
+    {0.902719, 0.251691}, {0.896000, 0.258545}, {0.889048, 0.266176},
+    {0.881829, 0.274684}, {0.874307, 0.284186}, {0.866440, 0.294827},
+    {0.869902, 0.267596}, {0.873096, 0.246191}, {0.876059, 0.228980},
+    {0.878826, 0.214911}, {0.881430, 0.203273}, {0.883899, 0.193566},
+    {0.886256, 0.185432}, {0.888523, 0.178603}, {0.890719, 0.172879},
+    {0.892861, 0.168108}, {0.894964, 0.164172}, {0.897043, 0.160983},
+    {0.899113, 0.158470}, {0.901186, 0.156583}, {0.903276, 0.155284},
+    {0.905399, 0.154550}, {0.886045, 0.150642}, {0.867753, 0.147844},
+    {0.850207, 0.146056}, {0.833134, 0.145219}, {0.816288, 0.145308},
+    {0.799433, 0.146332}, {0.782329, 0.148333}, {0.764713, 0.151393},
+    {0.746281, 0.155645}, {0.726655, 0.161290}, {0.705332, 0.168632},
+    {0.681592, 0.178143}, {0.654290, 0.190602}, {0.621341, 0.207467},
+    {0.577748, 0.232210}, {0.452014, 0.313214}, {0.460633, 0.307163},
+    {0.469695, 0.302321}, {0.479278, 0.298579}, {0.489467, 0.295842},
+    {0.500355, 0.294033}, {0.512046, 0.293086}, {0.524653, 0.292943},
+    {0.538299, 0.293554}, {0.553116, 0.294877}, {0.569242, 0.296876},
+    {0.586819, 0.299523}, {0.605993, 0.302802}, {0.626913, 0.306709},
+    {0.649726, 0.311261}, {0.674590, 0.316498}, {0.701674, 0.322491},
+    {0.691849, 0.311961}, {0.683199, 0.302415}, {0.675581, 0.293806},
+    {0.668865, 0.286099}, {0.662937, 0.279264}, {0.657694, 0.273279},
+    {0.653045, 0.268123}, {0.648913, 0.263779}, {0.645228, 0.260233},
+    {0.641932, 0.257476}, {0.638973, 0.255502}, {0.636309, 0.254313},
+    {0.633904, 0.253916}, {0.631726, 0.254327}, {0.629751, 0.255571},
+    {0.627955, 0.257683},
+};
+// clang-format on
+
+#endif  // VIBRANT_GAMUT_MAP_FAST
+
+// map linear-light sRGB that is out of [0-1] into sRGB, by lowering the
+// chroma at constant Oklch lightness and hue. oklab is the same color, or
+// NULL to convert it from lin. the caller clamps what is left.
+// https://www.w3.org/TR/css-color-4/#binsearch
+static VBT__CONSTEXPR void vbt__gamut_map(vbt_number_t* lin,
+                                          const vbt_number_t* oklab) {
+  vbt_number_t lab[3] = {0};
+  vbt_number_t clipped[3] = {0};
+  vbt_number_t chroma = 0;
+
+  if (vbt__in_gamut(lin)) {
+    return;
+  }
+
+  if (oklab) {
+    lab[0] = oklab[0];
+    lab[1] = oklab[1];
+    lab[2] = oklab[2];
+  } else {
+    vbt__linear_to_oklab(lin[0], lin[1], lin[2], lab);
+  }
+
+  if (lab[0] >= 1 || lab[0] <= 0) {
+    lin[0] = lin[1] = lin[2] = lab[0] >= 1 ? (vbt_number_t)1 : 0;
+    return;
+  }
+
+  // the clamped color is close enough
+  if (vbt__gamut_clip(lin, lab, clipped) < VBT__GAMUT_JND) {
+    return;
+  }
+
+  chroma = vbt__sqrt(lab[1] * lab[1] + lab[2] * lab[2]);
+  vbt__gamut_map_chroma(lin, lab, chroma);
+}
+
+// clamp lin into clipped, and return the OKLab distance (deltaEOK) from the
+// OKLab color lab to the clamped color
+static VBT__CONSTEXPR vbt_number_t vbt__gamut_clip(const vbt_number_t* lin,
+                                                   const vbt_number_t* lab,
+                                                   vbt_number_t* clipped) {
+  vbt_number_t clipped_lab[3] = {0};
+  vbt_number_t dl = 0, da = 0, db = 0;
+
+  clipped[0] = VBT__CLAMP_01(lin[0]);
+  clipped[1] = VBT__CLAMP_01(lin[1]);
+  clipped[2] = VBT__CLAMP_01(lin[2]);
+  vbt__linear_to_oklab(clipped[0], clipped[1], clipped[2], clipped_lab);
+
+  dl = clipped_lab[0] - lab[0];
+  da = clipped_lab[1] - lab[1];
+  db = clipped_lab[2] - lab[2];
+
+  return vbt__sqrt(dl * dl + da * da + db * db);
+}
+
+#ifdef VIBRANT_GAMUT_MAP_FAST
+
+// the gamut of a hue is about the triangle of black, white and the cusp.
+// lower the chroma to the edge of the triangle.
+static VBT__CONSTEXPR void vbt__gamut_map_chroma(vbt_number_t* lin,
+                                                 const vbt_number_t* lab,
+                                                 vbt_number_t chroma) {
+  vbt_number_t cusp[2] = {0};
+  vbt_number_t c_max = 0;
+
+  vbt__gamut_cusp_lookup(lab[1], lab[2], cusp);
+
+  c_max = lab[0] < cusp[0] ? cusp[1] * lab[0] / cusp[0]
+                           : cusp[1] * ((vbt_number_t)1 - lab[0]) /
+                                 ((vbt_number_t)1 - cusp[0]);
+
+  if (chroma > c_max) {
+    const vbt_number_t scale = c_max / chroma;
+    vbt__oklab_to_linear(lab[0], lab[1] * scale, lab[2] * scale, lin);
+  }
+}
+
+// interpolate the lightness and chroma of the cusp of the hue of a, b
+static VBT__CONSTEXPR void vbt__gamut_cusp_lookup(vbt_number_t a,
+                                                  vbt_number_t b,
+                                                  vbt_number_t* cusp) {
+  const double* corner = vbt__gamut_corner_hue;
+  double h = (double)vbt__atan2(b, a) * 180.0 / VBT__PI;
+  double pos = 0;
+  int k = 0;
+  int i = 0;
+
+  h = h < corner[0] ? h + 360.0 : h;
+
+  while (k < 5 && h >= corner[k + 1]) {
+    k++;
+  }
+
+  pos = (h - corner[k]) / (corner[k + 1] - corner[k]) * VBT__GAMUT_CUSP_STEPS;
+  i = pos < VBT__GAMUT_CUSP_STEPS ? (int)pos : VBT__GAMUT_CUSP_STEPS - 1;
+  pos -= i;
+  i += k * VBT__GAMUT_CUSP_STEPS;
+
+  cusp[0] = (vbt_number_t)(vbt__gamut_cusp[i][0] +
+                           pos * (vbt__gamut_cusp[i + 1][0] -
+                                  vbt__gamut_cusp[i][0]));
+  cusp[1] = (vbt_number_t)(vbt__gamut_cusp[i][1] +
+                           pos * (vbt__gamut_cusp[i + 1][1] -
+                                  vbt__gamut_cusp[i][1]));
+}
+
+#else
+
+// binary search for the highest chroma that clips to less than a JND
+static VBT__CONSTEXPR void vbt__gamut_map_chroma(vbt_number_t* lin,
+                                                 const vbt_number_t* lab,
+                                                 vbt_number_t chroma) {
+  vbt_number_t lo = 0;
+  vbt_number_t hi = chroma;
+  vbt_bool_t lo_in_gamut = VBT__TRUE;
+  vbt_number_t clipped[3] = {0};
+
+  clipped[0] = VBT__CLAMP_01(lin[0]);
+  clipped[1] = VBT__CLAMP_01(lin[1]);
+  clipped[2] = VBT__CLAMP_01(lin[2]);
+
+  while (hi - lo > VBT__GAMUT_EPSILON) {
+    const vbt_number_t mid = (lo + hi) / 2;
+    const vbt_number_t scale = mid / chroma;
+    vbt_number_t current[3] = {0};
+    vbt_number_t current_lab[3] = {0};
+
+    current_lab[0] = lab[0];
+    current_lab[1] = lab[1] * scale;
+    current_lab[2] = lab[2] * scale;
+    vbt__oklab_to_linear(current_lab[0], current_lab[1], current_lab[2],
+                         current);
+
+    if (lo_in_gamut && vbt__in_gamut(current)) {
+      lo = mid;
+      continue;
+    }
+
+    const vbt_number_t e = vbt__gamut_clip(current, current_lab, clipped);
+
+    if (e >= VBT__GAMUT_JND) {
+      hi = mid;
+    } else if (VBT__GAMUT_JND - e < VBT__GAMUT_EPSILON) {
+      break;
+    } else {
+      lo_in_gamut = VBT__FALSE;
+      lo = mid;
+    }
+  }
+
+  lin[0] = clipped[0];
+  lin[1] = clipped[1];
+  lin[2] = clipped[2];
+}
+
+#endif  // VIBRANT_GAMUT_MAP_FAST
+
+#endif  // VIBRANT_GAMUT_MAP
+
+#ifndef VIBRANT_FIXED_POINT
+
+// https://www.w3.org/TR/css-color-4/#hsl-to-rgb
+/*
+function hslToRgb(hue, sat, light) {
+
+    sat /= 100;
+    light /= 100;
+
+    function f(n) {
+        let k = (n + hue/30) % 12;
+        let a = sat * Math.min(light, 1 - light);
+        return light - a * Math.max(-1, Math.min(k - 3, 9 - k, 1));
+    }
+
+    return [f(0), f(8), f(4)];
+}
+*/
+
+static VBT__CONSTEXPR vbt_number_t vbt__hsl_to_rgb_fn(vbt_number_t h,
+                                                      vbt_number_t s,
+                                                      vbt_number_t l,
+                                                      vbt_number_t n) {
+  vbt_number_t k = vbt__fmod((n + h / (vbt_number_t)30.0), (vbt_number_t)12.0);
+  vbt_number_t a = s * VBT__MIN(l, (vbt_number_t)1.0 - l);
+  return l - a * VBT__MAX((vbt_number_t)-1.0,
+                          VBT__MIN(k - (vbt_number_t)3.0,
+                                   VBT__MIN((vbt_number_t)9.0 - k,
+                                            (vbt_number_t)1.0)));
+}
+
+static VBT__CONSTEXPR void vbt__hsl_to_rgb(vbt_number_t hue,
+                                           vbt_number_t saturation,
+                                           vbt_number_t lightness,
+                                           vbt_number_t* r,
+                                           vbt_number_t* g,
+                                           vbt_number_t* b) {
+  const vbt_number_t s = saturation / (vbt_number_t)100.0;
+  const vbt_number_t l = lightness / (vbt_number_t)100.0;
+
+  *r = vbt__hsl_to_rgb_fn(hue, s, l, 0);
+  *g = vbt__hsl_to_rgb_fn(hue, s, l, 8);
+  *b = vbt__hsl_to_rgb_fn(hue, s, l, 4);
+}
+
+#endif  // VIBRANT_FIXED_POINT
+
+// angle in [0, 360]. the same as fmod() up to 2^24 degrees, which covers
+// every hue the parser accepts: angle / 360 never rounds below a whole turn,
+// and the product and difference are exact. larger angles are only reduced
+// into range. a division and a floor instead of fmod(), so that loops over
+// colors vectorize.
+VBT__FORCEINLINE static VBT__CONSTEXPR vbt_number_t vbt__normalize_angle(
+    vbt_number_t angle) {
+  vbt_number_t a = angle - vbt__floor(angle / VBT__DEG_MAX) * VBT__DEG_MAX;
+
+  // angle / 360 may round up to the next turn
+  a += a < 0 ? VBT__DEG_MAX : 0;
+  return VBT__CLAMP(a, VBT__DEG_MIN, VBT__DEG_MAX);
+}
+
+static VBT__CONSTEXPR const double vbt__sin_deg[91] = {VBT__SIN_DEG_TABLE};
+
+// sin and cos of an angle in [0, 360], without a table or a branch, so that
+// loops over colors vectorize. the angle is reduced to r in [0, 90) in
+// degrees, which is exact, and the cos is the sin of 90 - r, as gcc would
+// merge a cos with the sin into a sincos, which has no vector version.
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__sincos_quadrant(
+    vbt_number_t a,
+    vbt_number_t* s,
+    vbt_number_t* c) {
+  const vbt_number_t quadrant = vbt__floor(a / (vbt_number_t)90.0);
+  const vbt_number_t r = a - quadrant * (vbt_number_t)90.0;
+  const vbt_number_t lo = vbt__sin(r * VBT__PI / (vbt_number_t)180.0);
+  const vbt_number_t hi =
+      vbt__sin(((vbt_number_t)90.0 - r) * VBT__PI / (vbt_number_t)180.0);
+  // odd quadrants swap sin and cos, then the signs follow the quadrant
+  const vbt_bool_t odd = quadrant == 1 || quadrant == 3;
+  const vbt_number_t ts = odd ? hi : lo;
+  const vbt_number_t tc = odd ? lo : hi;
+
+  *s = quadrant == 2 || quadrant == 3 ? -ts : ts;
+  *c = quadrant == 1 || quadrant == 2 ? -tc : tc;
+}
+
+// sin and cos of an integer angle in [0, 360], from a quarter wave table
+VBT__FORCEINLINE static VBT__CONSTEXPR void vbt__sincos_table(int deg,
+                                                             vbt_number_t* s,
+                                                             vbt_number_t* c) {
+  const double lo = vbt__sin_deg[deg % 90];
+  const double hi = vbt__sin_deg[90 - deg % 90];
+
+  switch (deg % 360 / 90) {
+    case 0: {
+      *s = (vbt_number_t)lo;
+      *c = (vbt_number_t)hi;
+      break;
+    }
+    case 1: {
+      *s = (vbt_number_t)hi;
+      *c = (vbt_number_t)-lo;
+      break;
+    }
+    case 2: {
+      *s = (vbt_number_t)-lo;
+      *c = (vbt_number_t)-hi;
+      break;
+    }
+    default: {
+      *s = (vbt_number_t)-hi;
+      *c = (vbt_number_t)lo;
+      break;
+    }
+  }
+}
+
+// sin and cos of an angle in degrees. integer angles, which most hues are,
+// are looked up in vbt__sincos_table(), other angles go through
+// vbt__sincos_quadrant(). loops over colors use vbt__sincos_chunk().
+static VBT__CONSTEXPR void vbt__sincos_deg(vbt_number_t angle,
+                                           vbt_number_t* s,
+                                           vbt_number_t* c) {
+  const vbt_number_t a = vbt__normalize_angle(angle);
+  // deg is 360 when a tiny negative angle rounds up, and 0 for nan
+  const int deg = a >= 0 && a <= VBT__DEG_MAX ? (int)a : 0;
+
+  if ((vbt_number_t)deg == a) {
+    vbt__sincos_table(deg, s, c);
+    return;
+  }
+
+  vbt__sincos_quadrant(a, s, c);
+}
+
+#ifdef VIBRANT_FIXED_POINT
+
+// Color conversion in fixed point, for targets without an FPU. The
+// arguments are converted to vbt__fx_t once, by vbt__fx_from_number(), and
+// the conversion after that is integer arithmetic. Products are 64 bit, so
+// the arguments saturate before a product could overflow, far outside of
+// the sRGB gamut. pow() in the sRGB transfer function is replaced by a
+// search for the u8 that a linear-light value encodes to.
+
+#define VBT__FX_BITS (24)
+#define VBT__FX_ONE ((vbt__fx_t)1 << VBT__FX_BITS)
+#define VBT__FX_INT(n) ((vbt__fx_t)(n) * VBT__FX_ONE)
+// constant to fixed point, folded by the compiler
+#define VBT__FX(x) ((vbt__fx_t)((x) * 16777216.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+#define VBT__FX_LAB_MAX ((vbt_number_t)4096)
+#define VBT__FX_OKLAB_MAX ((vbt_number_t)8)
+#define VBT__FX_PERCENT(val) \
+  (vbt__fx_from_number(val, VBT__PERCENT_MIN, VBT__PERCENT_MAX) / 100)
+
+// sin of 0 to 90 degrees, VBT__SIN_DEG_TABLE in fixed point
+// clang-format off
+static VBT__CONSTEXPR const int32_t vbt__fx_sin_deg[91] = {
+    0, 292803, 585516, 878052, 1170319, 1462231, 1753697,
+    2044628, 2334937, 2624535, 2913333, 3201244, 3488179, 3774052,
+    4058776, 4342263, 4624427, 4905183, 5184445, 5462127, 5738146,
+    6012416, 6284856, 6555381, 6823909, 7090358, 7354647, 7616697,
+    7876426, 8133756, 8388608, 8640905, 8890570, 9137527, 9381700,
+    9623016, 9861400, 10096781, 10329086, 10558244, 10784187, 11006844,
+    11226149, 11442034, 11654434, 11863283, 12068519, 12270079, 12467901,
+    12661926, 12852093, 13038346, 13220627, 13398880, 13573053, 13743091,
+    13908942, 14070557, 14227886, 14380881, 14529495, 14673684, 14813402,
+    14948609, 15079262, 15205322, 15326749, 15443509, 15555564, 15662880,
+    15765426, 15863169, 15956081, 16044131, 16127295, 16205546, 16278861,
+    16347217, 16410594, 16468971, 16522332, 16570661, 16613941, 16652161,
+    16685309, 16713374, 16736348, 16754223, 16766996, 16774661, 16777216,};
+// clang-format on
+
+// the lowest linear-light value that encodes to each u8 from 1 to 255,
+// rounded up. c encodes to n or more when c >= vbt__fx_srgb_u8[n - 1].
+// clang-format off
+static VBT__CONSTEXPR const int32_t vbt__fx_srgb_u8[255] = {
+    2547, 7639, 12731, 17824, 22916, 28008, 33101,
+    38193, 43285, 48378, 53491, 58876, 64565, 70561,
+    76871, 83498, 90447, 97722, 105327, 113267, 121546,
+    130167, 139135, 148453, 158125, 168156, 178548, 189305,
+    200431, 211930, 223804, 236058, 248694, 261717, 275129,
+    288933, 303133, 317732, 332734, 348140, 363955, 380181,
+    396822, 413880, 431358, 449259, 467586, 486342, 505530,
+    525152, 545212, 565711, 586653, 608041, 629877, 652163,
+    674903, 698099, 721753, 745868, 770447, 795492, 821005,
+    846990, 873448, 900382, 927794, 955687, 984063, 1012925,
+    1042275, 1072114, 1102447, 1133274, 1164598, 1196421, 1228746,
+    1261575, 1294910, 1328753, 1363106, 1397972, 1433353, 1469251,
+    1505668, 1542606, 1580067, 1618054, 1656568, 1695611, 1735186,
+    1775295, 1815940, 1857122, 1898844, 1941107, 1983914, 2027267,
+    2071168, 2115618, 2160620, 2206175, 2252286, 2298954, 2346181,
+    2393970, 2442321, 2491238, 2540721, 2590773, 2641395, 2692590,
+    2744359, 2796704, 2849626, 2903129, 2957212, 3011879, 3067131,
+    3122970, 3179398, 3236415, 3294025, 3352228, 3411027, 3470424,
+    3530419, 3591015, 3652213, 3714016, 3776424, 3839440, 3903065,
+    3967301, 4032149, 4097611, 4163690, 4230385, 4297700, 4365635,
+    4434193, 4503375, 4573182, 4643617, 4714680, 4786374, 4858699,
+    4931659, 5005253, 5079484, 5154353, 5229862, 5306012, 5382806,
+    5460243, 5538327, 5617058, 5696439, 5776469, 5857152, 5938489,
+    6020480, 6103129, 6186435, 6270401, 6355028, 6440317, 6526270,
+    6612889, 6700175, 6788129, 6876753, 6966049, 7056017, 7146659,
+    7237977, 7329972, 7422645, 7515999, 7610034, 7704751, 7800153,
+    7896240, 7993014, 8090476, 8188628, 8287471, 8387007, 8487237,
+    8588162, 8689783, 8792103, 8895122, 8998841, 9103263, 9208388,
+    9314218, 9420754, 9527998, 9635950, 9744612, 9853986, 9964073,
+    10074874, 10186390, 10298623, 10411574, 10525244, 10639635, 10754748,
+    10870584, 10987145, 11104431, 11222445, 11341187, 11460658, 11580861,
+    11701796, 11823464, 11945867, 12069007, 12192883, 12317498, 12442853,
+    12568949, 12695787, 12823368, 12951695, 13080767, 13210587, 13341155,
+    13472472, 13604541, 13737362, 13870936, 14005265, 14140350, 14276191,
+    14412791, 14550150, 14688270, 14827152, 14966796, 15107205, 15248379,
+    15390320, 15533029, 15676506, 15820754, 15965773, 16111564, 16258129,
+    16405469, 16553585, 16702478,};
+// clang-format on
+
+// same as vbt__color_kernel(), for all colors but rgb
+static VBT__CONSTEXPR int vbt__fx_color_eval(vbt_color_fn_t fn,
+                                             const vbt_number_t* arg,
+                                             vbt_u8_t* rgba8) {
+  switch (fn) {
+    case VBT_COLOR_HSL: {
+      vbt__fx_t rgb[3] = {0};
+      vbt__fx_hsl_to_rgb(vbt__fx_normalize_angle(arg[0]),
+                         VBT__FX_PERCENT(arg[1]), VBT__FX_PERCENT(arg[2]),
+                         rgb);
+      rgba8[0] = vbt__fx_to_u8(rgb[0]);
+      rgba8[1] = vbt__fx_to_u8(rgb[1]);
+      rgba8[2] = vbt__fx_to_u8(rgb[2]);
+      break;
+    }
+    case VBT_COLOR_HWB: {
+      vbt__fx_hwb_to_rgb(vbt__fx_normalize_angle(arg[0]),
+                         VBT__FX_PERCENT(arg[1]), VBT__FX_PERCENT(arg[2]),
+                         rgba8);
+      break;
+    }
+    case VBT_COLOR_LCH: {
+      const vbt__fx_t chroma =
+          vbt__fx_from_number(arg[1], -VBT__FX_LAB_MAX, VBT__FX_LAB_MAX);
+      vbt__fx_t s = 0, c = 0;
+      vbt__fx_sincos_deg(vbt__fx_normalize_angle(arg[2]), &s, &c);
+      vbt__fx_lab_to_rgb(
+          vbt__fx_from_number(arg[0], VBT__PERCENT_MIN, VBT__PERCENT_MAX),
+          vbt__fx_mul(chroma, c), vbt__fx_mul(chroma, s), rgba8);
+      break;
+    }
+    case VBT_COLOR_LAB: {
+      vbt__fx_lab_to_rgb(
+          vbt__fx_from_number(arg[0], VBT__PERCENT_MIN, VBT__PERCENT_MAX),
+          vbt__fx_from_number(arg[1], -VBT__FX_LAB_MAX, VBT__FX_LAB_MAX),
+          vbt__fx_from_number(arg[2], -VBT__FX_LAB_MAX, VBT__FX_LAB_MAX),
+          rgba8);
+      break;
+    }
+    case VBT_COLOR_OKLCH: {
+      const vbt__fx_t chroma =
+          vbt__fx_from_number(arg[1], -VBT__FX_OKLAB_MAX, VBT__FX_OKLAB_MAX);
+      vbt__fx_t s = 0, c = 0;
+      vbt__fx_sincos_deg(vbt__fx_normalize_angle(arg[2]), &s, &c);
+      vbt__fx_oklab_to_rgb(
+          vbt__fx_from_number(arg[0], VBT__PERCENT_MIN, VBT__PERCENT_MAX),
+          vbt__fx_mul(chroma, c), vbt__fx_mul(chroma, s), rgba8);
+      break;
+    }
+    case VBT_COLOR_OKLAB: {
+      vbt__fx_oklab_to_rgb(
+          vbt__fx_from_number(arg[0], VBT__PERCENT_MIN, VBT__PERCENT_MAX),
+          vbt__fx_from_number(arg[1], -VBT__FX_OKLAB_MAX, VBT__FX_OKLAB_MAX),
+          vbt__fx_from_number(arg[2], -VBT__FX_OKLAB_MAX, VBT__FX_OKLAB_MAX),
+          rgba8);
+      break;
+    }
+    default: {
+      return VBT_ERR;
+    }
+  }
+
+  rgba8[3] = vbt__fx_to_u8(vbt__fx_from_number(arg[3], 0, 1));
+
+  return VBT_SUCCESS;
+}
+
+// clamped number to fixed point, the only floating point code of the
+// conversion
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_from_number(vbt_number_t value,
+                                                    vbt_number_t min,
+                                                    vbt_number_t max) {
+  const vbt_number_t x =
+      VBT__CLAMP(value, min, max) * (vbt_number_t)VBT__FX_ONE;
+
+  return (vbt__fx_t)(x < 0 ? x - (vbt_number_t)0.5 : x + (vbt_number_t)0.5);
+}
+
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_mul(vbt__fx_t a, vbt__fx_t b) {
+  return a * b / VBT__FX_ONE;
+}
+
+// angle in degrees to [0, 360)
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_normalize_angle(vbt_number_t angle) {
+  const vbt__fx_t a =
+      vbt__fx_from_number(angle, -VBT__NUMBER_MAX, VBT__NUMBER_MAX) %
+      VBT__FX_INT(360);
+
+  return (a < 0 ? a + VBT__FX_INT(360) : a);
+}
+
+// sin and cos of an angle in [0, 360) degrees. the integer degrees are
+// looked up, and the fraction d, below pi / 180 radians, is added with
+// sin(d) = d - d^3 / 6 and cos(d) = 1 - d^2 / 2, which are exact to 2^-24.
+static VBT__CONSTEXPR void vbt__fx_sincos_deg(vbt__fx_t angle,
+                                              vbt__fx_t* s,
+                                              vbt__fx_t* c) {
+  const int deg = (int)(angle / VBT__FX_ONE);
+  const vbt__fx_t d = vbt__fx_mul(angle - VBT__FX_INT(deg),
+                                  VBT__FX(3.14159265358979323846 / 180.0));
+  const vbt__fx_t d2 = vbt__fx_mul(d, d);
+  const vbt__fx_t sin_d = d - vbt__fx_mul(d2, d) / 6;
+  const vbt__fx_t cos_d = VBT__FX_ONE - d2 / 2;
+  const vbt__fx_t lo = vbt__fx_sin_deg[deg % 90];
+  const vbt__fx_t hi = vbt__fx_sin_deg[90 - deg % 90];
+  vbt__fx_t sin_deg = 0, cos_deg = 0;
+
+  switch (deg / 90) {
+    case 0: {
+      sin_deg = lo;
+      cos_deg = hi;
+      break;
+    }
+    case 1: {
+      sin_deg = hi;
+      cos_deg = -lo;
+      break;
+    }
+    case 2: {
+      sin_deg = -lo;
+      cos_deg = -hi;
+      break;
+    }
+    default: {
+      sin_deg = -hi;
+      cos_deg = lo;
+      break;
+    }
+  }
+
+  *s = vbt__fx_mul(sin_deg, cos_d) + vbt__fx_mul(cos_deg, sin_d);
+  *c = vbt__fx_mul(cos_deg, cos_d) - vbt__fx_mul(sin_deg, sin_d);
+}
+
+// [0-1] to [0-255], same as VBT__01_TO_255() of the clamped value
+static VBT__CONSTEXPR vbt_u8_t vbt__fx_to_u8(vbt__fx_t value) {
+  const vbt__fx_t v = VBT__CLAMP(value, 0, VBT__FX_ONE);
+
+  return (vbt_u8_t)((v * 255 + VBT__FX_ONE / 2) / VBT__FX_ONE);
+}
+
+// linear-light sRGB component to gamma encoded u8, same as
+// VBT__01_TO_255(VBT__CLAMP_01(vbt__linear_to_srgb(c)))
+static VBT__CONSTEXPR vbt_u8_t vbt__fx_linear_to_u8(vbt__fx_t c) {
+  unsigned n = 0;
+
+  for (unsigned step = 128; step > 0; step >>= 1) {
+    if (c >= vbt__fx_srgb_u8[n + step - 1]) {
+      n += step;
+    }
+  }
+
+  return (vbt_u8_t)n;
+}
+
+static VBT__CONSTEXPR vbt__fx_t vbt__fx_hsl_to_rgb_fn(vbt__fx_t h,
+                                                      vbt__fx_t s,
+                                                      vbt__fx_t l,
+                                                      int n) {
+  const vbt__fx_t a = vbt__fx_mul(s, VBT__MIN(l, VBT__FX_ONE - l));
+  vbt__fx_t k = VBT__FX_INT(n) + h / 30;
+
+  if (k >= VBT__FX_INT(12)) {
+    k -= VBT__FX_INT(12);
+  }
+
+  return l - vbt__fx_mul(a, VBT__MAX(-VBT__FX_ONE,
+                                     VBT__MIN(k - VBT__FX_INT(3),
+                                              VBT__MIN(VBT__FX_INT(9) - k,
+                                                       VBT__FX_ONE))));
+}
+
+static VBT__CONSTEXPR void vbt__fx_hsl_to_rgb(vbt__fx_t h,
+                                              vbt__fx_t s,
+                                              vbt__fx_t l,
+                                              vbt__fx_t* rgb) {
+  rgb[0] = vbt__fx_hsl_to_rgb_fn(h, s, l, 0);
+  rgb[1] = vbt__fx_hsl_to_rgb_fn(h, s, l, 8);
+  rgb[2] = vbt__fx_hsl_to_rgb_fn(h, s, l, 4);
+}
+
+static VBT__CONSTEXPR void vbt__fx_hwb_to_rgb(vbt__fx_t h,
+                                              vbt__fx_t w,
+                                              vbt__fx_t b,
+                                              vbt_u8_t* rgb) {
+  const vbt__fx_t wb = w + b;
+  vbt__fx_t hsl[3] = {0};
+
+  if (wb >= VBT__FX_ONE) {
+    const vbt_u8_t gray = vbt__fx_to_u8(w * VBT__FX_ONE / wb);
+    rgb[0] = gray;
+    rgb[1] = gray;
+    rgb[2] = gray;
+    return;
+  }
+
+  vbt__fx_hsl_to_rgb(h, VBT__FX_ONE, VBT__FX_ONE / 2, hsl);
+
+  for (size_t i = 0; i < 3; i++) {
+    rgb[i] = vbt__fx_to_u8(vbt__fx_mul(hsl[i], VBT__FX_ONE - wb) + w);
+  }
+}
+
+// 1 / VBT__CIE_K is 27 / 24389 and VBT__CIE_K * VBT__CIE_E is 8
+static VBT__CONSTEXPR void vbt__fx_lab_to_rgb(vbt__fx_t lightness,
+                                              vbt__fx_t a,
+                                              vbt__fx_t b,
+                                              vbt_u8_t* rgb) {
+  const vbt__fx_t fy = (lightness + VBT__FX_INT(16)) / 116;
+  const vbt__fx_t fx = a / 500 + fy;
+  const vbt__fx_t fz = fy - b / 200;
+
+  const vbt__fx_t fx3 = vbt__fx_mul(vbt__fx_mul(fx, fx), fx);
+  const vbt__fx_t fz3 = vbt__fx_mul(vbt__fx_mul(fz, fz), fz);
+
+  const vbt__fx_t xr = (fx3 > VBT__FX(216.0 / 24389.0))
+                           ? fx3
+                           : (116 * fx - VBT__FX_INT(16)) * 27 / 24389;
+  const vbt__fx_t yr = (lightness > VBT__FX_INT(8))
+                           ? vbt__fx_mul(vbt__fx_mul(fy, fy), fy)
+                           : lightness * 27 / 24389;
+  const vbt__fx_t zr = (fz3 > VBT__FX(216.0 / 24389.0))
+                           ? fz3
+                           : (116 * fz - VBT__FX_INT(16)) * 27 / 24389;
+
+  const vbt__fx_t x = vbt__fx_mul(xr, VBT__FX(0.95047));
+  const vbt__fx_t y = yr;
+  const vbt__fx_t z = vbt__fx_mul(zr, VBT__FX(1.08883));
+
+  rgb[0] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(3.2404542), x) -
+                                vbt__fx_mul(VBT__FX(1.5371385), y) -
+                                vbt__fx_mul(VBT__FX(0.4985314), z));
+  rgb[1] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(-0.9692660), x) +
+                                vbt__fx_mul(VBT__FX(1.8760108), y) +
+                                vbt__fx_mul(VBT__FX(0.0415560), z));
+  rgb[2] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(0.0556434), x) -
+                                vbt__fx_mul(VBT__FX(0.2040259), y) +
+                                vbt__fx_mul(VBT__FX(1.0572252), z));
+}
+
+// l_, m_ and s_ saturate at +-16, which is white for any lightness above
+// 16, so that their cubes fit a product
+static VBT__CONSTEXPR void vbt__fx_oklab_to_rgb(vbt__fx_t lightness,
+                                                vbt__fx_t a,
+                                                vbt__fx_t b,
+                                                vbt_u8_t* rgb) {
+  const vbt__fx_t lo = -VBT__FX_INT(16);
+  const vbt__fx_t hi = VBT__FX_INT(16);
+  const vbt__fx_t l_ =
+      VBT__CLAMP(lightness + vbt__fx_mul(VBT__FX(0.3963377774), a) +
+                     vbt__fx_mul(VBT__FX(0.2158037573), b),
+                 lo, hi);
+  const vbt__fx_t m_ =
+      VBT__CLAMP(lightness - vbt__fx_mul(VBT__FX(0.1055613423), a) -
+                     vbt__fx_mul(VBT__FX(0.0638541728), b),
+                 lo, hi);
+  const vbt__fx_t s_ =
+      VBT__CLAMP(lightness - vbt__fx_mul(VBT__FX(0.0894841775), a) -
+                     vbt__fx_mul(VBT__FX(1.2914855480), b),
+                 lo, hi);
+
+  const vbt__fx_t l = vbt__fx_mul(vbt__fx_mul(l_, l_), l_);
+  const vbt__fx_t m = vbt__fx_mul(vbt__fx_mul(m_, m_), m_);
+  const vbt__fx_t s = vbt__fx_mul(vbt__fx_mul(s_, s_), s_);
+
+  rgb[0] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(4.0767416621), l) -
+                                vbt__fx_mul(VBT__FX(3.3077115913), m) +
+                                vbt__fx_mul(VBT__FX(0.2309699292), s));
+  rgb[1] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(-1.2684380046), l) +
+                                vbt__fx_mul(VBT__FX(2.6097574011), m) -
+                                vbt__fx_mul(VBT__FX(0.3413193965), s));
+  rgb[2] = vbt__fx_linear_to_u8(vbt__fx_mul(VBT__FX(-0.0041960863), l) -
+                                vbt__fx_mul(VBT__FX(0.7034186147), m) +
+                                vbt__fx_mul(VBT__FX(1.7076147009), s));
+}
+
+#endif  // VIBRANT_FIXED_POINT
+
+// [0-255] number to u8, rounded and clamped
+static VBT__CONSTEXPR vbt_u8_t vbt__number_to_u8(vbt_number_t value) {
+  const vbt_number_t lo = 0;
+  const vbt_number_t hi = 255;
+
+  return (vbt_u8_t)VBT__CLAMP(value + (vbt_number_t)(0.5), lo, hi);
+}
+
+#ifndef VIBRANT_NO_PARSE
+
+typedef struct vbt__css_value_t {
+  vbt_number_t value;
+  vbt_unit_t unit;
+} vbt__css_value_t;
+
+typedef struct vbt__parser_t {
+  const char* sp;
+  const char* end;
+} vbt__parser_t;
+
+typedef struct vbt__css_keyword_t {
+  const char* name;
+  vbt_size_t len;
+} vbt__css_keyword_t;
+
+// large enough for 10^(VBT__NUMBER_LONG_DIGITS + 1 - VBT__NUMBER_MIN_EXP10)
+// * 2
+typedef struct vbt__bigint_t {
+  uint32_t limb[18];
+} vbt__bigint_t;
+
+// clang-format off
+// see VBT__FIRST_BYTE_CLASS_TABLE
+static VBT__CONSTEXPR const vbt_u8_t vbt__first_byte_class[256] = {
+    VBT__FIRST_BYTE_CLASS_TABLE
+};
+
+// classifies the bytes of a css function body as vbt__fn_class_t
+static VBT__CONSTEXPR const vbt_u8_t vbt__fn_byte_class[256] = {
+    VBT__FN_BYTE_CLASS_TABLE
+};
+
+// vbt__fn_dfa[state][byte class] -> next state
+static VBT__CONSTEXPR const vbt_u8_t vbt__fn_dfa[VBT__FS_COUNT][VBT__FC_COUNT] = {
+    VBT__FN_DFA_TABLE
+};
+
+// indexed by vbt__fn_state_t
+static VBT__CONSTEXPR const vbt_u8_t vbt__fn_state_action[VBT__FS_COUNT] = {
+    VBT__FN_STATE_ACTION_TABLE
+};
+
+// color-mix() is not a vbt_color_fn_t, the mix is done while parsing
+#define VBT__COLOR_MIX "color-mix("
+
+// parentheses, calc() and signs a calc() argument can nest
+#define VBT__CALC_MAX_NESTING (8)
+// values on the stack of a calc() expression: a pending sum and product
+// per nesting level, and the value being parsed
+#define VBT__CALC_MAX_STACK (2 * VBT__CALC_MAX_NESTING + 1)
+
+// opcodes of vbt_relative_t. VBT__ROP_CONST, VBT__ROP_CHANNEL and
+// VBT__ROP_STORE are followed by a byte, the index of a constant or channel.
+typedef enum vbt__rop_t {
+  VBT__ROP_CONST = 0,
+  VBT__ROP_CHANNEL,
+  VBT__ROP_ADD,
+  VBT__ROP_SUB,
+  VBT__ROP_MUL,
+  VBT__ROP_DIV,
+  VBT__ROP_NEG,
+  VBT__ROP_STORE,
+} vbt__rop_t;
+
+// indexed by vbt__rop_t, the operands op pops and how it changes the depth
+// of the stack
+static VBT__CONSTEXPR const signed char vbt__rop_stack[][2] = {
+    {0, 1}, {0, 1}, {2, -1}, {2, -1}, {2, -1}, {2, -1}, {1, 0}, {1, -1},
+};
+
+// a calc() expression being parsed by vbt__calc_sum(), which checks its
+// units and hands its operands and operators to vbt__calc_emit() in postfix
+// order: VBT__ROP_CONST with a number, VBT__ROP_CHANNEL with the index of a
+// channel keyword of fn, and the arithmetic. they are folded into a value,
+// or compiled into rel, a relative color.
+typedef struct vbt__calc_t {
+  const char* sp;
+  const char* end;
+  vbt_color_fn_t fn;  // whose channel keywords are values, or VBT_COLOR_NONE
+  int nesting;
+  int depth;  // values on the stack
+  vbt_unit_t unit[VBT__CALC_MAX_STACK];
+  vbt_number_t value[VBT__CALC_MAX_STACK];  // when folded
+  vbt_relative_t* rel;                      // when compiled, or NULL
+  int const_count;                          // constants of rel
+} vbt__calc_t;
+
+// colors a relative color program runs over at a time, on the stack
+#define VBT__RELATIVE_CHUNK (64)
+
+// exact powers of ten for vbt__parse_number
+#define VBT__FAST_MANTISSA_MAX (9007199254740992ull)  // 2^53
+// (VBT__NUMBER_MAX_INT + 1) * 10^k fits in 64 bits up to this k
+#define VBT__NUMBER_MAX_INT_POW10 (12)
+
+static VBT__CONSTEXPR const double vbt__pow10_f64[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static VBT__CONSTEXPR const float vbt__pow10_f32[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+static VBT__CONSTEXPR const uint64_t vbt__pow10_u64[] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+// indexed by vbt_color_fn_t
+static VBT__CONSTEXPR const vbt__css_function_t vbt__css_functions[] = {
+    VBT__CSS_FUNCTION_TABLE
+};
+
+// the function color-mix() makes, indexed by vbt_space_t
+static VBT__CONSTEXPR const vbt_color_fn_t vbt__space_functions[] = {
+    VBT_COLOR_RGB, VBT_COLOR_RGB,   VBT_COLOR_LAB,
+    VBT_COLOR_LCH, VBT_COLOR_OKLAB, VBT_COLOR_OKLCH,
+};
+// clang-format on
+
+// clang-format off
+static VBT__CONSTEXPR int vbt__parse(const char* value, vbt_size_t len, vbt_color_t* color);
+static VBT__CONSTEXPR vbt_bool_t vbt__hex_char_to_int(int c, int* out);
+static VBT__CONSTEXPR int vbt__parse_hex(const char* value, vbt_size_t len, vbt_color_t* color);
+static VBT__CONSTEXPR vbt_color_fn_t vbt__match_css_function(const char* value, vbt_size_t len);
+static VBT__CONSTEXPR int vbt__parse_css_function(const char* value, vbt_size_t len, vbt_color_fn_t fn, vbt_color_t* color);
+static VBT__CONSTEXPR int vbt__consume_css_value(vbt__parser_t* parser, vbt__css_value_t* css_value);
+static VBT__CONSTEXPR int vbt__calc_sum(vbt__calc_t* calc);
+static VBT__CONSTEXPR int vbt__calc_product(vbt__calc_t* calc);
+static VBT__CONSTEXPR int vbt__calc_value(vbt__calc_t* calc);
+static VBT__CONSTEXPR int vbt__calc_emit(vbt__calc_t* calc, vbt__rop_t op, vbt_number_t arg, vbt_unit_t unit);
+static VBT__CONSTEXPR int vbt__calc_fold(vbt__calc_t* calc, vbt__rop_t op, vbt_number_t arg);
+static VBT__CONSTEXPR vbt_bool_t vbt__calc_is_number(const char* sp, const char* end);
+static VBT__CONSTEXPR int vbt__parse_css_color_name(const char* value, vbt_size_t len, vbt_color_t* color);
+static VBT__CONSTEXPR int vbt__parse_color_mix(const char* value, vbt_size_t len, vbt_color_t* color);
+static VBT__CONSTEXPR int vbt__parse_mix_space(const char* sp, const char* end, vbt_space_t* space, vbt_hue_method_t* hue);
+static VBT__CONSTEXPR int vbt__parse_mix_operand(const char* sp, const char* end, vbt_color_t* color, vbt_number_t* percent, vbt_bool_t* has_percent);
+static VBT__CONSTEXPR int vbt__find_keyword(const char* sp, vbt_size_t len, const vbt__css_keyword_t* keywords, int count);
+static VBT__CONSTEXPR const char* vbt__trim_start(const char* sp, const char* end);
+static VBT__CONSTEXPR const char* vbt__trim_end(const char* sp, const char* end);
+static VBT__CONSTEXPR int vbt__color_mix(vbt_space_t space, vbt_hue_method_t hue, vbt_color_t* operand, vbt_number_t t, vbt_number_t alpha, vbt_color_t* color);
+static VBT__CONSTEXPR void vbt__color_mix_operand(vbt_space_t space, const vbt_color_t* color, vbt_number_t* out);
+static VBT__CONSTEXPR int vbt__relative_compile(const char* value, vbt_size_t len, vbt_relative_t* rel);
+static VBT__CONSTEXPR int vbt__relative_channel(vbt__calc_t* calc, int channel);
+static VBT__CONSTEXPR vbt_number_t vbt__relative_convert(vbt_color_fn_t fn, int channel, vbt_number_t value, vbt_unit_t unit);
+static VBT__CONSTEXPR int vbt__relative_keyword(vbt_color_fn_t fn, const char* sp, const char* end, const char** keyword_end);
+static VBT__CONSTEXPR int vbt__relative_emit(vbt__calc_t* calc, vbt__rop_t op, int arg);
+static VBT__CONSTEXPR int vbt__relative_calc_emit(vbt__calc_t* calc, vbt__rop_t op, vbt_number_t arg);
+static VBT__CONSTEXPR int vbt__relative_const(vbt__calc_t* calc, vbt_number_t value);
+static VBT__CONSTEXPR void vbt__relative_load(vbt_color_fn_t fn, vbt_color_t* origins, vbt_size_t count, vbt_number_t in[4][VBT__RELATIVE_CHUNK], int* err);
+static VBT__CONSTEXPR int vbt__relative_verify(const vbt_relative_t* rel);
+static VBT__CONSTEXPR int vbt__relative_apply_chunk(const vbt_relative_t* rel, vbt_color_t* origins, vbt_size_t count, vbt_color_t* colors, int* err);
+static VBT__CONSTEXPR void vbt__relative_run(const vbt_relative_t* rel, vbt_number_t in[4][VBT__RELATIVE_CHUNK], vbt_number_t out[4][VBT__RELATIVE_CHUNK], vbt_size_t count);
+static VBT__CONSTEXPR void vbt__color_init_rgba8(vbt_color_t* color, int r, int g, int b, int a);
+static VBT__CONSTEXPR void vbt__color_init_args(vbt_color_t* color, vbt_color_fn_t fn, const vbt_number_t* arg);
+static VBT__CONSTEXPR void vbt__css_args(vbt_color_fn_t fn, const vbt__css_value_t* arg, vbt_number_t* out);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_01(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_lch_chroma(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_lab_ab(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_ok_lightness(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_oklab_ab(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_percent(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_rgb(const vbt__css_value_t* css_value);
+static VBT__CONSTEXPR int vbt__casecmp(const char* s1, const char* s2, vbt_size_t n);
+static VBT__CONSTEXPR int vbt__parse_number(vbt__parser_t* p, vbt_number_t* out);
+static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number(uint64_t mantissa, int k);
+VBT__NOINLINE static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number_long(const char* sp, const char* end, int exponent);
+VBT__NOINLINE static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number_slow(const vbt__bigint_t* mantissa, int k);
+static VBT__CONSTEXPR void vbt__bigint_set_u64(vbt__bigint_t* b, uint64_t value);
+static VBT__CONSTEXPR void vbt__bigint_mul_add(vbt__bigint_t* b, uint32_t value, uint32_t add);
+static VBT__CONSTEXPR void vbt__bigint_shl1(vbt__bigint_t* b);
+static VBT__CONSTEXPR void vbt__bigint_sub(vbt__bigint_t* a, const vbt__bigint_t* b);
+static VBT__CONSTEXPR int vbt__bigint_cmp(const vbt__bigint_t* a, const vbt__bigint_t* b);
+static VBT__CONSTEXPR int vbt__tolower(int c);
+static VBT__CONSTEXPR vbt_size_t vbt__strlen_safe(const char* str, vbt_size_t limit);
+static VBT__CONSTEXPR vbt_size_t vbt__hash(const char* str, size_t len);
+static VBT__CONSTEXPR const vbt__css_color_t* vbt__find_css_color(const char* value,  vbt_size_t len);
+// clang-format on
+
+// when color is NULL, value is only validated. the parse_* functions below
+// follow the same convention and skip number conversion.
+static VBT__CONSTEXPR int vbt__parse(const char* value,
+                                     vbt_size_t len,
+                                     vbt_color_t* color) {
+  if (len == 0 || len > VBT__MAX_STR_LEN || !value) {
+    return VBT_ERR;
+  }
+
+  // the first byte picks the only path that can accept value, so inputs
+  // like "10px" or "--x" are rejected without any further work.
+  switch (vbt__first_byte_class[(unsigned char)*value]) {
+    case VBT__BYTE_HEX: {
+      return vbt__parse_hex(value, len, color);
+    }
+    case VBT__BYTE_FUNCTION: {
+      vbt_color_fn_t fn = vbt__match_css_function(value, len);
+
+      if (fn != VBT_COLOR_NONE) {
+        return vbt__parse_css_function(value, len, fn, color);
+      }
+
+      if (len > VBT__ARR_LEN(VBT__COLOR_MIX) - 1 &&
+          vbt__casecmp(value, VBT__COLOR_MIX,
+                       VBT__ARR_LEN(VBT__COLOR_MIX) - 1) == 0) {
+        return vbt__parse_color_mix(value, len, color);
+      }
+
+      // no color name starts with a function name
+      return vbt__parse_css_color_name(value, len, color);
+    }
+    case VBT__BYTE_NAME: {
+      return vbt__parse_css_color_name(value, len, color);
+    }
+    default: {
+      return VBT_ERR;
+    }
+  }
+}
+
+// hex and named colors are sRGB u8 values, so they are born resolved.
+static VBT__CONSTEXPR void vbt__color_init_rgba8(vbt_color_t* color,
+                                                 int r,
+                                                 int g,
+                                                 int b,
+                                                 int a) {
+  color->fn = VBT_COLOR_RGB;
+  color->arg[0] = (vbt_number_t)r;
+  color->arg[1] = (vbt_number_t)g;
+  color->arg[2] = (vbt_number_t)b;
+  color->arg[3] = (vbt_number_t)a / (vbt_number_t)255;
+
+  for (size_t i = 0; i < VBT__ARR_LEN(color->unit); i++) {
+    color->unit[i] = VBT_UNIT_NUMBER;
+  }
+
+  color->resolved = VBT__RESOLVED_U8;
+  color->srgb.u8[0] = (vbt_u8_t)r;
+  color->srgb.u8[1] = (vbt_u8_t)g;
+  color->srgb.u8[2] = (vbt_u8_t)b;
+  color->srgb.u8[3] = (vbt_u8_t)a;
+}
+
+// colors the parser computes hold plain numbers, and are resolved when needed
+static VBT__CONSTEXPR void vbt__color_init_args(vbt_color_t* color,
+                                                vbt_color_fn_t fn,
+                                                const vbt_number_t* arg) {
+  color->fn = fn;
+
+  for (size_t i = 0; i < VBT__ARR_LEN(color->arg); i++) {
+    color->arg[i] = arg[i];
+    color->unit[i] = VBT_UNIT_NUMBER;
+  }
+
+  color->resolved = VBT__RESOLVED_NONE;
+}
+
+static VBT__CONSTEXPR vbt_bool_t vbt__hex_char_to_int(int c, int* out) {
+  if (c >= '0' && c <= '9') {
+    *out = c - '0';
+  } else if (c >= 'a' && c <= 'f') {
+    *out = c - 'a' + 10;
+  } else if (c >= 'A' && c <= 'F') {
+    *out = c - 'A' + 10;
+  } else {
+    return VBT__FALSE;
+  }
+
+  return VBT__TRUE;
+}
+
+static VBT__CONSTEXPR int vbt__parse_hex(const char* value,
+                                         vbt_size_t len,
+                                         vbt_color_t* color) {
+  int components[4] = {0};
+  int component_index = 0;
+
+  if (len == 4 || len == 5) {  // #rgb or #rgba
+    for (size_t i = 1; i < len; i++) {
+      int c = 0;
+
+      if (!vbt__hex_char_to_int((unsigned char)value[i], &c)) {
+        return VBT_ERR;
+      }
+
+      components[component_index++] = (c << 4) | c;
+    }
+  } else if (len == 7 || len == 9) {  // #rrggbb or #rrggbbaa
+    for (size_t i = 1; i < len; i += 2) {
+      int a = 0;
+      int b = 0;
+
+      if (!vbt__hex_char_to_int((unsigned char)value[i], &a)) {
+        return VBT_ERR;
+      }
+
+      if (!vbt__hex_char_to_int((unsigned char)value[i + 1], &b)) {
+        return VBT_ERR;
+      }
+
+      components[component_index++] = (a << 4) | b;
+    }
+  } else {
+    return VBT_ERR;
+  }
+
+  if (color) {
+    vbt__color_init_rgba8(color, components[0], components[1], components[2],
+                          component_index == 4 ? components[3] : 255);
+  }
+
+  return VBT_SUCCESS;
+}
+
+static VBT__CONSTEXPR vbt_size_t vbt__strlen_safe(const char* str,
+                                                  vbt_size_t limit) {
+  vbt_size_t len = 0;
+
+  if (!str) {
+    return len;
+  }
+
+  while (len < limit && *str) {
+    str++;
+    len++;
+  }
+
+  if (len == limit && *str) {
+    return 0;  // Overflow
+  }
+
+  return len;
+}
+
+static VBT__CONSTEXPR int vbt__tolower(int c) {
+  return (c >= 'A' && c <= 'Z') ? (c | 0x20) : c;
+}
+
+static VBT__CONSTEXPR int vbt__casecmp(const char* s1,
+                                       const char* s2,
+                                       vbt_size_t n) {
+  int result = 0;
+
+  for (vbt_size_t i = 0; i < n; ++i) {
+    result = vbt__tolower((unsigned char)s1[i]) -
+             vbt__tolower((unsigned char)s2[i]);
+
+    if (result != 0) {
+      break;
+    }
+  }
+
+  return result;
+}
+
+// string -> float
+// accepts any number of digits and an optional exponent, correctly rounded to
+// vbt_number_t. the first VBT__NUMBER_MAX_DIGITS significant digits are read
+// into a 64 bit mantissa, longer numbers are read again by
+// vbt__decimal_to_number_long(). the integer part must not exceed
+// VBT__NUMBER_MAX_INT,
+// and numbers smaller than 10^VBT__NUMBER_MIN_EXP10 flush to 0. if out is
+// NULL, the number is only validated: all range checks are done with integer
+// math and no floating point work is done.
+static VBT__CONSTEXPR int vbt__parse_number(vbt__parser_t* p,
+                                            vbt_number_t* out) {
+  const char* sp = p->sp;
+  const char* end = p->end;
+  uint64_t mantissa = 0;
+  int exp10 = 0;
+  int exponent = 0;
+  // significant digits in the mantissa, and whether nonzero digits after
+  // them were left out
+  int digits = 0;
+  vbt_bool_t truncated = VBT__FALSE;
+  vbt_bool_t negative = VBT__FALSE;
+
+  if (sp < end) {
+    if (*sp == '-') {
+      negative = VBT__TRUE;
+      sp++;
+    } else if (*sp == '+') {
+      sp++;
+    }
+  }
+
+  // number = mantissa * 10^exp10
+  const char* digits_start = sp;
+
+  while (sp < end && *sp >= '0' && *sp <= '9') {
+    if (digits < VBT__NUMBER_MAX_DIGITS) {
+      mantissa = mantissa * 10 + (uint64_t)(*sp - '0');
+      digits += mantissa != 0;
+    } else {
+      exp10++;
+      truncated |= *sp != '0';
+    }
+
+    sp++;
+  }
+
+  // the end of the significant digits
+  const char* digits_end = sp;
+
+  if (sp < end && *sp == '.') {
+    // zeros are only added to the mantissa when a nonzero digit follows them
+    int zeros = 0;
+
+    for (sp++; sp < end && *sp >= '0' && *sp <= '9'; sp++) {
+      if (*sp == '0') {
+        zeros++;
+        continue;
+      }
+
+      digits_end = sp + 1;
+
+      if (truncated ||
+          digits + (mantissa != 0 ? zeros : 0) >= VBT__NUMBER_MAX_DIGITS) {
+        truncated = VBT__TRUE;
+        continue;
+      }
+
+      for (; zeros > 0; zeros--) {
+        mantissa *= 10;
+        exp10--;
+        digits += mantissa != 0;
+      }
+
+      mantissa = mantissa * 10 + (uint64_t)(*sp - '0');
+      exp10--;
+      digits++;
+    }
+  }
+
+  // a sign or a '.' alone is not a number
+  if (sp == digits_start || (sp - digits_start == 1 && *digits_start == '.')) {
+    return -1;
+  }
+
+  // the exponent is only consumed when digits follow 'e'
+  if (end - sp > 1 && (*sp == 'e' || *sp == 'E')) {
+    const char* ep = sp + 1;
+    int exp_sign = 1;
+    int exp = 0;
+
+    if (*ep == '-') {
+      exp_sign = -1;
+      ep++;
+    } else if (*ep == '+') {
+      ep++;
+    }
+
+    if (ep < end && *ep >= '0' && *ep <= '9') {
+      while (ep < end && *ep >= '0' && *ep <= '9') {
+        // saturate, anything this large is out of range anyway
+        if (exp < VBT__NUMBER_EXP_LIMIT) {
+          exp = exp * 10 + (*ep - '0');
+        }
+
+        ep++;
+      }
+
+      exponent = exp_sign * exp;
+      exp10 += exponent;
+      sp = ep;
+    }
+  }
+
+  vbt_number_t res = 0;
+
+  if (mantissa != 0) {
+    if (exp10 >= 0) {
+      // integer, exact when <= VBT__NUMBER_MAX_INT
+      for (int i = 0; i < exp10; i++) {
+        if (mantissa > VBT__NUMBER_MAX_INT / 10) {
+          return -1;
+        }
+
+        mantissa *= 10;
+      }
+
+      if (mantissa > VBT__NUMBER_MAX_INT) {
+        return -1;
+      }
+
+      res = (vbt_number_t)mantissa;
+    } else {
+      const int k = -exp10;
+      const int tiny = k + VBT__NUMBER_MIN_EXP10;
+
+      // smaller than 10^VBT__NUMBER_MIN_EXP10, flushes to 0
+      const vbt_bool_t underflow =
+          tiny > 0 && (tiny >= (int)VBT__ARR_LEN(vbt__pow10_u64) ||
+                       mantissa < vbt__pow10_u64[tiny]);
+
+      // integer part > VBT__NUMBER_MAX_INT. for larger k the mantissa is too
+      // small to get there. digits left out of the mantissa add less than 1
+      // to it, so they don't change either check.
+      if (mantissa > VBT__NUMBER_MAX_INT && k <= VBT__NUMBER_MAX_INT_POW10 &&
+          mantissa >= (VBT__NUMBER_MAX_INT + 1) * vbt__pow10_u64[k]) {
+        return -1;
+      }
+
+      if (out && !underflow) {
+        res = truncated ? vbt__decimal_to_number_long(digits_start,
+                                                      digits_end, exponent)
+                        : vbt__decimal_to_number(mantissa, k);
+        res = VBT__MIN(res, VBT__NUMBER_MAX);
+      }
+    }
+  }
+
+  p->sp = sp;
+
+  if (out) {
+    *out = negative ? -res : res;
+  }
+
+  return 0;
+}
+
+// mantissa / 10^k correctly rounded to vbt_number_t, k > 0
+static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number(uint64_t mantissa,
+                                                          int k) {
+  // both operands are exact, so the quotient is correctly rounded (Clinger's
+  // fast path)
+#if !defined(VIBRANT_DOUBLE_PRECISION)
+  if (mantissa <= VBT__NUMBER_MAX_INT &&
+      k < (int)VBT__ARR_LEN(vbt__pow10_f32)) {
+    return (float)(int32_t)mantissa / vbt__pow10_f32[k];
+  }
+#endif
+
+  if (mantissa <= VBT__FAST_MANTISSA_MAX &&
+      k < (int)VBT__ARR_LEN(vbt__pow10_f64)) {
+    const double d = (double)mantissa / vbt__pow10_f64[k];
+
+#if defined(VIBRANT_DOUBLE_PRECISION)
+    return d;
+#else
+    // rounding d to float again only goes wrong when d is exactly halfway
+    // between two floats, then the other float is exactly 2 * d - f
+    const float f = (float)d;
+    const double g = 2.0 * d - (double)f;
+
+    if ((double)f == d || (double)(float)g != g) {
+      return f;
+    }
+#endif
+  }
+
+  vbt__bigint_t m = VBT__ZERO;
+  vbt__bigint_set_u64(&m, mantissa);
+
+  return vbt__decimal_to_number_slow(&m, k);
+}
+
+// the digits in [sp, end), which may contain a '.', times 10^exponent,
+// correctly rounded, for numbers with more than VBT__NUMBER_MAX_DIGITS
+// significant digits. digits after the first VBT__NUMBER_LONG_DIGITS are
+// only a sticky 1 at the end. a halfway point between two vbt_number_t above
+// 10^VBT__NUMBER_MIN_EXP10 has fewer significant digits, so the number is on
+// the same side of all of them.
+VBT__NOINLINE static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number_long(
+    const char* sp,
+    const char* end,
+    int exponent) {
+  vbt__bigint_t m = VBT__ZERO;
+  int k = -exponent;
+  int digits = 0;
+  vbt_bool_t fraction = VBT__FALSE;
+  vbt_bool_t sticky = VBT__FALSE;
+
+  for (; sp < end; sp++) {
+    if (*sp == '.') {
+      fraction = VBT__TRUE;
+    } else if (digits < VBT__NUMBER_LONG_DIGITS) {
+      vbt__bigint_mul_add(&m, 10, (uint32_t)(*sp - '0'));
+      digits += digits > 0 || *sp != '0';
+      k += fraction;
+    } else {
+      k -= !fraction;
+      sticky |= *sp != '0';
+    }
+  }
+
+  if (sticky) {
+    vbt__bigint_mul_add(&m, 10, 1);
+    k++;
+  }
+
+  return vbt__decimal_to_number_slow(&m, k);
+}
+
+// long division of mantissa by 10^k, one bit at a time, for the few
+// numbers the fast path can't handle. k >= 0
+VBT__NOINLINE static VBT__CONSTEXPR vbt_number_t vbt__decimal_to_number_slow(
+    const vbt__bigint_t* mantissa,
+    int k) {
+  vbt__bigint_t r = *mantissa;
+  vbt__bigint_t d = VBT__ZERO;
+  int e = 0;
+
+  vbt__bigint_set_u64(&d, 1);
+
+  for (int i = 0; i < k; i++) {
+    vbt__bigint_mul_add(&d, 10, 0);
+  }
+
+  // scale so that d <= r < 2d, mantissa / 10^k = r / d * 2^e
+  while (vbt__bigint_cmp(&r, &d) >= 0) {
+    vbt__bigint_shl1(&d);
+    e++;
+  }
+
+  do {
+    vbt__bigint_shl1(&r);
+    e--;
+  } while (vbt__bigint_cmp(&r, &d) < 0);
+
+  uint64_t bits = 0;
+
+  for (int i = 0; i < VBT__NUMBER_MANT_DIG; i++) {
+    bits <<= 1;
+
+    if (vbt__bigint_cmp(&r, &d) >= 0) {
+      vbt__bigint_sub(&r, &d);
+      bits |= 1;
+    }
+
+    vbt__bigint_shl1(&r);
+  }
+
+  // r is now twice the remainder, round half to even
+  const int cmp = vbt__bigint_cmp(&r, &d);
+
+  if (cmp > 0 || (cmp == 0 && (bits & 1))) {
+    bits++;
+  }
+
+  return vbt__ldexp((vbt_number_t)bits, e - (VBT__NUMBER_MANT_DIG - 1));
+}
+
+static VBT__CONSTEXPR void vbt__bigint_set_u64(vbt__bigint_t* b,
+                                               uint64_t value) {
+  for (size_t i = 0; i < VBT__ARR_LEN(b->limb); i++) {
+    b->limb[i] = (uint32_t)value;
+    value >>= 32;
+  }
+}
+
+// b = b * value + add
+static VBT__CONSTEXPR void vbt__bigint_mul_add(vbt__bigint_t* b,
+                                               uint32_t value,
+                                               uint32_t add) {
+  uint64_t carry = add;
+
+  for (size_t i = 0; i < VBT__ARR_LEN(b->limb); i++) {
+    carry += (uint64_t)b->limb[i] * value;
+    b->limb[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+}
+
+static VBT__CONSTEXPR void vbt__bigint_shl1(vbt__bigint_t* b) {
+  for (size_t i = VBT__ARR_LEN(b->limb) - 1; i > 0; i--) {
+    b->limb[i] = (b->limb[i] << 1) | (b->limb[i - 1] >> 31);
+  }
+
+  b->limb[0] <<= 1;
+}
+
+// a -= b, a >= b
+static VBT__CONSTEXPR void vbt__bigint_sub(vbt__bigint_t* a,
+                                           const vbt__bigint_t* b) {
+  uint64_t borrow = 0;
+
+  for (size_t i = 0; i < VBT__ARR_LEN(a->limb); i++) {
+    const uint64_t diff = (uint64_t)a->limb[i] - b->limb[i] - borrow;
+    a->limb[i] = (uint32_t)diff;
+    borrow = (diff >> 32) & 1;
+  }
+}
+
+static VBT__CONSTEXPR int vbt__bigint_cmp(const vbt__bigint_t* a,
+                                          const vbt__bigint_t* b) {
+  for (size_t i = VBT__ARR_LEN(a->limb); i > 0; i--) {
+    if (a->limb[i - 1] != b->limb[i - 1]) {
+      return a->limb[i - 1] < b->limb[i - 1] ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_01(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
+           VBT__PERCENT_MAX;
+  }
+
+  return VBT__CLAMP_01(css_value->value);
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_percent(
+    const vbt__css_value_t* css_value) {
+  return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX);
+}
+
+// [0-255] rgb component, rounded to u8 when the color is resolved
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_rgb(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    vbt_number_t percent =
+        VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
+        VBT__PERCENT_MAX;
+
+    return percent * (vbt_number_t)(255);
+  }
+
+  return css_value->value;
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_lch_chroma(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) *
+           (vbt_number_t)(1.5);
+  }
+
+  return css_value->value;
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_lab_ab(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    return VBT__CLAMP(css_value->value, -VBT__PERCENT_MAX, VBT__PERCENT_MAX) *
+           (vbt_number_t)(1.25);
+  }
+
+  return css_value->value;
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_ok_lightness(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
+           VBT__PERCENT_MAX;
+  }
+
+  return VBT__CLAMP_01(css_value->value);
+}
+
+static VBT__CONSTEXPR vbt_number_t vbt__css_value_to_oklab_ab(
+    const vbt__css_value_t* css_value) {
+  if (css_value->unit == VBT_UNIT_PERCENT) {
+    return VBT__CLAMP(css_value->value, -VBT__PERCENT_MAX, VBT__PERCENT_MAX) *
+           (vbt_number_t)(0.004);
+  }
+
+  return css_value->value;
+}
+
+// returns the one function value can name, decided by a single byte, or
+// VBT_COLOR_NONE when value doesn't start with that function's name.
+static VBT__CONSTEXPR vbt_color_fn_t vbt__match_css_function(
+    const char* value,
+    vbt_size_t len) {
+  // you must be this tall to enter
+  if (len < VBT__ARR_LEN("xxx(0,0,0)") - 1) {
+    return VBT_COLOR_NONE;
+  }
+
+  vbt_color_fn_t fn = VBT_COLOR_NONE;
+
+  switch (value[0]) {
+    case 'r': {
+      fn = VBT_COLOR_RGB;
+      break;
+    }
+    case 'h': {
+      fn = value[1] == 'w' ? VBT_COLOR_HWB : VBT_COLOR_HSL;
+      break;
+    }
+    case 'l': {
+      fn = value[1] == 'a' ? VBT_COLOR_LAB : VBT_COLOR_LCH;
+      break;
+    }
+    case 'o': {
+      fn = value[3] == 'a' ? VBT_COLOR_OKLAB : VBT_COLOR_OKLCH;
+      break;
+    }
+    default: {
+      return VBT_COLOR_NONE;
+    }
+  }
+
+  const vbt__css_function_t* css_fn = &vbt__css_functions[fn];
+
+  for (vbt_size_t i = 0; i < css_fn->len; i++) {
+    if (value[i] != css_fn->name[i]) {
+      return VBT_COLOR_NONE;
+    }
+  }
+
+  return fn;
+}
+
+static VBT__CONSTEXPR int vbt__parse_css_function(const char* value,
+                                                  vbt_size_t len,
+                                                  vbt_color_fn_t fn,
+                                                  vbt_color_t* color) {
+  const char* sp = value + vbt__css_functions[fn].len;
+  const char* end = value + len;
+  const vbt_bool_t validate_only = !color;
+  vbt__css_value_t arg[4] = VBT__ZERO;
+  vbt_size_t arg_count = 0;
+  vbt_bool_t is_alpha_version = VBT__FALSE;
+  vbt_bool_t has_slash = VBT__FALSE;
+  int state = VBT__FS_NAME;
+
+  // one pass over the bytes. each byte moves the dfa, which never allows
+  // more than 4 values, and numbers are handed to vbt__parse_number.
+  while (state != VBT__FS_DONE) {
+    int byte_class = VBT__FC_END;
+
+    if (sp < end) {
+      byte_class = vbt__fn_byte_class[(unsigned char)*sp];
+    }
+
+    state = vbt__fn_dfa[state][byte_class];
+
+    switch (vbt__fn_state_action[state]) {
+      case VBT__FA_NEXT: {
+        sp++;
+        break;
+      }
+      case VBT__FA_VALUE: {
+        vbt__parser_t parser = VBT__ZERO;
+        vbt__css_value_t* out = validate_only ? NULL : &arg[arg_count];
+
+        parser.sp = sp;
+        parser.end = end;
+
+        if (vbt__consume_css_value(&parser, out) != VBT_SUCCESS) {
+          return VBT_ERR;
+        }
+
+        arg_count++;
+        sp = parser.sp;
+        break;
+      }
+      case VBT__FA_PERCENT: {
+        arg[arg_count - 1].unit = VBT_UNIT_PERCENT;
+        sp++;
+        break;
+      }
+      case VBT__FA_ALPHA: {
+        is_alpha_version = VBT__TRUE;
+        sp++;
+        break;
+      }
+      case VBT__FA_SLASH: {
+        has_slash = VBT__TRUE;
+        sp++;
+        break;
+      }
+      case VBT__FA_DONE: {
+        break;
+      }
+      default: {
+        return VBT_ERR;
+      }
+    }
+  }
+
+  // 'a' version of functions always have 4 delimited parameters, non 'a'
+  // functions can only add alpha using '/'
+  if (is_alpha_version) {
+    if (arg_count != 4 || has_slash) {
+      return VBT_ERR;
+    }
+  } else if (arg_count == 4 && !has_slash) {
+    return VBT_ERR;
+  }
+
+  if (arg_count == 3) {
+    arg[3].value = 1;
+    arg[3].unit = VBT_UNIT_NUMBER;
+  }
+
+  if (validate_only) {
+    return VBT_SUCCESS;
+  }
+
+  // TODO: this should be an assert.
+  for (size_t i = 0; i < VBT__ARR_LEN(arg); i++) {
+    if (arg[i].unit == VBT_UNIT_UNSET) {
+      return VBT_ERR;
+    }
+  }
+
+  vbt__css_args(fn, arg, color->arg);
+
+  color->fn = fn;
+  color->resolved = VBT__RESOLVED_NONE;
+
+  for (size_t i = 0; i < VBT__ARR_LEN(arg); i++) {
+    color->unit[i] = arg[i].unit;
+  }
+
+  return VBT_SUCCESS;
+}
+
+// a value of a css function, a number or calc(). a '%' after a number is
+// left to the dfa, calc() is folded here into a number or a percentage, so
+// it costs no more than the numbers it is made of.
+static VBT__CONSTEXPR int vbt__consume_css_value(vbt__parser_t* parser,
+                                                 vbt__css_value_t* css_value) {
+  const char* end = parser->end;
+  vbt__calc_t calc = VBT__ZERO;
+
+  if (vbt__fn_byte_class[(unsigned char)*parser->sp] != VBT__FC_CALC) {
+    vbt_number_t* out = css_value ? &css_value->value : NULL;
+
+    if (vbt__parse_number(parser, out) != 0) {
+      return VBT_ERR;
+    }
+
+    if (css_value) {
+      css_value->unit = VBT_UNIT_NUMBER;
+    }
+
+    return VBT_SUCCESS;
+  }
+
+  if (end - parser->sp < 5 || vbt__casecmp(parser->sp, "calc(", 5) != 0) {
+    return VBT_ERR;
+  }
+
+  // from the '(', calc(...) is a parenthesized sum, folded as it is parsed
+  calc.sp = parser->sp + 4;
+  calc.end = end;
+  calc.fn = VBT_COLOR_NONE;
+  calc.nesting = 0;
+  calc.depth = 0;
+  calc.rel = NULL;
+  calc.const_count = 0;
+
+  if (vbt__calc_value(&calc) != VBT_SUCCESS ||
+      !vbt__isfinite(calc.value[0])) {
+    return VBT_ERR;
+  }
+
+  parser->sp = calc.sp;
+
+  // calc() has its own unit
+  if (parser->sp < end && *parser->sp == '%') {
+    return VBT_ERR;
+  }
+
+  if (css_value) {
+    css_value->value = calc.value[0];
+    css_value->unit = calc.unit[0];
+  }
+
+  return VBT_SUCCESS;
+}
+
+// <calc-sum> = <calc-product> [(+ | -) <calc-product>]*
+//
+// + and - take whitespace on both sides, as in css, where 1 +2 is a number
+// followed by the number +2.
+static VBT__CONSTEXPR int vbt__calc_sum(vbt__calc_t* calc) {
+  if (vbt__calc_product(calc) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  for (;;) {
+    const char* sp = vbt__trim_start(calc->sp, calc->end);
+    vbt__rop_t op = VBT__ROP_CONST;
+
+    if (sp == calc->end || (*sp != '+' && *sp != '-')) {
+      calc->sp = sp;
+      return VBT_SUCCESS;
+    }
+
+    if (sp == calc->sp || calc->end - sp < 2 ||
+        vbt__fn_byte_class[(unsigned char)sp[1]] != VBT__FC_SPACE) {
+      return VBT_ERR;
+    }
+
+    op = *sp == '+' ? VBT__ROP_ADD : VBT__ROP_SUB;
+    calc->sp = sp + 1;
+
+    if (vbt__calc_product(calc) != VBT_SUCCESS ||
+        vbt__calc_emit(calc, op, 0, VBT_UNIT_NUMBER) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+}
+
+// <calc-product> = <calc-value> [(* | /) <calc-value>]*
+static VBT__CONSTEXPR int vbt__calc_product(vbt__calc_t* calc) {
+  if (vbt__calc_value(calc) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  for (;;) {
+    const char* sp = vbt__trim_start(calc->sp, calc->end);
+    vbt__rop_t op = VBT__ROP_CONST;
+
+    // the whitespace before a + or - is left to vbt__calc_sum()
+    if (sp == calc->end || (*sp != '*' && *sp != '/')) {
+      return VBT_SUCCESS;
+    }
+
+    op = *sp == '*' ? VBT__ROP_MUL : VBT__ROP_DIV;
+    calc->sp = sp + 1;
+
+    if (vbt__calc_value(calc) != VBT_SUCCESS ||
+        vbt__calc_emit(calc, op, 0, VBT_UNIT_NUMBER) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+}
+
+// <calc-value> = <number> | <percentage> | <channel keyword> | (<calc-sum>)
+//                | calc(<calc-sum>) | (+ | -)<calc-value>
+static VBT__CONSTEXPR int vbt__calc_value(vbt__calc_t* calc) {
+  const char* end = calc->end;
+  const char* sp = vbt__trim_start(calc->sp, end);
+  int result = VBT_ERR;
+
+  if (sp == end) {
+    return VBT_ERR;
+  }
+
+  if (vbt__calc_is_number(sp, end)) {
+    vbt__parser_t parser = VBT__ZERO;
+    vbt_number_t value = 0;
+    vbt_unit_t unit = VBT_UNIT_NUMBER;
+
+    parser.sp = sp;
+    parser.end = end;
+
+    if (vbt__parse_number(&parser, &value) != 0) {
+      return VBT_ERR;
+    }
+
+    if (parser.sp < end && *parser.sp == '%') {
+      unit = VBT_UNIT_PERCENT;
+      parser.sp++;
+    }
+
+    calc->sp = parser.sp;
+    return vbt__calc_emit(calc, VBT__ROP_CONST, value, unit);
+  }
+
+  if (*sp != '(' && *sp != '-' && *sp != '+' &&
+      (end - sp <= 5 || vbt__casecmp(sp, "calc(", 5) != 0)) {
+    const int channel =
+        calc->fn == VBT_COLOR_NONE
+            ? -1
+            : vbt__relative_keyword(calc->fn, sp, end, &calc->sp);
+
+    return channel < 0 ? VBT_ERR
+                       : vbt__calc_emit(calc, VBT__ROP_CHANNEL,
+                                        (vbt_number_t)channel,
+                                        VBT_UNIT_NUMBER);
+  }
+
+  if (calc->nesting == VBT__CALC_MAX_NESTING) {
+    return VBT_ERR;
+  }
+
+  calc->nesting++;
+
+  if (*sp == '-' || *sp == '+') {
+    // a sign before a value that is not a number, with nothing in between,
+    // as - 1 or --1 are not values in css
+    calc->sp = sp + 1;
+
+    if (end - sp >= 2 && sp[1] != '-' && sp[1] != '+' &&
+        vbt__fn_byte_class[(unsigned char)sp[1]] != VBT__FC_SPACE &&
+        vbt__calc_value(calc) == VBT_SUCCESS) {
+      result = *sp == '-'
+                   ? vbt__calc_emit(calc, VBT__ROP_NEG, 0, VBT_UNIT_NUMBER)
+                   : VBT_SUCCESS;
+    }
+  } else {
+    calc->sp = sp + (*sp == '(' ? 1 : 5);
+
+    if (vbt__calc_sum(calc) == VBT_SUCCESS) {
+      calc->sp = vbt__trim_start(calc->sp, end);
+
+      if (calc->sp < end && *calc->sp == ')') {
+        calc->sp++;
+        result = VBT_SUCCESS;
+      }
+    }
+  }
+
+  calc->nesting--;
+  return result;
+}
+
+// checks the units op combines and keeps track of them on the stack, then
+// folds or compiles op. unit is the unit of the value op pushes.
+static VBT__CONSTEXPR int vbt__calc_emit(vbt__calc_t* calc,
+                                         vbt__rop_t op,
+                                         vbt_number_t arg,
+                                         vbt_unit_t unit) {
+  vbt_unit_t* top = calc->unit + calc->depth;
+
+  if (op == VBT__ROP_CONST || op == VBT__ROP_CHANNEL) {
+    if (calc->depth == VBT__CALC_MAX_STACK) {
+      return VBT_ERR;
+    }
+
+    top[0] = unit;
+  } else if (op == VBT__ROP_ADD || op == VBT__ROP_SUB) {
+    // numbers and percentages can't be added, a percentage of what would
+    // depend on the argument
+    if (top[-2] != top[-1]) {
+      return VBT_ERR;
+    }
+  } else if (op == VBT__ROP_MUL) {
+    // at most one factor is a percentage, and so is the product
+    if (top[-2] == VBT_UNIT_PERCENT && top[-1] == VBT_UNIT_PERCENT) {
+      return VBT_ERR;
+    }
+
+    top[-2] = top[-1] == VBT_UNIT_PERCENT ? top[-1] : top[-2];
+  } else if (op == VBT__ROP_DIV && top[-1] == VBT_UNIT_PERCENT) {
+    return VBT_ERR;
+  }
+
+  if ((calc->rel ? vbt__relative_calc_emit(calc, op, arg)
+                 : vbt__calc_fold(calc, op, arg)) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  calc->depth += vbt__rop_stack[op][1];
+  return VBT_SUCCESS;
+}
+
+// the emit of calc() arguments, which are folded into calc->value[0] while
+// they are parsed, so calc() costs no more than the numbers it is made of
+static VBT__CONSTEXPR int vbt__calc_fold(vbt__calc_t* calc,
+                                         vbt__rop_t op,
+                                         vbt_number_t arg) {
+  vbt_number_t* top = calc->value + calc->depth;
+
+  switch (op) {
+    case VBT__ROP_CONST: {
+      top[0] = arg;
+      break;
+    }
+    case VBT__ROP_ADD: {
+      top[-2] += top[-1];
+      break;
+    }
+    case VBT__ROP_SUB: {
+      top[-2] -= top[-1];
+      break;
+    }
+    case VBT__ROP_MUL: {
+      top[-2] *= top[-1];
+      break;
+    }
+    case VBT__ROP_DIV: {
+      if (top[-1] == 0) {
+        return VBT_ERR;
+      }
+
+      top[-2] /= top[-1];
+      break;
+    }
+    case VBT__ROP_NEG: {
+      top[-1] = -top[-1];
+      break;
+    }
+    default: {
+      // no channels outside of relative colors
+      return VBT_ERR;
+    }
+  }
+
+  return VBT_SUCCESS;
+}
+
+// whether sp starts a number, and not a sign before another value
+static VBT__CONSTEXPR vbt_bool_t vbt__calc_is_number(const char* sp,
+                                                     const char* end) {
+  if (*sp == '-' || *sp == '+') {
+    sp++;
+  }
+
+  return sp < end && (*sp == '.' || (*sp >= '0' && *sp <= '9'));
+}
+
+// translates the values of a css function into the arguments of fn
+static VBT__CONSTEXPR void vbt__css_args(vbt_color_fn_t fn,
+                                         const vbt__css_value_t* arg,
+                                         vbt_number_t* out) {
+  // https://developer.mozilla.org/en-US/docs/Web/CSS/Reference/Values/color_value
+  switch (fn) {
+    case VBT_COLOR_HSL:
+    case VBT_COLOR_HWB: {
+      out[0] = arg[0].value;
+      out[1] = vbt__css_value_to_percent(&arg[1]);
+      out[2] = vbt__css_value_to_percent(&arg[2]);
+      break;
+    }
+    case VBT_COLOR_RGB: {
+      out[0] = vbt__css_value_to_rgb(&arg[0]);
+      out[1] = vbt__css_value_to_rgb(&arg[1]);
+      out[2] = vbt__css_value_to_rgb(&arg[2]);
+      break;
+    }
+    case VBT_COLOR_LCH: {
+      out[0] = vbt__css_value_to_percent(&arg[0]);
+      out[1] = vbt__css_value_to_lch_chroma(&arg[1]);
+      out[2] = arg[2].value;
+      break;
+    }
+    case VBT_COLOR_LAB: {
+      out[0] = vbt__css_value_to_percent(&arg[0]);
+      out[1] = vbt__css_value_to_lab_ab(&arg[1]);
+      out[2] = vbt__css_value_to_lab_ab(&arg[2]);
+      break;
+    }
+    case VBT_COLOR_OKLCH: {
+      // chroma has same constraints as oklab ab
+      out[0] = vbt__css_value_to_ok_lightness(&arg[0]);
+      out[1] = vbt__css_value_to_oklab_ab(&arg[1]);
+      out[2] = arg[2].value;
+      break;
+    }
+    case VBT_COLOR_OKLAB: {
+      out[0] = vbt__css_value_to_ok_lightness(&arg[0]);
+      out[1] = vbt__css_value_to_oklab_ab(&arg[1]);
+      out[2] = vbt__css_value_to_oklab_ab(&arg[2]);
+      break;
+    }
+    default: {
+      // unreachable
+      break;
+    }
+  }
+
+  out[3] = vbt__css_value_to_01(&arg[3]);
+}
+
+// color-mix(in <space> [<hue> hue], <color> [<p>%], <color> [<p>%])
+// https://www.w3.org/TR/css-color-5/#color-mix
+static VBT__CONSTEXPR int vbt__parse_color_mix(const char* value,
+                                               vbt_size_t len,
+                                               vbt_color_t* color) {
+  const char* sp = value + VBT__ARR_LEN(VBT__COLOR_MIX) - 1;
+  const char* end = value + len - 1;
+  const char* part[4] = {0};
+  vbt_size_t parts = 1;
+  int depth = 0;
+  vbt_space_t space = VBT_SPACE_SRGB;
+  vbt_hue_method_t hue = VBT_HUE_SHORTER;
+  vbt_color_t operand[2] = VBT__ZERO;
+  vbt_number_t percent[2] = {0};
+  vbt_bool_t has_percent[2] = {0};
+  vbt_number_t sum = 0;
+
+  if (*end != ')') {
+    return VBT_ERR;
+  }
+
+  // split the arguments at the commas outside of the operands' parentheses.
+  // part i is [part[i], part[i + 1] - 1).
+  part[0] = sp;
+
+  for (; sp < end; sp++) {
+    if (*sp == '(') {
+      depth++;
+    } else if (*sp == ')' && --depth < 0) {
+      return VBT_ERR;
+    } else if (*sp == ',' && depth == 0) {
+      if (parts == 3) {
+        return VBT_ERR;
+      }
+
+      part[parts++] = sp + 1;
+    }
+  }
+
+  if (parts != 3 || depth != 0) {
+    return VBT_ERR;
+  }
+
+  part[3] = end + 1;
+
+  if (vbt__parse_mix_space(part[0], part[1] - 1, &space, &hue) !=
+      VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  for (int i = 0; i < 2; i++) {
+    if (vbt__parse_mix_operand(part[i + 1], part[i + 2] - 1,
+                               color ? &operand[i] : NULL, &percent[i],
+                               &has_percent[i]) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+
+  // https://www.w3.org/TR/css-color-5/#color-mix-percent-norm
+  if (!has_percent[0] && !has_percent[1]) {
+    percent[0] = percent[1] = 50;
+  } else if (!has_percent[0]) {
+    percent[0] = 100 - percent[1];
+  } else if (!has_percent[1]) {
+    percent[1] = 100 - percent[0];
+  }
+
+  sum = percent[0] + percent[1];
+
+  if (sum <= 0) {
+    return VBT_ERR;
+  }
+
+  if (!color) {
+    return VBT_SUCCESS;
+  }
+
+  // percentages that add up to less than 100% make the mix transparent
+  return vbt__color_mix(space, hue, operand, percent[1] / sum,
+                        sum < 100 ? sum / 100 : 1, color);
+}
+
+// indexed by vbt_space_t
+static VBT__CONSTEXPR const vbt__css_keyword_t vbt__mix_spaces[] = {
+    {"srgb", 4}, {"srgb-linear", 11}, {"lab", 3},
+    {"lch", 3},  {"oklab", 5},        {"oklch", 5},
+};
+
+// indexed by vbt_hue_method_t
+static VBT__CONSTEXPR const vbt__css_keyword_t vbt__mix_hues[] = {
+    {"shorter", 7},
+    {"longer", 6},
+    {"increasing", 10},
+    {"decreasing", 10},
+};
+
+static VBT__CONSTEXPR const vbt__css_keyword_t vbt__mix_in[] = {{"in", 2}};
+static VBT__CONSTEXPR const vbt__css_keyword_t vbt__mix_hue[] = {{"hue", 3}};
+
+// in <space> [<hue> hue]
+static VBT__CONSTEXPR int vbt__parse_mix_space(const char* sp,
+                                               const char* end,
+                                               vbt_space_t* space,
+                                               vbt_hue_method_t* hue) {
+  const char* token[4] = {0};
+  vbt_size_t token_len[4] = {0};
+  vbt_size_t tokens = 0;
+  int index = 0;
+
+  for (sp = vbt__trim_start(sp, end); sp < end;
+       sp = vbt__trim_start(sp, end)) {
+    const char* token_end = sp;
+
+    while (token_end < end &&
+           vbt__fn_byte_class[(unsigned char)*token_end] != VBT__FC_SPACE) {
+      token_end++;
+    }
+
+    if (tokens == VBT__ARR_LEN(token)) {
+      return VBT_ERR;
+    }
+
+    token[tokens] = sp;
+    token_len[tokens++] = (vbt_size_t)(token_end - sp);
+    sp = token_end;
+  }
+
+  if ((tokens != 2 && tokens != 4) ||
+      vbt__find_keyword(token[0], token_len[0], vbt__mix_in, 1) != 0) {
+    return VBT_ERR;
+  }
+
+  index = vbt__find_keyword(token[1], token_len[1], vbt__mix_spaces,
+                            (int)VBT__ARR_LEN(vbt__mix_spaces));
+
+  if (index < 0) {
+    return VBT_ERR;
+  }
+
+  *space = (vbt_space_t)index;
+  *hue = VBT_HUE_SHORTER;
+
+  if (tokens == 2) {
+    return VBT_SUCCESS;
+  }
+
+  // a hue method is only allowed in polar spaces
+  index = vbt__find_keyword(token[2], token_len[2], vbt__mix_hues,
+                            (int)VBT__ARR_LEN(vbt__mix_hues));
+
+  if (index < 0 || (*space != VBT_SPACE_LCH && *space != VBT_SPACE_OKLCH) ||
+      vbt__find_keyword(token[3], token_len[3], vbt__mix_hue, 1) != 0) {
+    return VBT_ERR;
+  }
+
+  *hue = (vbt_hue_method_t)index;
+  return VBT_SUCCESS;
+}
+
+// <color> [<p>%] or <p>% <color>. when color is NULL, the color is only
+// validated, the percentage is always parsed.
+static VBT__CONSTEXPR int vbt__parse_mix_operand(const char* sp,
+                                                 const char* end,
+                                                 vbt_color_t* color,
+                                                 vbt_number_t* percent,
+                                                 vbt_bool_t* has_percent) {
+  const char* number = NULL;
+  const char* number_end = NULL;
+
+  sp = vbt__trim_start(sp, end);
+  end = vbt__trim_end(sp, end);
+  *has_percent = VBT__FALSE;
+
+  if (sp == end) {
+    return VBT_ERR;
+  }
+
+  // no color starts with a number, or ends with '%'
+  if (vbt__fn_byte_class[(unsigned char)*sp] == VBT__FC_NUMBER) {
+    number = sp;
+
+    while (sp < end &&
+           vbt__fn_byte_class[(unsigned char)*sp] != VBT__FC_SPACE) {
+      sp++;
+    }
+
+    number_end = sp;
+    sp = vbt__trim_start(sp, end);
+  } else if (end[-1] == '%') {
+    number_end = end;
+
+    while (end > sp &&
+           vbt__fn_byte_class[(unsigned char)end[-1]] != VBT__FC_SPACE) {
+      end--;
+    }
+
+    number = end;
+    end = vbt__trim_end(sp, end);
+  }
+
+  if (number) {
+    vbt__parser_t parser = VBT__ZERO;
+
+    parser.sp = number;
+    parser.end = number_end;
+
+    if (vbt__parse_number(&parser, percent) != 0 ||
+        parser.sp + 1 != number_end || *parser.sp != '%' || *percent < 0 ||
+        *percent > VBT__PERCENT_MAX) {
+      return VBT_ERR;
+    }
+
+    *has_percent = VBT__TRUE;
+  }
+
+  if (sp == end) {
+    return VBT_ERR;
+  }
+
+  return vbt__parse(sp, (vbt_size_t)(end - sp), color);
+}
+
+// index of the keyword [sp, sp + len) is, case insensitive, or -1
+static VBT__CONSTEXPR int vbt__find_keyword(
+    const char* sp,
+    vbt_size_t len,
+    const vbt__css_keyword_t* keywords,
+    int count) {
+  for (int i = 0; i < count; i++) {
+    if (keywords[i].len == len &&
+        vbt__casecmp(sp, keywords[i].name, len) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static VBT__CONSTEXPR const char* vbt__trim_start(const char* sp,
+                                                  const char* end) {
+  while (sp < end && vbt__fn_byte_class[(unsigned char)*sp] == VBT__FC_SPACE) {
+    sp++;
+  }
+
+  return sp;
+}
+
+static VBT__CONSTEXPR const char* vbt__trim_end(const char* sp,
+                                                const char* end) {
+  while (end > sp &&
+         vbt__fn_byte_class[(unsigned char)end[-1]] == VBT__FC_SPACE) {
+    end--;
+  }
+
+  return end;
+}
+
+// mixes operand[0] and operand[1] at t with premultiplied alpha, like
+// vbt_interpolate_n(), into a color of the space's function. operands that
+// already are in space are mixed in their own arguments, other Lab and
+// OKLab colors are converted through linear light, which keeps them outside
+// of sRGB, and the rest are converted from sRGB. color is left unresolved.
+static VBT__CONSTEXPR int vbt__color_mix(vbt_space_t space,
+                                         vbt_hue_method_t hue,
+                                         vbt_color_t* operand,
+                                         vbt_number_t t,
+                                         vbt_number_t alpha,
+                                         vbt_color_t* color) {
+  const vbt_bool_t polar = space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH;
+  const vbt_number_t scale = space <= VBT_SPACE_SRGB_LINEAR ? 255 : 1;
+  vbt_number_t from[4] = {0};
+  vbt_number_t to[4] = {0};
+  vbt_number_t mix[4] = {0};
+  vbt_number_t step[4] = {0};
+  vbt_number_t w = 0;
+
+  for (int i = 0; i < 2; i++) {
+    const vbt_color_fn_t fn = operand[i].fn;
+    const vbt_bool_t lab = fn == VBT_COLOR_LAB || fn == VBT_COLOR_LCH;
+    const vbt_bool_t oklab = fn == VBT_COLOR_OKLAB || fn == VBT_COLOR_OKLCH;
+    const vbt_bool_t native =
+        ((space == VBT_SPACE_LAB || space == VBT_SPACE_LCH) && lab) ||
+        ((space == VBT_SPACE_OKLAB || space == VBT_SPACE_OKLCH) && oklab);
+    vbt_number_t* out = i == 0 ? from : to;
+
+    if (lab || oklab) {
+      if (native) {
+        vbt__interpolation_stop(space, &operand[i], out);
+      } else {
+        vbt__color_mix_operand(space, &operand[i], out);
+      }
+    } else if (vbt__interpolation_stop(space, &operand[i], out) !=
+               VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+
+  vbt__interpolation_steps(space, hue, VBT__TRUE, from, to, t, 0, mix, step);
+
+  // un-premultiply, and a transparent color is all 0
+  w = mix[3] > 0 ? 1 / mix[3] : 0;
+  mix[0] *= w;
+  mix[1] *= w;
+  mix[2] *= polar ? 1 : w;
+
+  if (polar) {
+    mix[2] = vbt__fmod(mix[2], VBT__DEG_MAX);
+  } else if (space == VBT_SPACE_SRGB_LINEAR) {
+    for (int i = 0; i < 3; i++) {
+      mix[i] = vbt__linear_to_srgb(VBT__CLAMP_01(mix[i]));
+    }
+  }
+
+  mix[0] *= scale;
+  mix[1] *= scale;
+  mix[2] *= scale;
+  mix[3] *= alpha;
+  vbt__color_init_args(color, vbt__space_functions[space], mix);
+  return VBT_SUCCESS;
+}
+
+// color, of VBT_COLOR_LAB, VBT_COLOR_LCH, VBT_COLOR_OKLAB or
+// VBT_COLOR_OKLCH, in space through linear-light sRGB, with nothing clamped
+// but lightness and alpha. gamma encoding mirrors below 0.
+static VBT__CONSTEXPR void vbt__color_mix_operand(vbt_space_t space,
+                                                  const vbt_color_t* color,
+                                                  vbt_number_t* out) {
+  const vbt_number_t* arg = color->arg;
+  const vbt_number_t lightness = VBT__CLAMP_0100(arg[0]);
+  vbt_number_t a = arg[1];
+  vbt_number_t b = arg[2];
+  vbt_number_t lin[3] = {0};
+
+  if (color->fn == VBT_COLOR_LCH || color->fn == VBT_COLOR_OKLCH) {
+    vbt_number_t s = 0, c = 0;
+
+    vbt__sincos_deg(arg[2], &s, &c);
+    a = arg[1] * c;
+    b = arg[1] * s;
+  }
+
+  if (color->fn == VBT_COLOR_LAB || color->fn == VBT_COLOR_LCH) {
+    vbt__lab_to_linear(lightness, a, b, lin);
+  } else {
+    vbt__oklab_to_linear(lightness, a, b, lin);
+  }
+
+  if (space == VBT_SPACE_SRGB) {
+    for (int i = 0; i < 3; i++) {
+      out[i] = lin[i] < 0 ? -vbt__linear_to_srgb(-lin[i])
+                          : vbt__linear_to_srgb(lin[i]);
+    }
+  } else if (space == VBT_SPACE_SRGB_LINEAR) {
+    out[0] = lin[0];
+    out[1] = lin[1];
+    out[2] = lin[2];
+  } else if (space == VBT_SPACE_LAB || space == VBT_SPACE_LCH) {
+    vbt__linear_to_lab(lin[0], lin[1], lin[2], out);
+  } else {
+    vbt__linear_to_oklab(lin[0], lin[1], lin[2], out);
+  }
+
+  if (space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH) {
+    vbt__to_polar(out);
+  }
+
+  out[3] = VBT__CLAMP_01(arg[3]);
+}
+
+// <fn>(from <origin> <channel> <channel> <channel> [/ <channel>])
+// https://www.w3.org/TR/css-color-5/#relative-colors
+static VBT__CONSTEXPR int vbt__relative_compile(const char* value,
+                                                vbt_size_t len,
+                                                vbt_relative_t* rel) {
+  vbt__calc_t calc = VBT__ZERO;
+  vbt_relative_t compiled = VBT__ZERO;
+  vbt_color_fn_t fn = VBT_COLOR_NONE;
+  const char* sp = NULL;
+  const char* end = NULL;
+
+  if (!value || len == 0 || len > VBT__MAX_STR_LEN) {
+    return VBT_ERR;
+  }
+
+  fn = vbt__match_css_function(value, len);
+  end = value + len - 1;
+
+  if (fn == VBT_COLOR_NONE || *end != ')') {
+    return VBT_ERR;
+  }
+
+  // rgba(), hsla(), ...
+  sp = value + vbt__css_functions[fn].len;
+  sp += *sp == 'a';
+  sp = vbt__trim_start(sp, end);
+
+  if (*sp != '(') {
+    return VBT_ERR;
+  }
+
+  // from var or from var(...)
+  sp = vbt__trim_start(sp + 1, end);
+
+  if (end - sp < 8 || vbt__casecmp(sp, "from", 4) != 0 ||
+      vbt__fn_byte_class[(unsigned char)sp[4]] != VBT__FC_SPACE) {
+    return VBT_ERR;
+  }
+
+  sp = vbt__trim_start(sp + 4, end);
+
+  if (end - sp < 3 || vbt__casecmp(sp, "var", 3) != 0) {
+    return VBT_ERR;
+  }
+
+  sp += 3;
+
+  if (sp < end && *sp == '(') {
+    int depth = 0;
+
+    do {
+      depth += *sp == '(';
+      depth -= *sp == ')';
+      sp++;
+    } while (sp < end && depth > 0);
+
+    if (depth > 0) {
+      return VBT_ERR;
+    }
+  }
+
+  compiled.fn = fn;
+  compiled.op_count = 0;
+  calc.sp = sp;
+  calc.end = end;
+  calc.fn = fn;
+  calc.rel = &compiled;
+
+  for (int k = 0; k < 4; k++) {
+    const char* channel = vbt__trim_start(calc.sp, end);
+
+    if (calc.sp == channel && calc.sp < end && *calc.sp != '/') {
+      return VBT_ERR;
+    }
+
+    calc.sp = channel;
+
+    // the alpha channel is optional, after a '/'
+    if (k == 3) {
+      if (calc.sp == end) {
+        if (vbt__relative_emit(&calc, VBT__ROP_CHANNEL, 3) != VBT_SUCCESS ||
+            vbt__relative_emit(&calc, VBT__ROP_STORE, 3) != VBT_SUCCESS) {
+          return VBT_ERR;
+        }
+        break;
+      }
+
+      if (*calc.sp != '/') {
+        return VBT_ERR;
+      }
+
+      calc.sp = vbt__trim_start(calc.sp + 1, end);
+    }
+
+    if (vbt__relative_channel(&calc, k) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+
+  if (vbt__trim_start(calc.sp, end) != end) {
+    return VBT_ERR;
+  }
+
+  *rel = compiled;
+  return VBT_SUCCESS;
+}
+
+// a channel of a relative color: a number or percentage, a channel keyword,
+// or calc(), stored into channel
+static VBT__CONSTEXPR int vbt__relative_channel(vbt__calc_t* calc,
+                                                int channel) {
+  const char* sp = calc->sp;
+  const char* end = calc->end;
+  const vbt_color_fn_t fn = calc->rel->fn;
+
+  if (sp == end) {
+    return VBT_ERR;
+  }
+
+  if (vbt__calc_is_number(sp, end)) {
+    vbt__parser_t parser = VBT__ZERO;
+    vbt_number_t value = 0;
+    vbt_unit_t unit = VBT_UNIT_NUMBER;
+
+    parser.sp = sp;
+    parser.end = end;
+
+    if (vbt__parse_number(&parser, &value) != 0) {
+      return VBT_ERR;
+    }
+
+    if (parser.sp < end && *parser.sp == '%') {
+      unit = VBT_UNIT_PERCENT;
+      parser.sp++;
+    }
+
+    calc->sp = parser.sp;
+
+    if (vbt__relative_const(
+            calc, vbt__relative_convert(fn, channel, value, unit)) !=
+        VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  } else {
+    calc->depth = 0;
+
+    if (vbt__calc_value(calc) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+
+    // a percentage is scaled like a percentage argument of fn
+    if (calc->unit[0] == VBT_UNIT_PERCENT &&
+        (vbt__relative_const(calc, vbt__relative_convert(fn, channel, 1,
+                                                          VBT_UNIT_PERCENT)) !=
+             VBT_SUCCESS ||
+         vbt__relative_emit(calc, VBT__ROP_MUL, -1) != VBT_SUCCESS)) {
+      return VBT_ERR;
+    }
+  }
+
+  return vbt__relative_emit(calc, VBT__ROP_STORE, channel);
+}
+
+// value with unit as the argument channel of fn, like vbt__css_args()
+static VBT__CONSTEXPR vbt_number_t vbt__relative_convert(vbt_color_fn_t fn,
+                                                         int channel,
+                                                         vbt_number_t value,
+                                                         vbt_unit_t unit) {
+  vbt__css_value_t arg[4] = VBT__ZERO;
+  vbt_number_t out[4] = {0};
+
+  for (int i = 0; i < 4; i++) {
+    arg[i].value = 0;
+    arg[i].unit = VBT_UNIT_NUMBER;
+  }
+
+  arg[channel].value = value;
+  arg[channel].unit = unit;
+  vbt__css_args(fn, arg, out);
+  return out[channel];
+}
+
+// index of the channel keyword at sp, or -1. the channels of a function are
+// the last three letters of its name, and alpha.
+static VBT__CONSTEXPR int vbt__relative_keyword(vbt_color_fn_t fn,
+                                                const char* sp,
+                                                const char* end,
+                                                const char** keyword_end) {
+  const vbt__css_function_t* css_fn = &vbt__css_functions[fn];
+  const char* name = css_fn->name + css_fn->len - 3;
+  const char* p = sp;
+
+  while (p < end && vbt__tolower(*p) >= 'a' && vbt__tolower(*p) <= 'z') {
+    p++;
+  }
+
+  *keyword_end = p;
+
+  if (p - sp == 5 && vbt__casecmp(sp, "alpha", 5) == 0) {
+    return 3;
+  }
+
+  for (int k = 0; k < 3 && p - sp == 1; k++) {
+    if (vbt__tolower(*sp) == name[k]) {
+      return k;
+    }
+  }
+
+  return -1;
+}
+
+// appends op, and arg unless it is negative, to the program. calc() keeps
+// track of the stack.
+static VBT__CONSTEXPR int vbt__relative_emit(vbt__calc_t* calc,
+                                             vbt__rop_t op,
+                                             int arg) {
+  vbt_relative_t* rel = calc->rel;
+  const int len = arg < 0 ? 1 : 2;
+
+  if (rel->op_count + len > VBT__RELATIVE_MAX_OPS) {
+    return VBT_ERR;
+  }
+
+  rel->ops[rel->op_count++] = (vbt_u8_t)op;
+
+  if (arg >= 0) {
+    rel->ops[rel->op_count++] = (vbt_u8_t)arg;
+  }
+
+  return VBT_SUCCESS;
+}
+
+// compiles op of calc() in a relative color
+static VBT__CONSTEXPR int vbt__relative_calc_emit(vbt__calc_t* calc,
+                                                  vbt__rop_t op,
+                                                  vbt_number_t arg) {
+  if (op == VBT__ROP_CONST) {
+    return vbt__relative_const(calc, arg);
+  }
+
+  return vbt__relative_emit(calc, op, op == VBT__ROP_CHANNEL ? (int)arg : -1);
+}
+
+static VBT__CONSTEXPR int vbt__relative_const(vbt__calc_t* calc,
+                                              vbt_number_t value) {
+  if (calc->const_count == VBT__RELATIVE_MAX_CONSTS) {
+    return VBT_ERR;
+  }
+
+  calc->rel->consts[calc->const_count] = value;
+  return vbt__relative_emit(calc, VBT__ROP_CONST, calc->const_count++);
+}
+
+// loads the arguments of count origins in fn, plus alpha, into
+// in[channel][i]. an origin of fn keeps the arguments it was written with.
+// Lab, LCH, Oklab and Oklch origins, which can be outside of sRGB, are
+// converted like color-mix() operands, through linear-light sRGB with
+// nothing clamped, unless fn is hsl() or hwb(), which only cover sRGB. the
+// others are evaluated, and converted from sRGB together like the batch
+// conversions. err[i] is VBT_ERR when origin i can't be evaluated.
+static VBT__CONSTEXPR void vbt__relative_load(
+    vbt_color_fn_t fn,
+    vbt_color_t* origins,
+    vbt_size_t count,
+    vbt_number_t in[4][VBT__RELATIVE_CHUNK],
+    int* err) {
+  vbt_number_t rgba[VBT__RELATIVE_CHUNK * 4] = {0};
+  vbt_number_t arg[VBT__RELATIVE_CHUNK * 4] = {0};
+  vbt_size_t index[VBT__RELATIVE_CHUNK] = {0};
+  vbt_size_t converted = 0;
+  vbt_space_t space = VBT_SPACE_SRGB;
+
+  for (int k = VBT_SPACE_LAB; k <= VBT_SPACE_OKLCH; k++) {
+    space = vbt__space_functions[k] == fn ? (vbt_space_t)k : space;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt_color_t* origin = &origins[i];
+    const vbt_number_t* a = origin->arg;
+    const vbt_bool_t unbounded =
+        fn != VBT_COLOR_HSL && fn != VBT_COLOR_HWB &&
+        (origin->fn == VBT_COLOR_LAB || origin->fn == VBT_COLOR_LCH ||
+         origin->fn == VBT_COLOR_OKLAB || origin->fn == VBT_COLOR_OKLCH) &&
+        vbt__isfinite(a[0]) && vbt__isfinite(a[1]) && vbt__isfinite(a[2]) &&
+        vbt__isfinite(a[3]);
+
+    err[i] = VBT_SUCCESS;
+
+    if (origin->fn == fn) {
+      for (int j = 0; j < 4; j++) {
+        in[j][i] = origin->arg[j];
+      }
+    } else if (unbounded) {
+      vbt_number_t out[4] = {0};
+
+      vbt__color_mix_operand(space, origin, out);
+
+      for (int j = 0; j < 4; j++) {
+        in[j][i] = out[j] * (fn == VBT_COLOR_RGB && j < 3 ? 255 : 1);
+      }
+    } else if (vbt__color_srgb(origin, &rgba[converted * 4]) == VBT_SUCCESS) {
+      index[converted++] = i;
+    } else {
+      // runs as zeros, and the result is dropped
+      err[i] = VBT_ERR;
+
+      for (int j = 0; j < 4; j++) {
+        in[j][i] = 0;
+      }
+    }
+  }
+
+  switch (fn) {
+    case VBT_COLOR_RGB: {
+      for (vbt_size_t k = 0; k < converted * 4; k++) {
+        arg[k] = rgba[k] * ((k & 3) == 3 ? 1 : (vbt_number_t)255);
+      }
+      break;
+    }
+    case VBT_COLOR_HSL: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_hsl(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+    case VBT_COLOR_HWB: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_hwb(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+    case VBT_COLOR_LCH: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_lch(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+    case VBT_COLOR_LAB: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_lab(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+    case VBT_COLOR_OKLCH: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_oklch(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+    default: {
+      for (vbt_size_t k = 0; k < converted; k++) {
+        vbt__srgb_to_oklab(&rgba[k * 4], &arg[k * 4]);
+      }
+      break;
+    }
+  }
+
+  for (vbt_size_t k = 0; k < converted; k++) {
+    for (int j = 0; j < 4; j++) {
+      in[j][index[k]] = arg[k * 4 + j];
+    }
+  }
+}
+
+// applies rel, which is verified, to count <= VBT__RELATIVE_CHUNK origins,
+// into colors[i] and err[i]. returns VBT_ERR when any of them failed.
+static VBT__CONSTEXPR int vbt__relative_apply_chunk(const vbt_relative_t* rel,
+                                                    vbt_color_t* origins,
+                                                    vbt_size_t count,
+                                                    vbt_color_t* colors,
+                                                    int* err) {
+  vbt_number_t in[4][VBT__RELATIVE_CHUNK] = {{0}};
+  vbt_number_t out[4][VBT__RELATIVE_CHUNK] = {{0}};
+  int result = VBT_SUCCESS;
+
+  vbt__relative_load(rel->fn, origins, count, in, err);
+  vbt__relative_run(rel, in, out, count);
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt_number_t arg[4] = {0, 0, 0, 0};
+
+    for (int j = 0; j < 4; j++) {
+      arg[j] = out[j][i];
+      err[i] = vbt__isfinite(arg[j]) ? err[i] : VBT_ERR;
+    }
+
+    if (err[i] == VBT_SUCCESS) {
+      vbt__color_init_args(&colors[i], rel->fn, arg);
+    } else {
+      result = VBT_ERR;
+    }
+  }
+
+  return result;
+}
+
+// checks that rel holds a program vbt__relative_run() can run: known
+// opcodes, constant and channel indices in range, a stack that neither
+// underflows nor overflows and ends empty, and every channel stored.
+// rel belongs to the caller, who may have built or damaged it by hand.
+static VBT__CONSTEXPR int vbt__relative_verify(const vbt_relative_t* rel) {
+  int depth = 0;
+  int stored = 0;
+
+  if (rel->fn <= VBT_COLOR_NONE || rel->fn > VBT_COLOR_OKLAB ||
+      rel->op_count > VBT__RELATIVE_MAX_OPS) {
+    return VBT_ERR;
+  }
+
+  for (int pc = 0; pc < rel->op_count; pc++) {
+    const int op = rel->ops[pc];
+
+    if (op > VBT__ROP_STORE || depth < vbt__rop_stack[op][0]) {
+      return VBT_ERR;
+    }
+
+    if (op == VBT__ROP_CONST || op == VBT__ROP_CHANNEL ||
+        op == VBT__ROP_STORE) {
+      const int limit = op == VBT__ROP_CONST ? VBT__RELATIVE_MAX_CONSTS : 4;
+
+      if (++pc == rel->op_count || rel->ops[pc] >= limit) {
+        return VBT_ERR;
+      }
+
+      stored |= op == VBT__ROP_STORE ? 1 << rel->ops[pc] : 0;
+    }
+
+    depth += vbt__rop_stack[op][1];
+
+    if (depth > VBT__CALC_MAX_STACK) {
+      return VBT_ERR;
+    }
+  }
+
+  return depth == 0 && stored == 0xf ? VBT_SUCCESS : VBT_ERR;
+}
+
+// runs the program of rel over count colors, from in[channel][i] to
+// out[channel][i]. each instruction runs over all of the colors, which is a
+// loop with no branches.
+static VBT__CONSTEXPR void vbt__relative_run(
+    const vbt_relative_t* rel,
+    vbt_number_t in[4][VBT__RELATIVE_CHUNK],
+    vbt_number_t out[4][VBT__RELATIVE_CHUNK],
+    vbt_size_t count) {
+  vbt_number_t stack[VBT__CALC_MAX_STACK][VBT__RELATIVE_CHUNK] = {0};
+  int top = 0;
+
+  for (int pc = 0; pc < rel->op_count; pc++) {
+    vbt_number_t* a = top > 0 ? stack[top - 1] : NULL;
+    const vbt_number_t* b = top > 0 ? stack[top - 1] : NULL;
+
+    switch (rel->ops[pc]) {
+      case VBT__ROP_CONST: {
+        const vbt_number_t k = rel->consts[rel->ops[++pc]];
+
+        a = stack[top++];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] = k;
+        }
+        break;
+      }
+      case VBT__ROP_CHANNEL: {
+        b = in[rel->ops[++pc]];
+        a = stack[top++];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] = b[i];
+        }
+        break;
+      }
+      case VBT__ROP_ADD: {
+        a = stack[--top - 1];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] += b[i];
+        }
+        break;
+      }
+      case VBT__ROP_SUB: {
+        a = stack[--top - 1];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] -= b[i];
+        }
+        break;
+      }
+      case VBT__ROP_MUL: {
+        a = stack[--top - 1];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] *= b[i];
+        }
+        break;
+      }
+      case VBT__ROP_DIV: {
+        a = stack[--top - 1];
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] /= b[i];
+        }
+        break;
+      }
+      case VBT__ROP_NEG: {
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] = -a[i];
+        }
+        break;
+      }
+      default: {
+        a = out[rel->ops[++pc]];
+        top--;
+
+        for (vbt_size_t i = 0; i < count; i++) {
+          a[i] = b[i];
+        }
+        break;
+      }
+    }
+  }
+}
+
+static VBT__CONSTEXPR int vbt__parse_css_color_name(const char* value,
+                                                    vbt_size_t len,
+                                                    vbt_color_t* color) {
+  if (len < VBT__COLOR_NAME_MIN_LEN || len > VBT__COLOR_NAME_MAX_LEN) {
+    return VBT_ERR;
+  }
+
+  const vbt__css_color_t* css_color = vbt__find_css_color(value, len);
+
+  if (css_color->name == NULL) {
+    return VBT_ERR;
+  }
+
+  if (color) {
+    vbt__color_init_rgba8(color, css_color->color[0], css_color->color[1],
+                          css_color->color[2], css_color->color[3]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+// clang-format off
+
+/* ANSI-C code produced by gperf version 3.1 */
+/* Command-line: gperf --constants-prefix=VBT__ --null-strings --hash-function-name=vbt__hash --lookup-function-name=vbt__in_word_set --ignore-case -l -t -T css_color_names.gperf  */
+/* Computed positions: -k'1,3,6-8,12-13' */
+/* maximum key range = 557, duplicates = 0 */
+
+static VBT__CONSTEXPR const unsigned short vbt__css_color_asso_values[] = {
+  VBT__CSS_COLOR_ASSO_VALUES
+};
+
+static VBT__CONSTEXPR const unsigned char vbt__css_color_lengths[] = {
+  VBT__CSS_COLOR_LENGTHS
+};
+
+static VBT__CONSTEXPR const vbt__css_color_t vbt__css_colors[] = {
+  VBT__CSS_COLOR_WORDLIST(VBT__CSS_COLOR, VBT__CSS_COLOR_EMPTY)
+};
+
+static VBT__CONSTEXPR const vbt__css_color_t vbt__css_color_empty = VBT__CSS_COLOR_EMPTY;
+
+static VBT__CONSTEXPR vbt_size_t vbt__hash (const char *str, size_t len) {
+  const unsigned short* asso_values = vbt__css_color_asso_values;
+  vbt_size_t hval = len;
+
+  switch (hval) {
+    default:
+      hval += asso_values[(unsigned char)str[12]];
+    /*FALLTHROUGH*/
+    case 12:
+      hval += asso_values[(unsigned char)str[11]];
+    /*FALLTHROUGH*/
+    case 11:
+    case 10:
+    case 9:
+    case 8:
+      hval += asso_values[(unsigned char)str[7]];
+    /*FALLTHROUGH*/
+    case 7:
+      hval += asso_values[(unsigned char)str[6]];
+    /*FALLTHROUGH*/
+    case 6:
+      hval += asso_values[(unsigned char)str[5]];
+    /*FALLTHROUGH*/
+    case 5:
+    case 4:
+    case 3:
+      hval += asso_values[(unsigned char)str[2]+2];
+    /*FALLTHROUGH*/
+    case 2:
+    case 1:
+      hval += asso_values[(unsigned char)str[0]];
+      break;
+  }
+
+  return hval;
+}
+
+static VBT__CONSTEXPR const vbt__css_color_t* vbt__find_css_color(
+    const char* value,
+    vbt_size_t len) {
+  const unsigned char* lengthtable = vbt__css_color_lengths;
+  const vbt__css_color_t* wordlist = vbt__css_colors;
+
+  // from gperf generated macros
+  const vbt_size_t VBT__MIN_WORD_LENGTH = 3;
+  const vbt_size_t VBT__MAX_WORD_LENGTH = 20;
+  const vbt_size_t VBT__MAX_HASH_VALUE = 560;
+
+  if (len <= VBT__MAX_WORD_LENGTH && len >= VBT__MIN_WORD_LENGTH) {
+    vbt_size_t key = vbt__hash (value, len);
+
+    if (key <= VBT__MAX_HASH_VALUE && len == lengthtable[key] && vbt__casecmp(value, wordlist[key].name, len) == 0) {
+      return &wordlist[key];
+    }
+  }
+
+  return &vbt__css_color_empty;
+}
+// clang-format on
+
+#endif  // VIBRANT_NO_PARSE
+#ifdef VIBRANT_DETERMINISTIC
+#if defined(__clang__) || defined(_MSC_VER)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif  // VIBRANT_DETERMINISTIC
+
+// C++14 compile time parsing, see vbt::parse()
+#ifdef VBT__CONSTEXPR_CORE
+
+#if defined(__cpp_consteval)
+#define VBT__CONSTEVAL consteval
+#else
+#define VBT__CONSTEVAL constexpr
+#endif
+
+namespace vbt {
+
+namespace detail {
+
+// Not defined. The value forms of vbt::parse() and vbt::relative() call it
+// for an invalid color, so that it fails to compile in a constant
+// expression, and always outside of one, so that they fail to link there.
+void constant_color_required() noexcept;
+
+// length of the string in a char array, up to its first NUL
+template <vbt_size_t N>
+constexpr vbt_size_t array_len(const char (&value)[N]) noexcept {
+  vbt_size_t len = 0;
+
+  while (len < N && value[len] != '\0') {
+    len++;
+  }
+
+  return len;
+}
+
+// the sRGB color of a parsed color, as vbt_color_resolve() sets it as u8
+constexpr int color_rgba8(const vbt_color_t& color, rgba8& out) noexcept {
+  vbt_u8_t u8[4] = {0, 0, 0, 0};
+  vbt_number_t n[4] = {0, 0, 0, 0};
+  int resolved = color.resolved;
+
+  if (resolved == VBT__RESOLVED_U8) {
+    for (int i = 0; i < 4; i++) {
+      u8[i] = color.srgb.u8[i];
+    }
+  } else {
+    resolved = vbt__color_kernel(color.fn, color.arg, u8, n);
+  }
+
+  if (resolved == VBT__RESOLVED_NONE) {
+    return VBT_ERR;
+  }
+
+  for (int i = 0; resolved == VBT__RESOLVED_01 && i < 4; i++) {
+    u8[i] = vbt__unit_to_u8(n[i]);
+  }
+
+  out.r = u8[0];
+  out.g = u8[1];
+  out.b = u8[2];
+  out.a = u8[3];
+  return VBT_SUCCESS;
+}
+
+// vbt::relative() outside of a constant expression
+inline int relative_resolve(const char* value,
+                            vbt_size_t len,
+                            const char* origin,
+                            vbt_size_t origin_len,
+                            rgba8& out) noexcept {
+  vbt_relative_t rel;
+  vbt_color_t from;
+  vbt_color_t color;
+
+  if (vbt_relative_compile(value, len, &rel) != VBT_SUCCESS ||
+      vbt_parse_color(origin, origin_len, &from) != VBT_SUCCESS ||
+      vbt_relative_apply(&rel, &from, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return color_resolve(color, out);
+}
+
+}  // namespace detail
+
+// Same as vbt::parse() with any other Format, but constexpr. In a constant
+// expression, the parser and conversions of vbt_parse() are compiled into
+// the including file, with its configuration, and math.h is replaced by
+// the functions of VIBRANT_DETERMINISTIC, so a component can differ by one
+// from vbt_parse() in rare cases. Outside of one, it calls vbt_parse_color()
+// of the implementation, like the other formats. Compilers that can't tell
+// the two apart (before GCC 9, Clang 9 and MSVC 19.25) always run the
+// compiled core.
+//
+// @param out
+// @returns VBT_SUCCESS: color successfully parsed and set in out
+//          VBT_ERR: error parsing string or invalid arguments
+constexpr int parse(const char* value, vbt_size_t len, rgba8& out) noexcept {
+  vbt_color_t color{};
+
+  if (!vbt__constant_evaluated()) {
+    return parse<rgba8>(value, len, out);
+  }
+
+  if (vbt__parse(value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return detail::color_rgba8(color, out);
+}
+
+// Parses the string in a char array, up to its first NUL, see
+// parse(const char*, vbt_size_t, rgba8&).
+//
+// char buf[32];
+// vbt::rgba8 c;
+// if (vbt::parse(buf, c) != VBT_SUCCESS) { ... }
+template <vbt_size_t N>
+constexpr int parse(const char (&value)[N], rgba8& out) noexcept {
+  return parse(value, detail::array_len(value), out);
+}
+
+// Parses a color string that is known to be valid, in a constant
+// expression. An invalid color fails to compile. It is consteval in C++20,
+// and before, it fails to link when it is called outside of a constant
+// expression. Use parse(value, len, out) for strings that may be invalid.
+//
+// constexpr vbt::rgba8 c = vbt::parse("oklch(70% 0.1 200)");
+//
+// @param value the color string
+// @param len the length of value
+// @returns the color
+VBT__CONSTEVAL rgba8 parse(const char* value, vbt_size_t len) noexcept {
+  rgba8 color{0, 0, 0, 0};
+
+  if (!vbt__constant_evaluated() || parse(value, len, color) != VBT_SUCCESS) {
+    detail::constant_color_required();
+  }
+
+  return color;
+}
+
+// Parses a string literal, see parse(const char*, vbt_size_t).
+template <vbt_size_t N>
+VBT__CONSTEVAL rgba8 parse(const char (&value)[N]) noexcept {
+  return parse(value, detail::array_len(value));
+}
+
+// Applies a relative color to origin, like vbt_relative_compile() and
+// vbt_relative_apply(). origin is a color string. Like
+// parse(const char*, vbt_size_t, rgba8&), it is compiled into the including
+// file in a constant expression, and calls the implementation outside of
+// one.
+//
+// @param out
+// @returns VBT_SUCCESS: color successfully set in out
+//          VBT_ERR: error parsing value or origin, or invalid arguments
+constexpr int relative(const char* value,
+                       vbt_size_t len,
+                       const char* origin,
+                       vbt_size_t origin_len,
+                       rgba8& out) noexcept {
+  vbt_relative_t rel{};
+  vbt_color_t from{};
+  vbt_color_t color{};
+  int err = VBT_SUCCESS;
+
+  if (!vbt__constant_evaluated()) {
+    return detail::relative_resolve(value, len, origin, origin_len, out);
+  }
+
+  if (vbt__relative_compile(value, len, &rel) != VBT_SUCCESS ||
+      vbt__parse(origin, origin_len, &from) != VBT_SUCCESS ||
+      vbt__relative_apply_chunk(&rel, &from, 1, &color, &err) !=
+          VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return detail::color_rgba8(color, out);
+}
+
+// Applies a relative color literal to an origin literal that are known to
+// be valid, in a constant expression, see parse(const char*, vbt_size_t).
+//
+// constexpr vbt::rgba8 c =
+//     vbt::relative("oklch(from var l c calc(h + 180))", "teal");
+//
+// @returns the color
+template <vbt_size_t N, vbt_size_t M>
+VBT__CONSTEVAL rgba8 relative(const char (&value)[N],
+                              const char (&origin)[M]) noexcept {
+  rgba8 color{0, 0, 0, 0};
+
+  if (!vbt__constant_evaluated() ||
+      relative(value, detail::array_len(value), origin,
+               detail::array_len(origin), color) != VBT_SUCCESS) {
+    detail::constant_color_required();
+  }
+
+  return color;
+}
+
+namespace literals {
+
+// "cornflowerblue"_vbt is vbt::parse("cornflowerblue"), see
+// parse(const char*, vbt_size_t).
+VBT__CONSTEVAL rgba8 operator""_vbt(const char* value,
+                                    vbt_size_t len) noexcept {
+  return vbt::parse(value, len);
+}
+
+}  // namespace literals
+
+}  // namespace vbt
+
+#endif  // VBT__CONSTEXPR_CORE
+
+#endif  // VBT__CORE
+
+#ifdef VIBRANT_IMPLEMENTATION
+
+#ifdef __cplusplus
+#include <cstring>  // memcpy
+#else
+#include <string.h>  // memcpy
+#endif
+
+#ifdef VIBRANT_DETERMINISTIC
+#if defined(__clang__) || defined(_MSC_VER)
+#pragma float_control(precise, on, push)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math", "fp-contract=off")
+#endif
+#endif  // VIBRANT_DETERMINISTIC
+
+// clang-format off
+static int vbt__write_u8(vbt_recv_t* recv, vbt_u8_t r, vbt_u8_t g, vbt_u8_t b, vbt_u8_t a);
+static int vbt__write_01(vbt_recv_t* recv, vbt_number_t r, vbt_number_t g, vbt_number_t b, vbt_number_t a);
+static int vbt__color_eval(vbt_color_t* color);
+VBT__FORCEINLINE static vbt_bool_t vbt__color_in_gamut(vbt_color_fn_t fn, const vbt_number_t* arg, vbt_number_t s, vbt_number_t c);
+VBT__FORCEINLINE static vbt_number_t vbt__delta_e_76(const vbt_number_t* x, const vbt_number_t* y);
+VBT__FORCEINLINE static vbt_number_t vbt__delta_e_2000(const vbt_number_t* x, const vbt_number_t* y);
+VBT__FORCEINLINE static void vbt__delta_e_loop(vbt_delta_e_t metric, const vbt_number_t* x, vbt_size_t x_stride, const vbt_number_t* y, vbt_size_t count, vbt_number_t* out);
+VBT__FORCEINLINE static void vbt__sincos_vec(vbt_number_t rad, vbt_number_t* s, vbt_number_t* c);
+VBT__FORCEINLINE static void vbt__sincos_chunk(const vbt_number_t* angle, vbt_size_t stride, vbt_size_t n, vbt_number_t* s, vbt_number_t* c);
+static void vbt__interpolate_segment(vbt_space_t space, int premultiplied, vbt_bool_t linear, const vbt_number_t* start, const vbt_number_t* step, vbt_size_t count, vbt_number_t* out);
+VBT__FORCEINLINE static void vbt__interpolate_color(vbt_space_t space, int premultiplied, vbt_bool_t linear, const vbt_number_t* start, const vbt_number_t* step, vbt_size_t i, vbt_number_t s, vbt_number_t c, vbt_number_t* out);
+VBT__FORCEINLINE static void vbt__interpolate_loop(vbt_space_t space, int premultiplied, vbt_bool_t linear, const vbt_number_t* start, const vbt_number_t* step, vbt_size_t count, vbt_number_t* out);
+static vbt_size_t vbt__texel_index(vbt_number_t position, vbt_size_t width);
+static void vbt__bake_segment(vbt_space_t space, vbt_texel_format_t format, int dither, const vbt_number_t* start, const vbt_number_t* step, vbt_size_t begin, vbt_size_t end, void* texels);
+static void vbt__pack_texels(vbt_texel_format_t format, int dither, const vbt_number_t* rgba, vbt_size_t first, vbt_size_t count, void* texels);
+VBT__FORCEINLINE static vbt_u16_t vbt__unit_to_half(float x);
+// clang-format on
+
+VBTDEF int vbt_rgb(vbt_u8_t red,
+                   vbt_u8_t green,
+                   vbt_u8_t blue,
+                   vbt_number_t alpha,
+                   vbt_recv_t* recv) {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_RGB, red, green, blue, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_hsl(vbt_number_t hue,
+                   vbt_number_t saturation,
+                   vbt_number_t lightness,
+                   vbt_number_t alpha,
+                   vbt_recv_t* recv) {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_HSL, hue, saturation, lightness, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_hwb(vbt_number_t hue,
+                   vbt_number_t whiteness,
+                   vbt_number_t blackness,
+                   vbt_number_t alpha,
+                   vbt_recv_t* recv) {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_HWB, hue, whiteness, blackness, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_lch(vbt_number_t lightness,
+                   vbt_number_t chroma,
+                   vbt_number_t hue,
+                   vbt_number_t alpha,
+                   vbt_recv_t* recv) {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_LCH, lightness, chroma, hue, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_lab(vbt_number_t lightness,
+                   vbt_number_t a,
+                   vbt_number_t b,
+                   vbt_number_t alpha,
+                   vbt_recv_t* recv) {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_LAB, lightness, a, b, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_oklch(vbt_number_t lightness,
+                     vbt_number_t chroma,
+                     vbt_number_t hue,
+                     vbt_number_t alpha,
+                     vbt_recv_t* recv) {
+  vbt_color_t color =
+      vbt_color_init(VBT_COLOR_OKLCH, lightness, chroma, hue, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_oklab(vbt_number_t lightness,
+                     vbt_number_t a,
+                     vbt_number_t b,
+                     vbt_number_t alpha,
+                     vbt_recv_t* recv) {
+  vbt_color_t color = vbt_color_init(VBT_COLOR_OKLAB, lightness, a, b, alpha);
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_color_resolve(vbt_color_t* color, vbt_recv_t* recv) {
+  if (!recv || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  if (color->resolved == VBT__RESOLVED_U8) {
+    const vbt_u8_t* rgba = color->srgb.u8;
+    return vbt__write_u8(recv, rgba[0], rgba[1], rgba[2], rgba[3]);
+  }
+
+  const vbt_number_t* rgba = color->srgb.n;
+  return vbt__write_01(recv, rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+VBTDEF int vbt_color_eval(vbt_color_t* color) {
+  if (!color) {
+    return VBT_ERR;
+  }
+
+  return vbt__color_eval(color);
+}
+
+// convert color to sRGB and memoize the result in color->srgb, see
+// vbt__color_kernel()
+static int vbt__color_eval(vbt_color_t* color) {
+  if (color->resolved != VBT__RESOLVED_NONE) {
+    return VBT_SUCCESS;
+  }
+
+  color->resolved = vbt__color_kernel(color->fn, color->arg, color->srgb.u8,
+                                      color->srgb.n);
+
+  return color->resolved == VBT__RESOLVED_NONE ? VBT_ERR : VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_hsl(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_hsl(rgba, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_hwb(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_hwb(rgba, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_lab(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_lab(rgba, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_lch(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_lch(rgba, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_oklab(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_oklab(rgba, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_oklch(vbt_color_t* color, vbt_number_t* out) {
+  vbt_number_t rgba[4];
+
+  if (!out || vbt_color_eval(color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__color_srgb(color, rgba);
+  vbt__srgb_to_oklch(rgba, out);
+  return VBT_SUCCESS;
+}
+
+// the batch loops call the kernels directly, so that they are inlined and
+// the loops can be vectorized
+VBTDEF int vbt_to_hsl_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_hsl(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_hwb_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_hwb(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_lab_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_lab(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_lch_batch(const vbt_number_t* rgba,
+                            vbt_size_t count,
+                            vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_lch(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_oklab_batch(const vbt_number_t* rgba,
+                              vbt_size_t count,
+                              vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_oklab(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_to_oklch_batch(const vbt_number_t* rgba,
+                              vbt_size_t count,
+                              vbt_number_t* out) {
+  if (count > 0 && (!rgba || !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i++) {
+    vbt__srgb_to_oklch(&rgba[i * 4], &out[i * 4]);
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_in_gamut_batch(vbt_color_fn_t fn,
+                              const vbt_number_t* args,
+                              vbt_size_t count,
+                              vbt_u8_t* mask) {
+  if ((count > 0 && (!args || !mask)) ||
+      (fn != VBT_COLOR_LAB && fn != VBT_COLOR_LCH && fn != VBT_COLOR_OKLAB &&
+       fn != VBT_COLOR_OKLCH)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < count; i += VBT__HUE_CHUNK) {
+    const vbt_size_t n =
+        count - i < VBT__HUE_CHUNK ? count - i : VBT__HUE_CHUNK;
+    vbt_number_t s[VBT__HUE_CHUNK] = {0};
+    vbt_number_t c[VBT__HUE_CHUNK] = {0};
+    vbt_u8_t in[VBT__HUE_CHUNK];
+
+    if (fn == VBT_COLOR_LCH || fn == VBT_COLOR_OKLCH) {
+      vbt__sincos_chunk(&args[i * 4 + 2], 4, n, s, c);
+    }
+
+    for (vbt_size_t j = 0; j < n; j++) {
+      in[j] = (vbt_u8_t)vbt__color_in_gamut(fn, &args[(i + j) * 4], s[j],
+                                            c[j]);
+    }
+
+    for (vbt_size_t j = 0; j < n; j += 8) {
+      unsigned bits = 0;
+
+      for (vbt_size_t k = 0; k < 8 && j + k < n; k++) {
+        bits |= (unsigned)in[j + k] << k;
+      }
+
+      mask[(i + j) / 8] = (vbt_u8_t)bits;
+    }
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_delta_e(vbt_delta_e_t metric,
+                       vbt_color_t* a,
+                       vbt_color_t* b,
+                       vbt_number_t* out) {
+  int (*to_space)(vbt_color_t*, vbt_number_t*) =
+      metric == VBT_DELTA_E_OK ? vbt_to_oklab : vbt_to_lab;
+  vbt_number_t x[4];
+  vbt_number_t y[4];
+
+  if (!out || (unsigned)metric > VBT_DELTA_E_OK ||
+      to_space(a, x) != VBT_SUCCESS || to_space(b, y) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  vbt__delta_e_loop(metric, x, 0, y, 1, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_delta_e_batch(vbt_delta_e_t metric,
+                             const vbt_number_t* x,
+                             const vbt_number_t* y,
+                             vbt_size_t count,
+                             vbt_number_t* out) {
+  if ((count > 0 && (!x || !y || !out)) ||
+      (unsigned)metric > VBT_DELTA_E_OK) {
+    return VBT_ERR;
+  }
+
+  vbt__delta_e_loop(metric, x, 4, y, count, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_delta_e_ref_batch(vbt_delta_e_t metric,
+                                 const vbt_number_t* ref,
+                                 const vbt_number_t* y,
+                                 vbt_size_t count,
+                                 vbt_number_t* out) {
+  if ((count > 0 && (!ref || !y || !out)) ||
+      (unsigned)metric > VBT_DELTA_E_OK) {
+    return VBT_ERR;
+  }
+
+  vbt__delta_e_loop(metric, ref, 0, y, count, out);
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_interpolate_n(vbt_space_t space,
+                             vbt_hue_method_t hue,
+                             int premultiplied,
+                             vbt_color_t* stops,
+                             vbt_size_t stop_count,
+                             vbt_size_t count,
+                             vbt_number_t* out) {
+  const vbt_size_t segments = stop_count - 1;
+  const vbt_size_t last = count - 1;
+  const vbt_number_t inv_last = count > 1 ? (vbt_number_t)1 / last : 0;
+  vbt_number_t next[4];
+  vbt_size_t begin = 0;
+
+  if ((unsigned)space > VBT_SPACE_OKLCH ||
+      (unsigned)hue > VBT_HUE_DECREASING || !stops || stop_count < 2 ||
+      (count > 0 && !out)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t k = 0; k < stop_count; k++) {
+    if (vbt_color_eval(&stops[k]) != VBT_SUCCESS) {
+      return VBT_ERR;
+    }
+  }
+
+  vbt__interpolation_stop(space, &stops[0], next);
+
+  for (vbt_size_t k = 0; k < segments; k++) {
+    // colors [begin, end) are on the segment from stop k to k + 1, at
+    // i * segments / last - k. a single color is the first stop.
+    const vbt_size_t end = k + 1 == segments || count < 2
+                               ? count
+                               : ((k + 1) * last + segments - 1) / segments;
+    const vbt_number_t t0 =
+        (vbt_number_t)(begin * segments - k * last) * inv_last;
+    const vbt_number_t dt = (vbt_number_t)segments * inv_last;
+    vbt_number_t a[4];
+    vbt_number_t start[4];
+    vbt_number_t step[4];
+
+    for (int i = 0; i < 4; i++) {
+      a[i] = next[i];
+    }
+
+    vbt__interpolation_stop(space, &stops[k + 1], next);
+
+    if (end > begin) {
+      vbt__interpolation_steps(space, hue, premultiplied, a, next, t0, dt,
+                               start, step);
+      vbt__interpolate_segment(space, premultiplied, VBT__FALSE, start, step,
+                               end - begin, &out[begin * 4]);
+      begin = end;
+    }
+  }
+
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_gradient_bake(vbt_space_t space,
+                             vbt_hue_method_t hue,
+                             vbt_gradient_stop_t* stops,
+                             vbt_size_t stop_count,
+                             vbt_texel_format_t format,
+                             int dither,
+                             vbt_size_t width,
+                             void* texels) {
+  const vbt_number_t inv_width = width > 0 ? (vbt_number_t)1 / width : 0;
+  vbt_number_t position = 0;
+  vbt_number_t next[4];
+  vbt_size_t begin = 0;
+
+  if ((unsigned)space > VBT_SPACE_OKLCH ||
+      (unsigned)hue > VBT_HUE_DECREASING ||
+      (unsigned)format > VBT_TEXEL_RGBA32F || !stops || stop_count < 1 ||
+      (width > 0 && !texels)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t k = 0; k < stop_count; k++) {
+    if (vbt_color_eval(&stops[k].color) != VBT_SUCCESS ||
+        !vbt__isfinite(stops[k].position)) {
+      return VBT_ERR;
+    }
+  }
+
+  vbt__interpolation_stop(space, &stops[0].color, next);
+
+  // segment k is from stop k - 1 to k. the segments before the first stop
+  // and after the last are the color of that stop.
+  for (vbt_size_t k = 0; k <= stop_count; k++) {
+    const vbt_bool_t between = k > 0 && k < stop_count;
+    const vbt_number_t from = position;
+    vbt_size_t end = width;
+    vbt_number_t a[4];
+    vbt_number_t start[4];
+    vbt_number_t step[4];
+    vbt_number_t t0 = 0;
+    vbt_number_t dt = 0;
+
+    for (int i = 0; i < 4; i++) {
+      a[i] = next[i];
+    }
+
+    if (k < stop_count) {
+      position = k == 0 || stops[k].position > position ? stops[k].position
+                                                        : position;
+      end = vbt__texel_index(position, width);
+    }
+
+    if (between) {
+      vbt__interpolation_stop(space, &stops[k].color, next);
+    }
+
+    if (end <= begin) {
+      continue;
+    }
+
+    // the texels of a segment are centered in [from, position), which is
+    // therefore not empty
+    if (between) {
+      const vbt_number_t length = position - from;
+
+      t0 = (((vbt_number_t)begin + (vbt_number_t)0.5) * inv_width - from) /
+           length;
+      dt = inv_width / length;
+    }
+
+    vbt__interpolation_steps(space, hue, VBT__TRUE, a, next, t0, dt, start,
+                             step);
+    vbt__bake_segment(space, format, dither, start, step, begin, end,
+                      texels);
+    begin = end;
+  }
+
+  return VBT_SUCCESS;
+}
+
+// fn is VBT_COLOR_LAB, VBT_COLOR_LCH, VBT_COLOR_OKLAB or VBT_COLOR_OKLCH.
+// in gamut when the conversion to sRGB would not clamp. s and c are the sin
+// and cos of the hue, for VBT_COLOR_LCH and VBT_COLOR_OKLCH.
+VBT__FORCEINLINE static vbt_bool_t vbt__color_in_gamut(vbt_color_fn_t fn,
+                                                       const vbt_number_t* arg,
+                                                       vbt_number_t s,
+                                                       vbt_number_t c) {
+  const vbt_number_t lightness = VBT__CLAMP_0100(arg[0]);
+  vbt_number_t a = arg[1];
+  vbt_number_t b = arg[2];
+  vbt_number_t lin[3];
+
+  if (!vbt__isfinite(arg[0]) || !vbt__isfinite(arg[1]) ||
+      !vbt__isfinite(arg[2])) {
+    return VBT__FALSE;
+  }
+
+  if (fn == VBT_COLOR_LCH || fn == VBT_COLOR_OKLCH) {
+    a = arg[1] * c;
+    b = arg[1] * s;
+  }
+
+  if (fn == VBT_COLOR_LAB || fn == VBT_COLOR_LCH) {
+    vbt__lab_to_linear(lightness, a, b, lin);
+  } else {
+    vbt__oklab_to_linear(lightness, a, b, lin);
+  }
+
+  return vbt__in_gamut(lin);
+}
+
+// Euclidean distance, which is deltaE 76 in Lab and deltaE OK in Oklab
+VBT__FORCEINLINE static vbt_number_t vbt__delta_e_76(const vbt_number_t* x,
+                                                     const vbt_number_t* y) {
+  const vbt_number_t dl = y[0] - x[0];
+  const vbt_number_t da = y[1] - x[1];
+  const vbt_number_t db = y[2] - x[2];
+
+  return vbt__sqrt(dl * dl + da * da + db * db);
+}
+
+// CIEDE2000, as written in "The CIEDE2000 Color-Difference Formula:
+// Implementation Notes, Supplementary Test Data, and Mathematical
+// Observations" by Sharma, Wu and Dalal. The hue cases are selects, and the
+// cosines of T are expanded from a single sin and cos of the mean hue.
+VBT__FORCEINLINE static vbt_number_t vbt__delta_e_2000(const vbt_number_t* x,
+                                                       const vbt_number_t* y) {
+  const vbt_number_t rad = VBT__PI / (vbt_number_t)180.0;
+  const vbt_number_t pow25_7 = (vbt_number_t)6103515625.0;
+  vbt_number_t c_mean, c7, g, a1, a2, c1, c2, h1, h2, cc;
+  vbt_number_t dl, dc, dh, dhh, l50, h_mean, s, c, cos2, sin2, t, dt;
+  vbt_number_t rt, sl, sc, sh;
+
+  // a' = a (1 + G)
+  c_mean = (vbt__sqrt(x[1] * x[1] + x[2] * x[2]) +
+            vbt__sqrt(y[1] * y[1] + y[2] * y[2])) *
+           (vbt_number_t)0.5;
+  c7 = c_mean * c_mean * c_mean;
+  c7 = c7 * c7 * c_mean;
+  g = (vbt_number_t)1.5 - (vbt_number_t)0.5 * vbt__sqrt(c7 / (c7 + pow25_7));
+  a1 = x[1] * g;
+  a2 = y[1] * g;
+
+  // C' and h' in [0-360), h' is 0 when C' is
+  c1 = vbt__sqrt(a1 * a1 + x[2] * x[2]);
+  c2 = vbt__sqrt(a2 * a2 + y[2] * y[2]);
+  h1 = vbt__atan2(x[2], a1) / rad;
+  h2 = vbt__atan2(y[2], a2) / rad;
+  h1 = c1 > 0 ? h1 + (h1 < 0 ? (vbt_number_t)360.0 : 0) : 0;
+  h2 = c2 > 0 ? h2 + (h2 < 0 ? (vbt_number_t)360.0 : 0) : 0;
+  cc = c1 * c2;
+
+  // mean h', across 0 when the hues are more than 180 apart
+  dh = h2 - h1;
+  h_mean = h1 + h2;
+  h_mean += dh > (vbt_number_t)180.0 || dh < (vbt_number_t)-180.0
+                ? (h_mean < (vbt_number_t)360.0 ? (vbt_number_t)360.0
+                                                : (vbt_number_t)-360.0)
+                : 0;
+  h_mean = cc > 0 ? h_mean * (vbt_number_t)0.5 : h1 + h2;
+
+  // delta L', C' and H'. dH' is 0 when either C' is, through sqrt(C1 C2)
+  dl = y[0] - x[0];
+  dc = c2 - c1;
+  dh += dh > (vbt_number_t)180.0 ? (vbt_number_t)-360.0 : 0;
+  dh += dh < (vbt_number_t)-180.0 ? (vbt_number_t)360.0 : 0;
+  dhh = 2 * vbt__sqrt(cc) * vbt__sin(dh * rad * (vbt_number_t)0.5);
+
+  // T = 1 - 0.17 cos(h - 30) + 0.24 cos(2h) + 0.32 cos(3h + 6)
+  //       - 0.20 cos(4h - 63)
+  vbt__sincos_vec(h_mean * rad, &s, &c);
+  cos2 = 2 * c * c - 1;
+  sin2 = 2 * s * c;
+  t = 1 - (vbt_number_t)0.147224318643 * c - (vbt_number_t)0.085 * s +
+      (vbt_number_t)0.24 * cos2 +
+      (vbt_number_t)0.318247006518 * c * (4 * c * c - 3) -
+      (vbt_number_t)0.033449108246 * s * (3 - 4 * s * s) -
+      (vbt_number_t)0.090798099948 * (2 * cos2 * cos2 - 1) -
+      (vbt_number_t)0.178201304838 * 2 * sin2 * cos2;
+
+  // R_T, from the mean C'
+  c_mean = (c1 + c2) * (vbt_number_t)0.5;
+  c7 = c_mean * c_mean * c_mean;
+  c7 = c7 * c7 * c_mean;
+  dt = (h_mean - (vbt_number_t)275.0) / (vbt_number_t)25.0;
+  dt = (vbt_number_t)30.0 * vbt__exp(-dt * dt);
+  rt = -2 * vbt__sqrt(c7 / (c7 + pow25_7)) * vbt__sin(2 * dt * rad);
+
+  l50 = (x[0] + y[0]) * (vbt_number_t)0.5 - (vbt_number_t)50.0;
+  l50 *= l50;
+  sl = 1 + (vbt_number_t)0.015 * l50 / vbt__sqrt((vbt_number_t)20.0 + l50);
+  sc = 1 + (vbt_number_t)0.045 * c_mean;
+  sh = 1 + (vbt_number_t)0.015 * c_mean * t;
+
+  dl /= sl;
+  dc /= sc;
+  dhh /= sh;
+  return vbt__sqrt(dl * dl + dc * dc + dhh * dhh + rt * dc * dhh);
+}
+
+// x advances by x_stride numbers per color, 0 to compare every y to x.
+// forced inline, so that the stride is a constant in each caller, and the
+// metric branches outside of the loops.
+VBT__FORCEINLINE static void vbt__delta_e_loop(vbt_delta_e_t metric,
+                                               const vbt_number_t* x,
+                                               vbt_size_t x_stride,
+                                               const vbt_number_t* y,
+                                               vbt_size_t count,
+                                               vbt_number_t* out) {
+  if (metric == VBT_DELTA_E_2000) {
+    for (vbt_size_t i = 0; i < count; i++) {
+      out[i] = vbt__delta_e_2000(&x[i * x_stride], &y[i * 4]);
+    }
+  } else {
+    for (vbt_size_t i = 0; i < count; i++) {
+      out[i] = vbt__delta_e_76(&x[i * x_stride], &y[i * 4]);
+    }
+  }
+}
+
+// sin and cos of an angle in radians, for formulas that are not a color
+// conversion, which uses vbt__sincos_deg(). the cos is sin(rad + 90), as gcc
+// would merge a cos with the sin into a sincos, which has no vector version
+VBT__FORCEINLINE static void vbt__sincos_vec(vbt_number_t rad,
+                                             vbt_number_t* s,
+                                             vbt_number_t* c) {
+  *s = vbt__sin(rad);
+  *c = vbt__sin(rad + VBT__PI * (vbt_number_t)0.5);
+}
+
+// vbt__sincos_deg() of up to VBT__HUE_CHUNK angles, every stride numbers
+// apart. all of them go through vbt__sincos_quadrant(), which vectorizes,
+// then the integer angles are looked up in the table instead
+VBT__FORCEINLINE static void vbt__sincos_chunk(const vbt_number_t* angle,
+                                               vbt_size_t stride,
+                                               vbt_size_t n,
+                                               vbt_number_t* s,
+                                               vbt_number_t* c) {
+  for (vbt_size_t j = 0; j < n; j++) {
+    vbt__sincos_quadrant(vbt__normalize_angle(angle[j * stride]), &s[j],
+                         &c[j]);
+  }
+
+  // the reduction of vbt__normalize_angle() keeps integers integers
+  for (vbt_size_t j = 0; j < n; j++) {
+    if (vbt__floor(angle[j * stride]) == angle[j * stride]) {
+      vbt__sincos_table((int)vbt__normalize_angle(angle[j * stride]), &s[j],
+                        &c[j]);
+    }
+  }
+}
+
+// a loop per space, each with the space as a constant
+static void vbt__interpolate_segment(vbt_space_t space,
+                                     int premultiplied,
+                                     vbt_bool_t linear,
+                                     const vbt_number_t* start,
+                                     const vbt_number_t* step,
+                                     vbt_size_t count,
+                                     vbt_number_t* out) {
+  switch (space) {
+    case VBT_SPACE_SRGB: {
+      vbt__interpolate_loop(VBT_SPACE_SRGB, premultiplied, linear, start, step,
+                            count, out);
+      break;
+    }
+    case VBT_SPACE_SRGB_LINEAR: {
+      vbt__interpolate_loop(VBT_SPACE_SRGB_LINEAR, premultiplied, linear, start,
+                            step, count, out);
+      break;
+    }
+    case VBT_SPACE_LAB: {
+      vbt__interpolate_loop(VBT_SPACE_LAB, premultiplied, linear, start, step,
+                            count, out);
+      break;
+    }
+    case VBT_SPACE_LCH: {
+      vbt__interpolate_loop(VBT_SPACE_LCH, premultiplied, linear, start, step,
+                            count, out);
+      break;
+    }
+    case VBT_SPACE_OKLAB: {
+      vbt__interpolate_loop(VBT_SPACE_OKLAB, premultiplied, linear, start, step,
+                            count, out);
+      break;
+    }
+    default: {
+      vbt__interpolate_loop(VBT_SPACE_OKLCH, premultiplied, linear, start, step,
+                            count, out);
+      break;
+    }
+  }
+}
+
+// color i is start + i * step, un-premultiplied and converted to sRGB like
+// vbt_color_eval() does, or to linear-light sRGB. s and c are the sin and
+// cos of its hue, for VBT_SPACE_LCH and VBT_SPACE_OKLCH.
+VBT__FORCEINLINE static void vbt__interpolate_color(vbt_space_t space,
+                                                    int premultiplied,
+                                                    vbt_bool_t linear,
+                                                    const vbt_number_t* start,
+                                                    const vbt_number_t* step,
+                                                    vbt_size_t i,
+                                                    vbt_number_t s,
+                                                    vbt_number_t c,
+                                                    vbt_number_t* out) {
+  const vbt_bool_t polar = space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH;
+  const vbt_number_t t = (vbt_number_t)i;
+  vbt_number_t* rgba = &out[i * 4];
+  vbt_number_t v[4];
+  vbt_number_t lin[3];
+  vbt_number_t w;
+
+  for (int j = 0; j < 4; j++) {
+    v[j] = start[j] + t * step[j];
+  }
+
+  // un-premultiply, and a transparent color is all 0
+  w = premultiplied ? v[3] : 1;
+  w = w > 0 ? 1 / w : 0;
+  v[0] *= w;
+  v[1] *= w;
+  v[2] *= polar ? 1 : w;
+
+  if (polar) {
+    v[2] = v[1] * s;
+    v[1] *= c;
+  }
+
+  if (space == VBT_SPACE_SRGB && linear) {
+    rgba[0] = vbt__srgb_to_linear(VBT__CLAMP_01(v[0]));
+    rgba[1] = vbt__srgb_to_linear(VBT__CLAMP_01(v[1]));
+    rgba[2] = vbt__srgb_to_linear(VBT__CLAMP_01(v[2]));
+  } else if (space == VBT_SPACE_SRGB) {
+    rgba[0] = VBT__CLAMP_01(v[0]);
+    rgba[1] = VBT__CLAMP_01(v[1]);
+    rgba[2] = VBT__CLAMP_01(v[2]);
+  } else {
+    if (space == VBT_SPACE_SRGB_LINEAR) {
+      lin[0] = v[0];
+      lin[1] = v[1];
+      lin[2] = v[2];
+    } else if (space == VBT_SPACE_LAB || space == VBT_SPACE_LCH) {
+      v[0] = VBT__CLAMP_0100(v[0]);
+      vbt__lab_to_linear(v[0], v[1], v[2], lin);
+#ifdef VIBRANT_GAMUT_MAP
+      vbt__gamut_map(lin, NULL);
+#endif
+    } else {
+      v[0] = VBT__CLAMP_0100(v[0]);
+      vbt__oklab_to_linear(v[0], v[1], v[2], lin);
+#ifdef VIBRANT_GAMUT_MAP
+      vbt__gamut_map(lin, v);
+#endif
+    }
+
+    for (int j = 0; j < 3; j++) {
+      rgba[j] =
+          VBT__CLAMP_01(linear ? lin[j] : vbt__linear_to_srgb(lin[j]));
+    }
+  }
+
+  rgba[3] = VBT__CLAMP_01(v[3]);
+}
+
+// colors [0, count) of vbt__interpolate_color(), in chunks. the hues of a
+// chunk go through vbt__sincos_chunk() first, then each color is converted
+// once, without a branch, and vectorizes. with VIBRANT_GAMUT_MAP, colors
+// outside of sRGB take the gamut mapping branch, and the conversion does not
+// vectorize.
+VBT__FORCEINLINE static void vbt__interpolate_loop(vbt_space_t space,
+                                                   int premultiplied,
+                                                   vbt_bool_t linear,
+                                                   const vbt_number_t* start,
+                                                   const vbt_number_t* step,
+                                                   vbt_size_t count,
+                                                   vbt_number_t* out) {
+  for (vbt_size_t i = 0; i < count; i += VBT__HUE_CHUNK) {
+    const vbt_size_t n =
+        count - i < VBT__HUE_CHUNK ? count - i : VBT__HUE_CHUNK;
+    vbt_number_t hue[VBT__HUE_CHUNK];
+    vbt_number_t s[VBT__HUE_CHUNK] = {0};
+    vbt_number_t c[VBT__HUE_CHUNK] = {0};
+
+    if (space == VBT_SPACE_LCH || space == VBT_SPACE_OKLCH) {
+      for (vbt_size_t j = 0; j < n; j++) {
+        hue[j] = start[2] + (vbt_number_t)(i + j) * step[2];
+      }
+
+      vbt__sincos_chunk(hue, 1, n, s, c);
+    }
+
+    for (vbt_size_t j = 0; j < n; j++) {
+      vbt__interpolate_color(space, premultiplied, linear, start, step, i + j,
+                             s[j], c[j], out);
+    }
+  }
+}
+
+// first texel centered at or after position
+static vbt_size_t vbt__texel_index(vbt_number_t position, vbt_size_t width) {
+  const vbt_number_t x = position * (vbt_number_t)width - (vbt_number_t)0.5;
+  vbt_size_t i;
+
+  if (x <= 0) {
+    return 0;
+  }
+
+  if (x >= (vbt_number_t)width) {
+    return width;
+  }
+
+  i = (vbt_size_t)x;
+  return i + ((vbt_number_t)i < x);
+}
+
+// texels [begin, end) at start + (i - begin) * step, converted in chunks on
+// the stack, and packed into format
+static void vbt__bake_segment(vbt_space_t space,
+                              vbt_texel_format_t format,
+                              int dither,
+                              const vbt_number_t* start,
+                              const vbt_number_t* step,
+                              vbt_size_t begin,
+                              vbt_size_t end,
+                              void* texels) {
+  vbt_number_t rgba[VBT__BAKE_CHUNK * 4];
+
+  for (vbt_size_t i = begin; i < end; i += VBT__BAKE_CHUNK) {
+    const vbt_size_t n = end - i < VBT__BAKE_CHUNK ? end - i : VBT__BAKE_CHUNK;
+    const vbt_number_t t = (vbt_number_t)(i - begin);
+    vbt_number_t chunk[4];
+
+    for (int j = 0; j < 4; j++) {
+      chunk[j] = start[j] + t * step[j];
+    }
+
+    vbt__interpolate_segment(space, VBT__TRUE, format != VBT_TEXEL_RGBA8,
+                             chunk, step, n, rgba);
+    vbt__pack_texels(format, dither, rgba, i, n, texels);
+  }
+}
+
+static void vbt__pack_texels(vbt_texel_format_t format,
+                             int dither,
+                             const vbt_number_t* rgba,
+                             vbt_size_t first,
+                             vbt_size_t count,
+                             void* texels) {
+  switch (format) {
+    case VBT_TEXEL_RGBA8: {
+      vbt_u8_t* out = (vbt_u8_t*)texels + first * 4;
+
+      for (vbt_size_t i = 0; i < count; i++) {
+        // frac((first + i) / golden ratio), in 16 bits
+        const vbt_number_t offset =
+            dither ? (vbt_number_t)((first + i) * 40503u & 0xFFFFu) /
+                         (vbt_number_t)65536.0
+                   : (vbt_number_t)0.5;
+
+        for (int j = 0; j < 3; j++) {
+          out[i * 4 + j] =
+              (vbt_u8_t)(rgba[i * 4 + j] * (vbt_number_t)255 + offset);
+        }
+
+        out[i * 4 + 3] = (vbt_u8_t)(rgba[i * 4 + 3] * (vbt_number_t)255 +
+                                    (vbt_number_t)0.5);
+      }
+      break;
+    }
+    case VBT_TEXEL_RGBA16F: {
+      vbt_u16_t* out = (vbt_u16_t*)texels + first * 4;
+
+      for (vbt_size_t i = 0; i < count * 4; i++) {
+        out[i] = vbt__unit_to_half((float)rgba[i]);
+      }
+      break;
+    }
+    default: {
+      float* out = (float*)texels + first * 4;
+
+      for (vbt_size_t i = 0; i < count * 4; i++) {
+        out[i] = (float)rgba[i];
+      }
+      break;
+    }
+  }
+}
+
+// [0-1] to an IEEE 754 half float, rounded to nearest even
+VBT__FORCEINLINE static vbt_u16_t vbt__unit_to_half(float x) {
+  uint32_t bits;
+  uint32_t normal;
+  uint32_t subnormal;
+  float scaled;
+  float rest;
+
+  memcpy(&bits, &x, sizeof(bits));
+
+  // rebias the exponent from 127 to 15, and round the mantissa to 10 bits
+  normal = (bits + 0x0FFFu + (bits >> 13 & 1u) - (112u << 23)) >> 13;
+  // under 2^-14, halfs are multiples of 2^-24. scaled and rest are exact
+  scaled = x * 16777216.0f;
+  subnormal = (uint32_t)scaled;
+  rest = scaled - (float)subnormal;
+  subnormal += rest > 0.5f || (rest == 0.5f && (subnormal & 1u));
+
+  return (vbt_u16_t)(x < 6.103515625e-05f ? subnormal : normal);
 }
 
 static int vbt__write_u8(vbt_recv_t* recv,
@@ -861,1028 +8376,1086 @@ static int vbt__write_01(vbt_recv_t* recv,
   return VBT_SUCCESS;
 }
 
-// https://www.w3.org/TR/css-color-4/#hsl-to-rgb
-/*
-function hslToRgb(hue, sat, light) {
+#ifndef VIBRANT_NO_PARSE
 
-    sat /= 100;
-    light /= 100;
+// states of a vbt_var_t
+#define VBT__VAR_STALE (0)      // defined, not resolved since
+#define VBT__VAR_VALID (1)
+#define VBT__VAR_INVALID (2)    // not defined, or invalid at computed time
+#define VBT__VAR_RESOLVING (3)  // being resolved, a cycle if reached again
+#define VBT__VAR_CHECKING (4)   // flag, its cached state is being checked
 
-    function f(n) {
-        let k = (n + hue/30) % 12;
-        let a = sat * Math.min(light, 1 - light);
-        return light - a * Math.max(-1, Math.min(k - 3, 9 - k, 1));
+// var() references resolved inside each other, for the stack
+#define VBT__VAR_MAX_DEPTH (32)
+
+// a var(<name> [, <fallback>]) reference
+typedef struct vbt__var_ref_t {
+  const char* name;
+  vbt_size_t name_len;
+  const char* fallback;  // NULL without fallback
+  const char* fallback_end;
+} vbt__var_ref_t;
+
+// the state of one resolution. text is substituted into buf, and the
+// properties resolved along the way expand at its end and truncate it back.
+typedef struct vbt__var_resolver_t {
+  vbt_vars_t* vars;
+  char buf[VBT__MAX_STR_LEN];
+  vbt_size_t len;
+  vbt_size_t cycle;  // property a cycle was found at, or vars->capacity
+  int depth;
+} vbt__var_resolver_t;
+
+// clang-format off
+static vbt_size_t vbt__var_find(vbt_vars_t* vars, const char* name, vbt_size_t len, vbt_bool_t create);
+static uint32_t vbt__var_hash(const char* name, vbt_size_t len);
+static vbt_bool_t vbt__var_is_name(const char* name, vbt_size_t len);
+static vbt_bool_t vbt__var_is_name_char(char byte);
+static const char* vbt__var_reference(const char* sp, const char* end, vbt__var_ref_t* ref);
+static int vbt__var_resolve(vbt__var_resolver_t* r, vbt_size_t index, vbt_bool_t check);
+static int vbt__var_expand(vbt__var_resolver_t* r, const char* sp, const char* end, vbt_var_t* owner);
+static int vbt__var_add_dep(vbt__var_resolver_t* r, vbt_var_t* owner, vbt_size_t index);
+// clang-format on
+
+VBTDEF int vbt_parse(const char* value, vbt_size_t len, vbt_recv_t* recv) {
+  vbt_color_t color;
+
+  if (!recv || vbt__parse(value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
+
+  return vbt_color_resolve(&color, recv);
+}
+
+VBTDEF int vbt_parse_z(const char* value, vbt_recv_t* recv) {
+  vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
+  return vbt_parse(value, len, recv);
+}
+
+VBTDEF int vbt_validate(const char* value, vbt_size_t len) {
+  return vbt__parse(value, len, NULL);
+}
+
+VBTDEF int vbt_validate_z(const char* value) {
+  vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
+  return vbt__parse(value, len, NULL);
+}
+
+VBTDEF int vbt_parse_color(const char* value,
+                           vbt_size_t len,
+                           vbt_color_t* color) {
+  if (!color) {
+    return VBT_ERR;
+  }
+
+  return vbt__parse(value, len, color);
+}
+
+VBTDEF int vbt_parse_color_z(const char* value, vbt_color_t* color) {
+  vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
+  return vbt_parse_color(value, len, color);
+}
+
+VBTDEF int vbt_relative_compile(const char* value,
+                                vbt_size_t len,
+                                vbt_relative_t* rel) {
+  if (!rel) {
+    return VBT_ERR;
+  }
+
+  return vbt__relative_compile(value, len, rel);
+}
+
+VBTDEF int vbt_relative_compile_z(const char* value, vbt_relative_t* rel) {
+  vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
+  return vbt_relative_compile(value, len, rel);
+}
+
+VBTDEF int vbt_relative_apply(const vbt_relative_t* rel,
+                              vbt_color_t* origin,
+                              vbt_color_t* color) {
+  if (!origin || !color) {
+    return VBT_ERR;
+  }
+
+  return vbt_relative_apply_batch(rel, origin, 1, color, NULL);
+}
+
+VBTDEF int vbt_relative_apply_batch(const vbt_relative_t* rel,
+                                    vbt_color_t* origins,
+                                    vbt_size_t count,
+                                    vbt_color_t* colors,
+                                    int* err) {
+  int item_err[VBT__RELATIVE_CHUNK];
+  int result = VBT_SUCCESS;
+
+  if (!rel || vbt__relative_verify(rel) != VBT_SUCCESS ||
+      (count > 0 && (!origins || !colors))) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t first = 0; first < count; first += VBT__RELATIVE_CHUNK) {
+    const vbt_size_t n = count - first < VBT__RELATIVE_CHUNK
+                             ? count - first
+                             : VBT__RELATIVE_CHUNK;
+
+    if (vbt__relative_apply_chunk(rel, &origins[first], n, &colors[first],
+                                  item_err) != VBT_SUCCESS) {
+      result = VBT_ERR;
     }
 
-    return [f(0), f(8), f(4)];
+    for (vbt_size_t i = 0; err && i < n; i++) {
+      err[first + i] = item_err[i];
+    }
+  }
+
+  return result;
 }
-*/
 
-static vbt_number_t vbt__hsl_to_rgb_fn(vbt_number_t h,
-                                       vbt_number_t s,
-                                       vbt_number_t l,
-                                       vbt_number_t n) {
-  vbt_number_t k = vbt__fmod((n + h / (vbt_number_t)30.0), (vbt_number_t)12.0);
-  vbt_number_t a = s * VBT__MIN(l, (vbt_number_t)1.0 - l);
-  return l - a * VBT__MAX((vbt_number_t)-1.0,
-                          VBT__MIN(k - (vbt_number_t)3.0,
-                                   VBT__MIN((vbt_number_t)9.0 - k,
-                                            (vbt_number_t)1.0)));
+VBTDEF int vbt_vars_init(vbt_vars_t* vars,
+                         vbt_var_t* storage,
+                         vbt_size_t capacity) {
+  if (!vars || (!storage && capacity > 0)) {
+    return VBT_ERR;
+  }
+
+  for (vbt_size_t i = 0; i < capacity; i++) {
+    storage[i].bucket = 0;
+  }
+
+  vars->vars = storage;
+  vars->count = 0;
+  vars->capacity = capacity;
+  vars->stamp = 0;
+  return VBT_SUCCESS;
 }
 
-static void vbt__hsl_to_rgb(vbt_number_t hue,
-                            vbt_number_t saturation,
-                            vbt_number_t lightness,
-                            vbt_number_t* r,
-                            vbt_number_t* g,
-                            vbt_number_t* b) {
-  const vbt_number_t s = saturation / (vbt_number_t)100.0;
-  const vbt_number_t l = lightness / (vbt_number_t)100.0;
+VBTDEF int vbt_vars_define(vbt_vars_t* vars,
+                           const char* name,
+                           vbt_size_t name_len,
+                           const char* value,
+                           vbt_size_t value_len) {
+  vbt_size_t index;
+  vbt_var_t* var;
 
-  *r = vbt__hsl_to_rgb_fn(hue, s, l, 0);
-  *g = vbt__hsl_to_rgb_fn(hue, s, l, 8);
-  *b = vbt__hsl_to_rgb_fn(hue, s, l, 4);
+  if (!vars || !vbt__var_is_name(name, name_len) ||
+      (value && value_len > VBT__VAR_MAX_VALUE)) {
+    return VBT_ERR;
+  }
+
+  index = vbt__var_find(vars, name, name_len, value != NULL);
+
+  // there is nothing to remove of a property that was never defined
+  if (index == vars->capacity) {
+    return value ? VBT_ERR : VBT_SUCCESS;
+  }
+
+  var = &vars->vars[index];
+
+  if (!value) {
+    var->state = var->defined ? VBT__VAR_STALE : var->state;
+    var->defined = VBT__FALSE;
+    return VBT_SUCCESS;
+  }
+
+  // redefining a property as it is keeps its dependents cached
+  if (var->defined && var->value_len == value_len) {
+    vbt_size_t i = 0;
+
+    while (i < value_len && var->value[i] == value[i]) {
+      i++;
+    }
+
+    if (i == value_len) {
+      return VBT_SUCCESS;
+    }
+  }
+
+  for (vbt_size_t i = 0; i < value_len; i++) {
+    var->value[i] = value[i];
+  }
+
+  var->value_len = (vbt_u8_t)value_len;
+  var->defined = VBT__TRUE;
+  var->state = VBT__VAR_STALE;
+  return VBT_SUCCESS;
+}
+
+VBTDEF int vbt_vars_define_z(vbt_vars_t* vars,
+                             const char* name,
+                             const char* value) {
+  vbt_size_t name_len = vbt__strlen_safe(name, VBT__VAR_MAX_NAME);
+  vbt_size_t value_len = vbt__strlen_safe(value, VBT__VAR_MAX_VALUE);
+
+  // an empty value is a valid definition, a too long one is not
+  if (value && value_len == 0 && *value) {
+    return VBT_ERR;
+  }
+
+  return vbt_vars_define(vars, name, name_len, value, value_len);
 }
 
-static vbt_number_t vbt__normalize_angle(vbt_number_t angle) {
-  const vbt_number_t a = vbt__fmod(angle, VBT__DEG_MAX);
+VBTDEF int vbt_vars_get(vbt_vars_t* vars,
+                        const char* name,
+                        vbt_size_t len,
+                        vbt_color_t* color) {
+  vbt__var_resolver_t r;
+  vbt_size_t index;
+  vbt_var_t* var;
+
+  if (!vars || !color || !vbt__var_is_name(name, len)) {
+    return VBT_ERR;
+  }
+
+  index = vbt__var_find(vars, name, len, VBT__FALSE);
+
+  if (index == vars->capacity) {
+    return VBT_ERR;
+  }
+
+  r.vars = vars;
+  r.len = 0;
+  r.cycle = vars->capacity;
+  r.depth = 0;
+  var = &vars->vars[index];
+
+  if (vbt__var_resolve(&r, index, VBT__FALSE) != VBT__VAR_VALID ||
+      var->color.fn == VBT_COLOR_NONE) {
+    return VBT_ERR;
+  }
 
-  return (a < 0 ? a + VBT__DEG_MAX : a);
+  *color = var->color;
+  return VBT_SUCCESS;
 }
 
-#ifndef VIBRANT_NO_PARSE
+VBTDEF int vbt_vars_get_z(vbt_vars_t* vars,
+                          const char* name,
+                          vbt_color_t* color) {
+  vbt_size_t len = vbt__strlen_safe(name, VBT__VAR_MAX_NAME);
+  return vbt_vars_get(vars, name, len, color);
+}
 
-typedef enum vbt__function_t {
-  VBT__FUNCTION_RGB,
-  VBT__FUNCTION_HSL,
-  VBT__FUNCTION_HWB,
-  VBT__FUNCTION_LCH,
-  VBT__FUNCTION_LAB,
-  VBT__FUNCTION_OKLCH,
-  VBT__FUNCTION_OKLAB
-} vbt__function_t;
-
-typedef enum vbt__css_unit_t {
-  VBT__CSS_UNIT_UNSET = 0,
-  VBT__CSS_UNIT_PERCENT,
-  VBT__CSS_UNIT_NUMBER,
-} vbt__css_unit_t;
+VBTDEF int vbt_parse_vars(vbt_vars_t* vars,
+                          const char* value,
+                          vbt_size_t len,
+                          vbt_recv_t* recv) {
+  vbt_color_t color;
 
-typedef struct vbt__css_value_t {
-  vbt_number_t value;
-  vbt__css_unit_t unit;
-} vbt__css_value_t;
+  if (!recv || vbt_parse_color_vars(vars, value, len, &color) != VBT_SUCCESS) {
+    return VBT_ERR;
+  }
 
-typedef struct vbt__css_color_t {
-  const char* name;
-  vbt_u8_t color[4];
-} vbt__css_color_t;
+  return vbt_color_resolve(&color, recv);
+}
 
-typedef struct vbt__parser_t {
+VBTDEF int vbt_parse_vars_z(vbt_vars_t* vars,
+                            const char* value,
+                            vbt_recv_t* recv) {
+  vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
+  return vbt_parse_vars(vars, value, len, recv);
+}
+
+VBTDEF int vbt_parse_color_vars(vbt_vars_t* vars,
+                                const char* value,
+                                vbt_size_t len,
+                                vbt_color_t* color) {
+  vbt__var_resolver_t r;
+  vbt__var_ref_t ref;
   const char* sp;
   const char* end;
-} vbt__parser_t;
-
-// clang-format off
-static vbt_bool_t vbt__hex_char_to_int(int c, int* out);
-static int vbt__parse_hex(const char* value, vbt_size_t len, vbt_recv_t* recv);
-static int vbt__parse_css_function(const char* value, vbt_size_t len, vbt_recv_t* recv);
-static int vbt__parse_css_color_name(const char* value, vbt_size_t len, vbt_recv_t* recv);
-static int vbt__consume_css_value(vbt__parser_t* p, vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_01(const vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_lch_chroma(const vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_lab_ab(const vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_ok_lightness(const vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_oklab_ab(const vbt__css_value_t* css_value);
-static vbt_number_t vbt__css_value_to_percent(const vbt__css_value_t* css_value);
-static vbt_u8_t vbt__css_value_to_u8(const vbt__css_value_t* css_value);
-static int vbt__casecmp(const char* s1, const char* s2, vbt_size_t n);
-static int vbt__consume_whitespace(vbt__parser_t* p);
-static int vbt__consume_if(vbt__parser_t* p, const char* str, size_t len);
-static int vbt__consume_delimiter(vbt__parser_t* p, int* is_comma_mode, int is_comma_mode_set);
-static int vbt__parse_number(vbt__parser_t* p, vbt_number_t* out);
-static int vbt__tolower(int c);
-static vbt_size_t vbt__strlen_safe(const char* str, vbt_size_t limit);
-static vbt_size_t vbt__hash(const char* str, size_t len);
-static const vbt__css_color_t* vbt__find_css_color(const char* value,  vbt_size_t len);
-// clang-format on
 
-VBTDEF int vbt_parse(const char* value, vbt_size_t len, vbt_recv_t* recv) {
-  if (len == 0 || len > VBT__MAX_STR_LEN || !value || !recv) {
+  if (!vars || !color || !value || len == 0 || len > VBT__MAX_STR_LEN) {
     return VBT_ERR;
   }
 
-  if (*value == '#') {
-    return vbt__parse_hex(value, len, recv);
+  sp = vbt__trim_start(value, value + len);
+  end = vbt__trim_end(sp, value + len);
+
+  // a single var() of a valid color is the cached color
+  if (vbt__var_reference(sp, end, &ref) == end) {
+    if (vbt_vars_get(vars, ref.name, ref.name_len, color) == VBT_SUCCESS) {
+      return VBT_SUCCESS;
+    }
   }
 
-  int result = vbt__parse_css_function(value, len, recv);
+  r.vars = vars;
+  r.len = 0;
+  r.cycle = vars->capacity;
+  r.depth = 0;
 
-  if (result == VBT__NOT_A_FUNCTION) {
-    return vbt__parse_css_color_name(value, len, recv);
+  if (vbt__var_expand(&r, sp, end, NULL) != VBT_SUCCESS) {
+    return VBT_ERR;
   }
 
-  return result;
+  sp = vbt__trim_start(r.buf, r.buf + r.len);
+  end = vbt__trim_end(sp, r.buf + r.len);
+  return vbt__parse(sp, (vbt_size_t)(end - sp), color);
 }
 
-VBTDEF int vbt_parse_z(const char* value, vbt_recv_t* recv) {
+VBTDEF int vbt_parse_color_vars_z(vbt_vars_t* vars,
+                                  const char* value,
+                                  vbt_color_t* color) {
   vbt_size_t len = vbt__strlen_safe(value, VBT__MAX_STR_LEN);
-  return vbt_parse(value, len, recv);
+  return vbt_parse_color_vars(vars, value, len, color);
 }
 
-static vbt_bool_t vbt__hex_char_to_int(int c, int* out) {
-  if (c >= '0' && c <= '9') {
-    *out = c - '0';
-  } else if (c >= 'a' && c <= 'f') {
-    *out = c - 'a' + 10;
-  } else if (c >= 'A' && c <= 'F') {
-    *out = c - 'A' + 10;
-  } else {
-    return VBT__FALSE;
+// index of the property name, or vars->capacity. with create, a property
+// that is not there is added, not defined.
+static vbt_size_t vbt__var_find(vbt_vars_t* vars,
+                                const char* name,
+                                vbt_size_t len,
+                                vbt_bool_t create) {
+  const uint32_t hash = vbt__var_hash(name, len);
+  vbt_var_t* head;
+  vbt_var_t* var;
+
+  if (vars->capacity == 0) {
+    return vars->capacity;
   }
 
-  return VBT__TRUE;
-}
+  // the buckets are chained through the storage, heads in slot hash % n
+  head = &vars->vars[hash % vars->capacity];
 
-static int vbt__parse_hex(const char* value, vbt_size_t len, vbt_recv_t* recv) {
-  int components[4];
-  int component_index = 0;
+  for (uint32_t i = head->bucket; i != 0; i = var->next) {
+    var = &vars->vars[i - 1];
 
-  if (len == 4 || len == 5) {  // #rgb or #rgba
-    for (size_t i = 1; i < len; i++) {
-      int c;
+    if (var->hash == hash && var->name_len == len) {
+      vbt_size_t j = 0;
 
-      if (!vbt__hex_char_to_int((unsigned char)value[i], &c)) {
-        return VBT_ERR;
+      while (j < len && var->name[j] == name[j]) {
+        j++;
       }
 
-      components[component_index++] = (c << 4) | c;
+      if (j == len) {
+        return i - 1;
+      }
     }
-  } else if (len == 7 || len == 9) {  // #rrggbb or #rrggbbaa
-    for (size_t i = 1; i < len; i += 2) {
-      int a;
-      int b;
+  }
 
-      if (!vbt__hex_char_to_int((unsigned char)value[i], &a)) {
-        return VBT_ERR;
-      }
+  if (!create || vars->count == vars->capacity) {
+    return vars->capacity;
+  }
 
-      if (!vbt__hex_char_to_int((unsigned char)value[i + 1], &b)) {
-        return VBT_ERR;
-      }
+  var = &vars->vars[vars->count];
+  var->next = head->bucket;
+  head->bucket = (uint32_t)(vars->count + 1);
 
-      components[component_index++] = (a << 4) | b;
-    }
-  } else {
-    return VBT_ERR;
+  for (vbt_size_t i = 0; i < len; i++) {
+    var->name[i] = name[i];
   }
 
-  return vbt__write_u8(recv, (vbt_u8_t)(components[0]),
-                       (vbt_u8_t)(components[1]), (vbt_u8_t)(components[2]),
-                       component_index == 4 ? (vbt_u8_t)(components[3]) : 255);
+  var->name_len = (vbt_u8_t)len;
+  var->value_len = 0;
+  var->defined = VBT__FALSE;
+  var->state = VBT__VAR_INVALID;
+  var->dep_count = 0;
+  var->hash = hash;
+  var->stamp = ++vars->stamp;
+  var->color.fn = VBT_COLOR_NONE;
+  return vars->count++;
 }
 
-static vbt_size_t vbt__strlen_safe(const char* str, vbt_size_t limit) {
-  vbt_size_t len = 0;
+// FNV-1a
+static uint32_t vbt__var_hash(const char* name, vbt_size_t len) {
+  uint32_t hash = 2166136261u;
 
-  if (!str) {
-    return len;
+  for (vbt_size_t i = 0; i < len; i++) {
+    hash = (hash ^ (unsigned char)name[i]) * 16777619u;
   }
 
-  while (len < limit && *str) {
-    str++;
-    len++;
+  return hash;
+}
+
+// --<name>
+static vbt_bool_t vbt__var_is_name(const char* name, vbt_size_t len) {
+  if (!name || len <= 2 || len > VBT__VAR_MAX_NAME || name[0] != '-' ||
+      name[1] != '-') {
+    return VBT__FALSE;
   }
 
-  if (len == limit && *str) {
-    return 0;  // Overflow
+  for (vbt_size_t i = 2; i < len; i++) {
+    if (!vbt__var_is_name_char(name[i])) {
+      return VBT__FALSE;
+    }
   }
 
-  return len;
+  return VBT__TRUE;
 }
 
-static int vbt__tolower(int c) {
-  return (c >= 'A' && c <= 'Z') ? (c | 0x20) : c;
+// letters, digits, '-', '_' and non-ascii bytes
+static vbt_bool_t vbt__var_is_name_char(char byte) {
+  const int c = (unsigned char)byte;
+
+  return c >= 0x80 || c == '-' || c == '_' || (c >= '0' && c <= '9') ||
+         (vbt__tolower(c) >= 'a' && vbt__tolower(c) <= 'z');
 }
 
-static int vbt__casecmp(const char* s1, const char* s2, vbt_size_t n) {
-  int result = 0;
-  const unsigned char* p1 = (const unsigned char*)s1;
-  const unsigned char* p2 = (const unsigned char*)s2;
+// reads var(<name> [, <fallback>]) at sp, returns where it ends or NULL
+static const char* vbt__var_reference(const char* sp,
+                                      const char* end,
+                                      vbt__var_ref_t* ref) {
+  const char* name;
+  int depth = 0;
+
+  if (end - sp < 4 || vbt__casecmp(sp, "var(", 4) != 0) {
+    return NULL;
+  }
+
+  sp = vbt__trim_start(sp + 4, end);
+  name = sp;
+
+  while (sp < end && !(vbt__fn_byte_class[(unsigned char)*sp] ==
+                           VBT__FC_SPACE ||
+                       *sp == ',' || *sp == ')')) {
+    sp++;
+  }
 
-  for (vbt_size_t i = 0; i < n; ++i) {
-    result = vbt__tolower(p1[i]) - vbt__tolower(p2[i]);
+  if (!vbt__var_is_name(name, (vbt_size_t)(sp - name))) {
+    return NULL;
+  }
 
-    if (result != 0) {
-      break;
-    }
+  ref->name = name;
+  ref->name_len = (vbt_size_t)(sp - name);
+  ref->fallback = NULL;
+  ref->fallback_end = NULL;
+  sp = vbt__trim_start(sp, end);
+
+  if (sp < end && *sp == ')') {
+    return sp + 1;
   }
 
-  return result;
-}
+  if (sp == end || *sp != ',') {
+    return NULL;
+  }
 
-static int vbt__consume_whitespace(vbt__parser_t* p) {
-  int space_count = 0;
+  // the fallback is everything up to the closing parenthesis
+  ref->fallback = vbt__trim_start(++sp, end);
 
-  // only skip non-breaking space chars
-  while (p->sp < p->end && (*p->sp == ' ' || *p->sp == '\t')) {
-    p->sp++;
-    space_count++;
+  for (; sp < end; sp++) {
+    if (*sp == '(') {
+      depth++;
+    } else if (*sp == ')' && depth-- == 0) {
+      ref->fallback_end = vbt__trim_end(ref->fallback, sp);
+      return sp + 1;
+    }
   }
 
-  return space_count;
+  return NULL;
 }
 
-// string -> float
-// specialized to handle parsing needs
-static int vbt__parse_number(vbt__parser_t* p, vbt_number_t* out) {
-  const char* sp = p->sp;
-  const char* end = p->end;
-  vbt_number_t res = 0;
-  vbt_number_t sign = 1;
+// brings the property at index up to date, and returns its state. its
+// cached result holds while the properties it references keep their stamp.
+// check is set when the caller only checks that its own result holds.
+static int vbt__var_resolve(vbt__var_resolver_t* r,
+                            vbt_size_t index,
+                            vbt_bool_t check) {
+  vbt_vars_t* vars = r->vars;
+  vbt_var_t* var = &vars->vars[index];
+  const vbt_size_t start = r->len;
+  const int cached = var->state;
+  vbt_bool_t fresh = cached != VBT__VAR_STALE;
+  int state = VBT__VAR_INVALID;
+
+  if (cached == VBT__VAR_RESOLVING ||
+      ((cached & VBT__VAR_CHECKING) && !check)) {
+    r->cycle = index;
+    return VBT__VAR_INVALID;
+  }
 
-  if (sp < end) {
-    if (*sp == '-') {
-      sign = -1;
-      sp++;
-    } else if (*sp == '+') {
-      sp++;
-    }
+  // checking a cached cycle leads back to where the check started, whose
+  // result holds unless the rest of the cycle changed
+  if (cached & VBT__VAR_CHECKING) {
+    return cached & ~VBT__VAR_CHECKING;
   }
 
-  while (sp < end && *sp >= '0' && *sp <= '9') {
-    const vbt_number_t d = (vbt_number_t)(*sp - '0');
-    if (res > (VBT__NUMBER_MAX - d) / (vbt_number_t)(10.0)) {
-      return -1;
-    }
-    res = res * (vbt_number_t)(10.0) + d;
-    sp++;
+  if (r->depth == VBT__VAR_MAX_DEPTH) {
+    return VBT__VAR_INVALID;
   }
 
-  if (sp < end && *sp == '.') {
-    sp++;
-    vbt_number_t f = (vbt_number_t)(0.1);
-    vbt_size_t n = 0;
+  r->depth++;
+  var->state = (vbt_u8_t)(cached | VBT__VAR_CHECKING);
 
-    while (sp < end && *sp >= '0' && *sp <= '9') {
-      if (n++ >= VBT__NUMBER_DECIMAL_LIMIT) {
-        return -1;
-      }
+  for (int k = 0; fresh && k < var->dep_count; k++) {
+    const vbt_var_t* dep = &vars->vars[var->deps[k]];
 
-      const vbt_number_t d = (vbt_number_t)(*sp - '0');
-      if (res < VBT__NUMBER_MAX && f > ((vbt_number_t)0)) {
-        const vbt_number_t val = d * f;
-        if (res > VBT__NUMBER_MAX - val) {
-          return -1;
-        } else {
-          res += val;
-        }
-        f *= (vbt_number_t)(0.1);
-      }
+    vbt__var_resolve(r, var->deps[k], VBT__TRUE);
+    fresh = r->cycle == vars->capacity && dep->stamp == var->dep_stamps[k];
+  }
 
-      sp++;
-    }
+  if (fresh) {
+    var->state = (vbt_u8_t)cached;
+    r->depth--;
+    return cached;
   }
 
-  if (sp == p->sp) {
-    return -1;
+  var->state = VBT__VAR_RESOLVING;
+  var->color.fn = VBT_COLOR_NONE;
+
+  // a property on a cycle is invalid, and keeps the dependencies that lead
+  // back to it. the cycle is over at the property it was found at.
+  if (r->cycle == vars->capacity) {
+    var->dep_count = 0;
   }
 
-  p->sp = sp;
-  *out = res * sign;
+  if (r->cycle == vars->capacity && var->defined &&
+      vbt__var_expand(r, var->value, var->value + var->value_len, var) ==
+          VBT_SUCCESS) {
+    const char* sp = vbt__trim_start(r->buf + start, r->buf + r->len);
+    const char* end = vbt__trim_end(sp, r->buf + r->len);
 
-  return 0;
-}
+    state = VBT__VAR_VALID;
 
-static int vbt__consume_css_value(vbt__parser_t* p,
-                                  vbt__css_value_t* css_value) {
-  if (vbt__parse_number(p, &css_value->value) != 0) {
-    return 0;
+    // any text is a valid property, some of it is also a color
+    if (vbt__parse(sp, (vbt_size_t)(end - sp), &var->color) == VBT_SUCCESS) {
+      vbt_color_eval(&var->color);
+    } else {
+      var->color.fn = VBT_COLOR_NONE;
+    }
   }
 
-  if (vbt__consume_if(p, "%", 1)) {
-    css_value->unit = VBT__CSS_UNIT_PERCENT;
-  } else {
-    css_value->unit = VBT__CSS_UNIT_NUMBER;
+  if (r->cycle == index) {
+    r->cycle = vars->capacity;
   }
 
-  return 1;
-}
+  r->len = start;
+  r->depth--;
+  var->state = (vbt_u8_t)state;
 
-static vbt_number_t vbt__css_value_to_01(const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
-           VBT__PERCENT_MAX;
+  // an invalid property substitutes no text, so one that stays invalid, such
+  // as a cycle, keeps its dependents cached
+  if (state != VBT__VAR_INVALID || cached != VBT__VAR_INVALID) {
+    var->stamp = ++vars->stamp;
   }
 
-  return VBT__CLAMP_01(css_value->value);
+  return state;
 }
 
-static vbt_number_t vbt__css_value_to_percent(
-    const vbt__css_value_t* css_value) {
-  return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX);
-}
+// appends the text from sp to end to r->buf, with its var() references
+// substituted. the references of owner's own text are its dependencies.
+static int vbt__var_expand(vbt__var_resolver_t* r,
+                           const char* sp,
+                           const char* end,
+                           vbt_var_t* owner) {
+  vbt_vars_t* vars = r->vars;
+  const char* start = sp;
+
+  while (sp < end) {
+    vbt__var_ref_t ref;
+    const char* ref_end = NULL;
+    vbt_size_t index;
+    int state = VBT__VAR_INVALID;
+
+    if ((*sp == 'v' || *sp == 'V') &&
+        (sp == start || !vbt__var_is_name_char(sp[-1]))) {
+      ref_end = vbt__var_reference(sp, end, &ref);
+    }
 
-static vbt_u8_t vbt__css_value_to_u8(const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    vbt_number_t percent =
-        VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
-        VBT__PERCENT_MAX;
+    if (!ref_end) {
+      if (r->len == VBT__MAX_STR_LEN) {
+        return VBT_ERR;
+      }
 
-    return VBT__01_TO_255(percent);
-  }
+      r->buf[r->len++] = *sp++;
+      continue;
+    }
 
-  const vbt_number_t lo = 0;
-  const vbt_number_t hi = 255;
+    index = vbt__var_find(vars, ref.name, ref.name_len, owner != NULL);
 
-  return (vbt_u8_t)VBT__CLAMP(css_value->value + (vbt_number_t)(0.5), lo, hi);
-}
+    if (index < vars->capacity) {
+      state = vbt__var_resolve(r, index, VBT__FALSE);
 
-static int vbt__consume_if(vbt__parser_t* p, const char* str, size_t len) {
-  for (size_t i = 0; i < len; i++) {
-    if (p->sp + i >= p->end || p->sp[i] != str[i]) {
-      return 0;
+      if (owner && vbt__var_add_dep(r, owner, index) != VBT_SUCCESS) {
+        return VBT_ERR;
+      }
+    } else if (owner) {
+      // no room to track the reference
+      return VBT_ERR;
+    }
+
+    // fallbacks don't apply on a cycle
+    if (r->cycle != vars->capacity) {
+      return VBT_ERR;
+    }
+
+    if (state == VBT__VAR_VALID) {
+      const vbt_var_t* var = &vars->vars[index];
+
+      if (vbt__var_expand(r, var->value, var->value + var->value_len,
+                          NULL) != VBT_SUCCESS) {
+        return VBT_ERR;
+      }
+    } else if (!ref.fallback ||
+               vbt__var_expand(r, ref.fallback, ref.fallback_end, owner) !=
+                   VBT_SUCCESS) {
+      return VBT_ERR;
     }
+
+    sp = ref_end;
   }
 
-  p->sp += len;
-  return 1;
+  return VBT_SUCCESS;
 }
 
-static int vbt__consume_delimiter(vbt__parser_t* p,
-                                  int* is_comma_mode,
-                                  int is_comma_mode_set) {
-  int space_count = vbt__consume_whitespace(p);
+// records that owner references the property at index, as it is now
+static int vbt__var_add_dep(vbt__var_resolver_t* r,
+                            vbt_var_t* owner,
+                            vbt_size_t index) {
+  const uint32_t stamp = r->vars->vars[index].stamp;
 
-  if (!is_comma_mode_set) {
-    if (vbt__consume_if(p, ",", 1)) {
-      *is_comma_mode = 1;
-      return 1;
+  for (int k = 0; k < owner->dep_count; k++) {
+    if (owner->deps[k] == index) {
+      owner->dep_stamps[k] = stamp;
+      return VBT_SUCCESS;
     }
-
-    *is_comma_mode = 0;
-    return space_count > 0 ? 1 : 0;
   }
 
-  if (*is_comma_mode) {
-    return vbt__consume_if(p, ",", 1) ? 1 : 0;
+  if (owner->dep_count == VBT__VAR_MAX_DEPS) {
+    return VBT_ERR;
   }
 
-  return space_count > 0 ? 1 : 0;
+  owner->deps[owner->dep_count] = (uint32_t)index;
+  owner->dep_stamps[owner->dep_count++] = stamp;
+  return VBT_SUCCESS;
 }
 
-static vbt_number_t vbt__css_value_to_lch_chroma(
-    const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) *
-           (vbt_number_t)(1.5);
+#endif  // VIBRANT_NO_PARSE
+
+// batch
+
+// a batch is either values (parse) or colors (resolve)
+typedef struct vbt__batch_t {
+  const char* const* values;
+  const vbt_size_t* lens;
+  vbt_color_t* colors;
+  vbt_recv_t* recv;
+  int* err;
+  vbt_size_t count;
+} vbt__batch_t;
+
+// converts items [begin, end) of batch
+static int vbt__batch_run(const vbt__batch_t* batch,
+                          vbt_size_t begin,
+                          vbt_size_t end) {
+  int result = VBT_SUCCESS;
+
+  for (vbt_size_t i = begin; i < end; i++) {
+    int err;
+
+#ifndef VIBRANT_NO_PARSE
+    if (batch->values) {
+      err = batch->lens
+                ? vbt_parse(batch->values[i], batch->lens[i], &batch->recv[i])
+                : vbt_parse_z(batch->values[i], &batch->recv[i]);
+    } else
+#endif
+    {
+      err = vbt_color_resolve(&batch->colors[i], &batch->recv[i]);
+    }
+
+    if (batch->err) {
+      batch->err[i] = err;
+    }
+    if (err != VBT_SUCCESS) {
+      result = VBT_ERR;
+    }
   }
 
-  return css_value->value;
+  return result;
 }
 
-static vbt_number_t vbt__css_value_to_lab_ab(
-    const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    return VBT__CLAMP(css_value->value, -VBT__PERCENT_MAX, VBT__PERCENT_MAX) *
-           (vbt_number_t)(1.25);
+VBTDEF int vbt_color_resolve_batch(vbt_color_t* colors,
+                                   vbt_size_t count,
+                                   vbt_recv_t* recv,
+                                   int* err) {
+  vbt__batch_t batch = {NULL, NULL, colors, recv, err, count};
+
+  if (count > 0 && (!colors || !recv)) {
+    return VBT_ERR;
   }
 
-  return css_value->value;
+  return vbt__batch_run(&batch, 0, count);
 }
 
-static vbt_number_t vbt__css_value_to_ok_lightness(
-    const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    return VBT__CLAMP(css_value->value, VBT__PERCENT_MIN, VBT__PERCENT_MAX) /
-           VBT__PERCENT_MAX;
+#ifndef VIBRANT_NO_PARSE
+VBTDEF int vbt_parse_batch(const char* const* values,
+                           const vbt_size_t* lens,
+                           vbt_size_t count,
+                           vbt_recv_t* recv,
+                           int* err) {
+  vbt__batch_t batch = {values, lens, NULL, recv, err, count};
+
+  if (count > 0 && (!values || !recv)) {
+    return VBT_ERR;
   }
 
-  return VBT__CLAMP_01(css_value->value);
+  return vbt__batch_run(&batch, 0, count);
 }
+#endif  // VIBRANT_NO_PARSE
 
-static vbt_number_t vbt__css_value_to_oklab_ab(
-    const vbt__css_value_t* css_value) {
-  if (css_value->unit == VBT__CSS_UNIT_PERCENT) {
-    return VBT__CLAMP(css_value->value, -VBT__PERCENT_MAX, VBT__PERCENT_MAX) *
-           (vbt_number_t)(0.004);
+#ifdef VIBRANT_THREADS
+
+#ifdef __cplusplus
+#include <cstdlib>  // malloc, free
+#else
+#include <stdlib.h>  // malloc, free
+#endif
+#if defined(_WIN32) && !defined(__MINGW32__)
+#error "VIBRANT_THREADS requires pthreads, which this platform doesn't have"
+#endif
+#include <pthread.h>
+#include <unistd.h>  // sysconf
+
+// items per chunk. a chunk of strings, receivers and results stays well
+// within L1, and is large enough that taking it from a deque is noise.
+#define VBT__BATCH_CHUNK (256)
+#define VBT__CACHE_LINE (64)
+
+// a worker owns the chunks [head, tail). it takes chunks from head, thieves
+// take the upper half from tail.
+typedef struct vbt__worker_t {
+  pthread_mutex_t lock;
+  vbt_size_t head;
+  vbt_size_t tail;
+  int failed;
+  unsigned index;
+  vbt_pool_t* pool;
+  // keep workers on separate cache lines
+  char pad[VBT__CACHE_LINE];
+} vbt__worker_t;
+
+struct vbt_pool_t {
+  pthread_mutex_t submit;
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  // the current batch, a new batch bumps generation
+  const vbt__batch_t* batch;
+  unsigned long generation;
+  // helper threads still working on the current batch
+  unsigned running;
+  int shutdown;
+  // workers[0] is the thread calling *_batch_mt(), and has no pthread
+  unsigned count;
+  vbt__worker_t* workers;
+  pthread_t* threads;
+};
+
+static int vbt__pool_pop(vbt__worker_t* self, vbt_size_t* chunk) {
+  int found = VBT__FALSE;
+
+  pthread_mutex_lock(&self->lock);
+  if (self->head < self->tail) {
+    *chunk = self->head++;
+    found = VBT__TRUE;
   }
+  pthread_mutex_unlock(&self->lock);
 
-  return css_value->value;
+  return found;
 }
 
-static int vbt__parse_css_function(const char* value,
-                                   vbt_size_t len,
-                                   vbt_recv_t* recv) {
-  // you must be this tall to enter
-  if (len < VBT__ARR_LEN("xxx(0,0,0)") - 1) {
-    return VBT__NOT_A_FUNCTION;
-  }
-
-  vbt__parser_t parser;
-
-  parser.sp = value;
-  parser.end = value + len;
-
-  vbt__function_t fn;
-
-  if (vbt__consume_if(&parser, "rgb", 3)) {
-    fn = VBT__FUNCTION_RGB;
-  } else if (vbt__consume_if(&parser, "hsl", 3)) {
-    fn = VBT__FUNCTION_HSL;
-  } else if (vbt__consume_if(&parser, "hwb", 3)) {
-    fn = VBT__FUNCTION_HWB;
-  } else if (vbt__consume_if(&parser, "lch", 3)) {
-    fn = VBT__FUNCTION_LCH;
-  } else if (vbt__consume_if(&parser, "lab", 3)) {
-    fn = VBT__FUNCTION_LAB;
-  } else if (vbt__consume_if(&parser, "oklch", 5)) {
-    fn = VBT__FUNCTION_OKLCH;
-  } else if (vbt__consume_if(&parser, "oklab", 5)) {
-    fn = VBT__FUNCTION_OKLAB;
-  } else {
-    return VBT__NOT_A_FUNCTION;
+// moves the upper half of another worker's chunks to self
+static int vbt__pool_steal(vbt_pool_t* pool, vbt__worker_t* self) {
+  for (unsigned i = 1; i < pool->count; i++) {
+    vbt__worker_t* victim = &pool->workers[(self->index + i) % pool->count];
+    vbt_size_t begin = 0, end = 0;
+
+    pthread_mutex_lock(&victim->lock);
+    if (victim->head < victim->tail) {
+      begin = victim->head + (victim->tail - victim->head) / 2;
+      end = victim->tail;
+      victim->tail = begin;
+    }
+    pthread_mutex_unlock(&victim->lock);
+
+    if (begin < end) {
+      pthread_mutex_lock(&self->lock);
+      self->head = begin;
+      self->tail = end;
+      pthread_mutex_unlock(&self->lock);
+      return VBT__TRUE;
+    }
   }
 
-  int is_alpha_version = 0;
+  return VBT__FALSE;
+}
 
-  if (vbt__consume_if(&parser, "a", 1)) {
-    is_alpha_version = 1;
-  }
+static void vbt__pool_work(vbt_pool_t* pool, vbt__worker_t* self) {
+  const vbt__batch_t* batch = pool->batch;
+  vbt_size_t chunk;
 
-  vbt__css_value_t arg[4];
-  int is_comma_mode;
-  int is_comma_mode_set = 0;
+  for (;;) {
+    if (!vbt__pool_pop(self, &chunk)) {
+      if (!vbt__pool_steal(pool, self)) {
+        return;
+      }
+      continue;
+    }
 
-  vbt__consume_whitespace(&parser);
+    vbt_size_t begin = chunk * VBT__BATCH_CHUNK;
+    vbt_size_t end = VBT__MIN(begin + VBT__BATCH_CHUNK, batch->count);
 
-  if (!vbt__consume_if(&parser, "(", 1)) {
-    return VBT_ERR;
+    if (vbt__batch_run(batch, begin, end) != VBT_SUCCESS) {
+      self->failed = VBT__TRUE;
+    }
   }
+}
 
-  // all function have at least 3 arguments
-  for (size_t i = 0; i < VBT__ARR_LEN(arg) - 1; i++) {
-    vbt__consume_whitespace(&parser);
+static void* vbt__pool_main(void* arg) {
+  vbt__worker_t* self = (vbt__worker_t*)arg;
+  vbt_pool_t* pool = self->pool;
+  unsigned long generation = 0;
 
-    if (!vbt__consume_css_value(&parser, &arg[i])) {
-      return VBT_ERR;
+  pthread_mutex_lock(&pool->lock);
+  for (;;) {
+    while (!pool->shutdown && pool->generation == generation) {
+      pthread_cond_wait(&pool->start, &pool->lock);
     }
-
-    // break after read value #3, next char can be ' ', ',', ')' or '/'
-    if (i == VBT__ARR_LEN(arg) - 2) {
+    if (pool->shutdown) {
       break;
     }
 
-    if (!vbt__consume_delimiter(&parser, &is_comma_mode, is_comma_mode_set)) {
-      return VBT_ERR;
-    }
+    generation = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
 
-    is_comma_mode_set = 1;
-  }
+    vbt__pool_work(pool, self);
 
-  if (is_alpha_version) {
-    // 'a' version of functions always have 4 parameters
-    if (!vbt__consume_delimiter(&parser, &is_comma_mode, is_comma_mode_set)) {
-      return VBT_ERR;
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->running == 0) {
+      pthread_cond_signal(&pool->done);
     }
+  }
+  pthread_mutex_unlock(&pool->lock);
 
-    vbt__consume_whitespace(&parser);
+  return NULL;
+}
 
-    if (!vbt__consume_css_value(&parser, &arg[3])) {
-      return VBT_ERR;
-    }
-  } else {
-    // non 'a' functions can add alpha using '/' instead of ','
-    vbt__consume_whitespace(&parser);
+// stops and joins the first `started` helper threads, then frees pool
+static void vbt__pool_free(vbt_pool_t* pool, unsigned started) {
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = VBT__TRUE;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
 
-    if (vbt__consume_if(&parser, "/", 1)) {
-      vbt__consume_whitespace(&parser);
+  for (unsigned i = 0; i < started; i++) {
+    pthread_join(pool->threads[i], NULL);
+  }
 
-      if (!vbt__consume_css_value(&parser, &arg[3])) {
-        return VBT_ERR;
-      }
-    } else {
-      arg[3].value = 1;
-      arg[3].unit = VBT__CSS_UNIT_NUMBER;
-    }
+  for (unsigned i = 0; i < pool->count; i++) {
+    pthread_mutex_destroy(&pool->workers[i].lock);
   }
 
-  vbt__consume_whitespace(&parser);
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_mutex_destroy(&pool->submit);
+  free(pool->threads);
+  free(pool->workers);
+  free(pool);
+}
 
-  if (!vbt__consume_if(&parser, ")", 1)) {
-    return VBT_ERR;
-  }
+// initializes the locks and conditions of pool, all of them or none
+static int vbt__pool_init_sync(vbt_pool_t* pool) {
+  unsigned locks = 0;
+  int step = 0;
 
-  vbt__consume_whitespace(&parser);
+  step += pthread_mutex_init(&pool->submit, NULL) == 0;
+  step += step == 1 && pthread_mutex_init(&pool->lock, NULL) == 0;
+  step += step == 2 && pthread_cond_init(&pool->start, NULL) == 0;
+  step += step == 3 && pthread_cond_init(&pool->done, NULL) == 0;
 
-  if (parser.sp != parser.end) {
-    return VBT_ERR;
+  while (step == 4 && locks < pool->count &&
+         pthread_mutex_init(&pool->workers[locks].lock, NULL) == 0) {
+    locks++;
   }
 
-  // TODO: this should be an assert.
-  for (size_t i = 0; i < VBT__ARR_LEN(arg); i++) {
-    if (arg[i].unit == VBT__CSS_UNIT_UNSET) {
-      return VBT_ERR;
-    }
+  if (step == 4 && locks == pool->count) {
+    return VBT_SUCCESS;
   }
 
-  // translate parsed args to each css function's requirements
-  // https://developer.mozilla.org/en-US/docs/Web/CSS/Reference/Values/color_value
-  switch (fn) {
-    case VBT__FUNCTION_HSL: {
-      const vbt_number_t hue = arg[0].value;
-      const vbt_number_t saturation = vbt__css_value_to_percent(&arg[1]);
-      const vbt_number_t lightness = vbt__css_value_to_percent(&arg[2]);
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  while (locks > 0) {
+    pthread_mutex_destroy(&pool->workers[--locks].lock);
+  }
 
-      return vbt_hsl(hue, saturation, lightness, alpha, recv);
-    }
-    case VBT__FUNCTION_HWB: {
-      const vbt_number_t hue = arg[0].value;
-      const vbt_number_t whiteness = vbt__css_value_to_percent(&arg[1]);
-      const vbt_number_t blackness = vbt__css_value_to_percent(&arg[2]);
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  if (step > 3) {
+    pthread_cond_destroy(&pool->done);
+  }
+  if (step > 2) {
+    pthread_cond_destroy(&pool->start);
+  }
+  if (step > 1) {
+    pthread_mutex_destroy(&pool->lock);
+  }
+  if (step > 0) {
+    pthread_mutex_destroy(&pool->submit);
+  }
 
-      return vbt_hwb(hue, whiteness, blackness, alpha, recv);
-    }
-    case VBT__FUNCTION_RGB: {
-      const vbt_u8_t red = vbt__css_value_to_u8(&arg[0]);
-      const vbt_u8_t green = vbt__css_value_to_u8(&arg[1]);
-      const vbt_u8_t blue = vbt__css_value_to_u8(&arg[2]);
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  return VBT_ERR;
+}
 
-      return vbt__write_u8(recv, red, green, blue, VBT__01_TO_255(alpha));
-    }
-    case VBT__FUNCTION_LCH: {
-      const vbt_number_t lightness = vbt__css_value_to_percent(&arg[0]);
-      const vbt_number_t chroma = vbt__css_value_to_lch_chroma(&arg[1]);
-      const vbt_number_t hue = arg[2].value;
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+VBTDEF vbt_pool_t* vbt_pool_create(unsigned threads) {
+  vbt_pool_t* pool;
 
-      return vbt_lch(lightness, chroma, hue, alpha, recv);
-    }
-    case VBT__FUNCTION_LAB: {
-      const vbt_number_t lightness = vbt__css_value_to_percent(&arg[0]);
-      const vbt_number_t a = vbt__css_value_to_lab_ab(&arg[1]);
-      const vbt_number_t b = vbt__css_value_to_lab_ab(&arg[2]);
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  if (threads == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = cpus > 0 ? (unsigned)cpus : 1;
+  }
 
-      return vbt_lab(lightness, a, b, alpha, recv);
-    }
-    case VBT__FUNCTION_OKLCH: {
-      // chroma has same constraints as oklab ab
-      const vbt_number_t lightness = vbt__css_value_to_ok_lightness(&arg[0]);
-      const vbt_number_t chroma = vbt__css_value_to_oklab_ab(&arg[1]);
-      const vbt_number_t hue = arg[2].value;
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  pool = (vbt_pool_t*)malloc(sizeof(vbt_pool_t));
+  if (!pool) {
+    return NULL;
+  }
 
-      return vbt_oklch(lightness, chroma, hue, alpha, recv);
-    }
-    case VBT__FUNCTION_OKLAB: {
-      const vbt_number_t lightness = vbt__css_value_to_ok_lightness(&arg[0]);
-      const vbt_number_t a = vbt__css_value_to_oklab_ab(&arg[1]);
-      const vbt_number_t b = vbt__css_value_to_oklab_ab(&arg[2]);
-      const vbt_number_t alpha = vbt__css_value_to_01(&arg[3]);
+  pool->batch = NULL;
+  pool->generation = 0;
+  pool->running = 0;
+  pool->shutdown = VBT__FALSE;
+  pool->count = threads;
+  pool->workers = (vbt__worker_t*)malloc(threads * sizeof(vbt__worker_t));
+  pool->threads = (pthread_t*)malloc(threads * sizeof(pthread_t));
+
+  if (!pool->workers || !pool->threads ||
+      vbt__pool_init_sync(pool) != VBT_SUCCESS) {
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+    return NULL;
+  }
 
-      return vbt_oklab(lightness, a, b, alpha, recv);
-    }
-    default: {
-      // unreachable
-      return VBT_ERR;
+  for (unsigned i = 0; i < threads; i++) {
+    vbt__worker_t* worker = &pool->workers[i];
+    worker->head = 0;
+    worker->tail = 0;
+    worker->failed = VBT__FALSE;
+    worker->index = i;
+    worker->pool = pool;
+  }
+
+  for (unsigned i = 1; i < threads; i++) {
+    if (pthread_create(&pool->threads[i - 1], NULL, vbt__pool_main,
+                       &pool->workers[i]) != 0) {
+      vbt__pool_free(pool, i - 1);
+      return NULL;
     }
   }
-}
 
-static int vbt__parse_css_color_name(const char* value,
-                                     vbt_size_t len,
-                                     vbt_recv_t* recv) {
-  const vbt__css_color_t* css_color = vbt__find_css_color(value, len);
+  return pool;
+}
 
-  if (css_color->name != NULL) {
-    return vbt__write_u8(recv, css_color->color[0], css_color->color[1],
-                         css_color->color[2], css_color->color[3]);
+VBTDEF void vbt_pool_destroy(vbt_pool_t* pool) {
+  if (pool) {
+    vbt__pool_free(pool, pool->count - 1);
   }
-
-  return VBT_ERR;
 }
 
-// clang-format off
+// the built-in pool, created on first use
+static vbt_pool_t* vbt__default_pool;
+static pthread_mutex_t vbt__default_pool_lock = PTHREAD_MUTEX_INITIALIZER;
 
-/* ANSI-C code produced by gperf version 3.1 */
-/* Command-line: gperf --constants-prefix=VBT__ --null-strings --hash-function-name=vbt__hash --lookup-function-name=vbt__in_word_set --ignore-case -l -t -T css_color_names.gperf  */
-/* Computed positions: -k'1,3,6-8,12-13' */
-/* maximum key range = 557, duplicates = 0 */
+VBTDEF void vbt_pool_destroy_default(void) {
+  pthread_mutex_lock(&vbt__default_pool_lock);
+  vbt_pool_destroy(vbt__default_pool);
+  vbt__default_pool = NULL;
+  pthread_mutex_unlock(&vbt__default_pool_lock);
+}
 
-static vbt_size_t vbt__hash (const char *str, size_t len) {
-  static const unsigned short asso_values[] = {
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 5,   160, 0,   35,  0,   50,  10,  40,  0,   561,
-    170, 10,  95,  85,  60,  80,  135, 0,   20,  45,  10,  50,  205, 35,  95,
-    561, 35,  561, 561, 561, 561, 561, 5,   160, 0,   35,  0,   50,  10,  40,
-    0,   561, 170, 10,  95,  85,  60,  80,  135, 0,   20,  45,  10,  50,  205,
-    35,  95,  561, 35,  561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561, 561,
-    561, 561, 561,
-  };
-  vbt_size_t hval = len;
+// runs batch on pool, or on the calling thread when the batch is a single
+// chunk or no pool can be created
+static int vbt__pool_run(vbt_pool_t* pool, const vbt__batch_t* batch) {
+  vbt_size_t chunks = (batch->count + VBT__BATCH_CHUNK - 1) / VBT__BATCH_CHUNK;
+  int result = VBT_SUCCESS;
 
-  switch (hval) {
-    default:
-      hval += asso_values[(unsigned char)str[12]];
-    /*FALLTHROUGH*/
-    case 12:
-      hval += asso_values[(unsigned char)str[11]];
-    /*FALLTHROUGH*/
-    case 11:
-    case 10:
-    case 9:
-    case 8:
-      hval += asso_values[(unsigned char)str[7]];
-    /*FALLTHROUGH*/
-    case 7:
-      hval += asso_values[(unsigned char)str[6]];
-    /*FALLTHROUGH*/
-    case 6:
-      hval += asso_values[(unsigned char)str[5]];
-    /*FALLTHROUGH*/
-    case 5:
-    case 4:
-    case 3:
-      hval += asso_values[(unsigned char)str[2]+2];
-    /*FALLTHROUGH*/
-    case 2:
-    case 1:
-      hval += asso_values[(unsigned char)str[0]];
-      break;
+  if (!pool) {
+    pthread_mutex_lock(&vbt__default_pool_lock);
+    if (!vbt__default_pool) {
+      vbt__default_pool = vbt_pool_create(0);
+    }
+    pool = vbt__default_pool;
+    pthread_mutex_unlock(&vbt__default_pool_lock);
   }
 
-  return hval;
-}
+  if (!pool || pool->count == 1 || chunks <= 1) {
+    return vbt__batch_run(batch, 0, batch->count);
+  }
 
-static const vbt__css_color_t* vbt__find_css_color(const char* value,
-                                                   vbt_size_t len) {
-  static const unsigned char lengthtable[] = {
-     0,  0,  0,  0,  4,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     4,  0,  0,  0,  0,  0, 10,  0,  0,  0,  4,  5,  0,  0,
-     0,  9, 10,  0,  0,  0,  9,  0,  0,  0,  0,  9,  0,  6,
-     0,  0,  9,  0,  0,  0,  8,  4,  5,  0,  0,  3,  0,  0,
-    11,  0,  0, 14,  0,  0,  7,  0, 14,  0,  6,  0,  0,  9,
-     0,  0,  7,  0,  4,  0,  0,  0,  0,  9, 10,  0,  0,  0,
-     0,  0,  0,  0,  8,  9,  0,  0,  0,  0,  0,  5, 11,  0,
-     0,  4,  0,  6,  0,  0,  9,  0, 11,  0,  8, 14,  0,  6,
-     0,  8,  9,  0,  6,  7,  0,  9,  0,  0,  7,  0,  4,  0,
-    11,  0,  3,  4, 10,  6,  0, 13,  0,  0, 11,  0,  0,  0,
-     5, 11,  0, 13,  9,  0,  0,  0,  0,  0,  0,  0,  7, 13,
-    14,  0,  0,  0,  0,  4, 10, 11,  0, 13,  4,  5,  0,  0,
-     0,  0, 20,  6,  0,  0,  9,  5,  6,  0,  0,  9, 10,  0,
-     0,  8,  9,  0,  0,  0,  8,  9,  0,  0, 12,  0,  9,  0,
-     6,  7,  0,  9, 10,  0,  7,  0,  9,  0,  0, 12,  8,  9,
-     0,  0,  0,  0,  4,  5,  0,  0,  0,  9,  5,  0,  0,  0,
-     9, 10,  0,  0,  0,  9,  0,  6,  7,  8,  0,  5,  6,  0,
-     0,  9,  0, 11,  0,  0,  0,  0,  0,  0, 13,  9,  0,  0,
-    12, 13,  0,  0,  0,  0, 13,  0,  0,  0,  0,  0,  0, 10,
-     0,  0,  0,  0,  0,  0,  0,  8, 14,  0,  0,  0,  0,  9,
-     0,  0, 12, 13,  9,  0,  0,  0,  0,  4,  0,  0,  0, 13,
-     0,  0,  0,  0,  0,  0,  5,  0,  0,  0,  9,  0,  0, 12,
-     8,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     7,  0,  0,  0,  0,  0,  0,  0, 10,  0,  0,  0,  0,  5,
-     0,  0,  0,  0, 10,  0, 12, 13,  0,  0,  0, 12,  0,  0,
-    15,  0,  7,  0, 14, 10,  0,  0,  0,  0,  0,  0,  0,  0,
-     9,  0,  0,  0,  8,  4, 15,  0,  0,  0,  0,  0,  0, 17,
-    13,  0,  5,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  6,
-     0,  0, 14,  0,  0,  0,  0,  0, 10, 16,  0,  0,  0,  0,
-    11,  0,  0,  9,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    10,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0, 11,  0,  0,  0,  0,  0,  0,  0,  0, 10,  0,  0,
-     0,  0,  0, 11,  0,  0,  0, 15,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0, 11,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  9,  0,  0,  0,  0,  0,  0,
-     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    10
-  };
+  pthread_mutex_lock(&pool->submit);
 
-  #define VBT__X {NULL, {0, 0, 0, 0}}
-  #define VBT__C(C, R, G, B, A) {C, {R, G, B, A}}
-
-  static const vbt__css_color_t wordlist[] = {
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("cyan", 0, 255, 255, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("gray", 128, 128, 128, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("chartreuse", 127, 255, 0, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("grey", 128, 128, 128, 255),
-    VBT__C("green", 0, 128, 0, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("lightgrey", 211, 211, 211, 255),
-    VBT__C("lightgreen", 144, 238, 144, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("lightgray", 211, 211, 211, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("slategrey", 112, 128, 144, 255),
-    VBT__X,
-    VBT__C("sienna", 160, 82, 45, 255),
-    VBT__X, VBT__X,
-    VBT__C("slategray", 112, 128, 144, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("seashell", 255, 245, 238, 255),
-    VBT__C("teal", 0, 128, 128, 255),
-    VBT__C("coral", 255, 127, 80, 255),
-    VBT__X, VBT__X,
-    VBT__C("red", 255, 0, 0, 255),
-    VBT__X, VBT__X,
-    VBT__C("lightsalmon", 255, 160, 122, 255),
-    VBT__X, VBT__X,
-    VBT__C("lightslategrey", 119, 136, 153, 255),
-    VBT__X, VBT__X,
-    VBT__C("fuchsia", 255, 0, 255, 255),
-    VBT__X,
-    VBT__C("lightslategray", 119, 136, 153, 255),
-    VBT__X,
-    VBT__C("orange", 255, 165, 0, 255),
-    VBT__X, VBT__X,
-    VBT__C("orangered", 255, 69, 0, 255),
-    VBT__X, VBT__X,
-    VBT__C("skyblue", 135, 206, 235, 255),
-    VBT__X,
-    VBT__C("lime", 0, 255, 0, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("limegreen", 50, 205, 50, 255),
-    VBT__C("lightcoral", 240, 128, 128, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X,
-    VBT__C("lavender", 230, 230, 250, 255),
-    VBT__C("darkgreen", 0, 100, 0, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("linen", 250, 240, 230, 255),
-    VBT__C("springgreen", 0, 255, 127, 255),
-    VBT__X, VBT__X,
-    VBT__C("gold", 255, 215, 0, 255),
-    VBT__X,
-    VBT__C("orchid", 218, 112, 214, 255),
-    VBT__X, VBT__X,
-    VBT__C("firebrick", 178, 34, 34, 255),
-    VBT__X,
-    VBT__C("darkmagenta", 139, 0, 139, 255),
-    VBT__X,
-    VBT__C("darkblue", 0, 0, 139, 255),
-    VBT__C("lightsteelblue", 176, 196, 222, 255),
-    VBT__X,
-    VBT__C("silver", 192, 192, 192, 255),
-    VBT__X,
-    VBT__C("seagreen", 46, 139, 87, 255),
-    VBT__C("lawngreen", 124, 252, 0, 255),
-    VBT__X,
-    VBT__C("indigo", 75, 0, 130, 255),
-    VBT__C("oldlace", 253, 245, 230, 255),
-    VBT__X,
-    VBT__C("lightcyan", 224, 255, 255, 255),
-    VBT__X, VBT__X,
-    VBT__C("darkred", 139, 0, 0, 255),
-    VBT__X,
-    VBT__C("navy", 0, 0, 128, 255),
-    VBT__X,
-    VBT__C("lightyellow", 255, 255, 224, 255),
-    VBT__X,
-    VBT__C("tan", 210, 180, 140, 255),
-    VBT__C("peru", 205, 133, 63, 255),
-    VBT__C("darkorchid", 153, 50, 204, 255),
-    VBT__C("purple", 128, 0, 128, 255),
-    VBT__X,
-    VBT__C("lightseagreen", 32, 178, 170, 255),
-    VBT__X, VBT__X,
-    VBT__C("greenyellow", 173, 255, 47, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("ivory", 255, 255, 240, 255),
-    VBT__C("transparent", 0, 0, 0, 0),
-    VBT__X,
-    VBT__C("rebeccapurple", 102, 51, 153, 255),
-    VBT__C("indianred", 205, 92, 92, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("magenta", 255, 0, 255, 255),
-    VBT__C("lavenderblush", 255, 240, 245, 255),
-    VBT__C("darkolivegreen", 85, 107, 47, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("snow", 255, 250, 250, 255),
-    VBT__C("darkviolet", 148, 0, 211, 255),
-    VBT__C("forestgreen", 34, 139, 34, 255),
-    VBT__X,
-    VBT__C("darkslateblue", 72, 61, 139, 255),
-    VBT__C("pink", 255, 192, 203, 255),
-    VBT__C("black", 0, 0, 0, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("lightgoldenrodyellow", 250, 250, 210, 255),
-    VBT__C("tomato", 255, 99, 71, 255),
-    VBT__X, VBT__X,
-    VBT__C("palegreen", 152, 251, 152, 255),
-    VBT__C("khaki", 240, 230, 140, 255),
-    VBT__C("bisque", 255, 228, 196, 255),
-    VBT__X, VBT__X,
-    VBT__C("turquoise", 64, 224, 208, 255),
-    VBT__C("darkorange", 255, 140, 0, 255),
-    VBT__X, VBT__X,
-    VBT__C("darkgrey", 169, 169, 169, 255),
-    VBT__C("lightpink", 255, 182, 193, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("darkgray", 169, 169, 169, 255),
-    VBT__C("mintcream", 245, 255, 250, 255),
-    VBT__X, VBT__X,
-    VBT__C("darkseagreen", 143, 188, 143, 255),
-    VBT__X,
-    VBT__C("mistyrose", 255, 228, 225, 255),
-    VBT__X,
-    VBT__C("salmon", 250, 128, 114, 255),
-    VBT__C("dimgrey", 105, 105, 105, 255),
-    VBT__X,
-    VBT__C("lightblue", 173, 216, 230, 255),
-    VBT__C("darksalmon", 233, 150, 122, 255),
-    VBT__X,
-    VBT__C("dimgray", 105, 105, 105, 255),
-    VBT__X,
-    VBT__C("chocolate", 210, 105, 30, 255),
-    VBT__X, VBT__X,
-    VBT__C("lemonchiffon", 255, 250, 205, 255),
-    VBT__C("moccasin", 255, 228, 181, 255),
-    VBT__C("slateblue", 106, 90, 205, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("aqua", 0, 255, 255, 255),
-    VBT__C("azure", 240, 255, 255, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("steelblue", 70, 130, 180, 255),
-    VBT__C("wheat", 245, 222, 179, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("royalblue", 65, 105, 225, 255),
-    VBT__C("aquamarine", 127, 255, 212, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("peachpuff", 255, 218, 185, 255),
-    VBT__X,
-    VBT__C("maroon", 128, 0, 0, 255),
-    VBT__C("thistle", 216, 191, 216, 255),
-    VBT__C("cornsilk", 255, 248, 220, 255),
-    VBT__X,
-    VBT__C("olive", 128, 128, 0, 255),
-    VBT__C("violet", 238, 130, 238, 255),
-    VBT__X, VBT__X,
-    VBT__C("cadetblue", 95, 158, 160, 255),
-    VBT__X,
-    VBT__C("saddlebrown", 139, 69, 19, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("darkslategrey", 47, 79, 79, 255),
-    VBT__C("goldenrod", 218, 165, 32, 255),
-    VBT__X, VBT__X,
-    VBT__C("midnightblue", 25, 25, 112, 255),
-    VBT__C("darkslategray", 47, 79, 79, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("darkturquoise", 0, 206, 209, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("dodgerblue", 30, 144, 255, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("darkcyan", 0, 139, 139, 255),
-    VBT__C("mediumseagreen", 60, 179, 113, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("olivedrab", 107, 142, 35, 255),
-    VBT__X, VBT__X,
-    VBT__C("antiquewhite", 250, 235, 215, 255),
-    VBT__C("palevioletred", 219, 112, 147, 255),
-    VBT__C("rosybrown", 188, 143, 143, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("plum", 221, 160, 221, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("darkgoldenrod", 184, 134, 11, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("brown", 165, 42, 42, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("darkkhaki", 189, 183, 107, 255),
-    VBT__X, VBT__X,
-    VBT__C("lightskyblue", 135, 206, 250, 255),
-    VBT__C("deeppink", 255, 20, 147, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X,
-    VBT__C("crimson", 220, 20, 60, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("sandybrown", 244, 164, 96, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("beige", 245, 245, 220, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("papayawhip", 255, 239, 213, 255),
-    VBT__X,
-    VBT__C("mediumpurple", 147, 112, 219, 255),
-    VBT__C("paleturquoise", 175, 238, 238, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("mediumorchid", 186, 85, 211, 255),
-    VBT__X, VBT__X,
-    VBT__C("mediumvioletred", 199, 21, 133, 255),
-    VBT__X,
-    VBT__C("hotpink", 255, 105, 180, 255),
-    VBT__X,
-    VBT__C("cornflowerblue", 100, 149, 237, 255),
-    VBT__C("powderblue", 176, 224, 230, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("aliceblue", 240, 248, 255, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("honeydew", 240, 255, 240, 255),
-    VBT__C("blue", 0, 0, 255, 255),
-    VBT__C("mediumturquoise", 72, 209, 204, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("mediumspringgreen", 0, 250, 154, 255),
-    VBT__C("palegoldenrod", 238, 232, 170, 255),
-    VBT__X,
-    VBT__C("white", 255, 255, 255, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("yellow", 255, 255, 0, 255),
-    VBT__X, VBT__X,
-    VBT__C("blanchedalmond", 255, 235, 205, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("ghostwhite", 248, 248, 255, 255),
-    VBT__C("mediumaquamarine", 102, 205, 170, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("yellowgreen", 154, 205, 50, 255),
-    VBT__X, VBT__X,
-    VBT__C("gainsboro", 220, 220, 220, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("mediumblue", 0, 0, 205, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("navajowhite", 255, 222, 173, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("blueviolet", 138, 43, 226, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__C("floralwhite", 255, 250, 240, 255),
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("mediumslateblue", 123, 104, 238, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X,
-    VBT__C("deepskyblue", 0, 191, 255, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X,
-    VBT__C("burlywood", 222, 184, 135, 255),
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X, VBT__X, VBT__X, VBT__X, VBT__X,
-    VBT__X, VBT__X,
-    VBT__C("whitesmoke", 245, 245, 245, 255)
-  };
-  static const vbt__css_color_t EMPTY = VBT__X;
+  // each worker starts with an even, contiguous share of the chunks
+  for (unsigned i = 0; i < pool->count; i++) {
+    vbt__worker_t* worker = &pool->workers[i];
+    pthread_mutex_lock(&worker->lock);
+    worker->head = chunks * i / pool->count;
+    worker->tail = chunks * (i + 1) / pool->count;
+    worker->failed = VBT__FALSE;
+    pthread_mutex_unlock(&worker->lock);
+  }
 
-  #undef VBT__X
-  #undef VBT__C
+  pthread_mutex_lock(&pool->lock);
+  pool->batch = batch;
+  pool->running = pool->count - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
 
-  // from gperf generated macros
-  const vbt_size_t VBT__MIN_WORD_LENGTH = 3;
-  const vbt_size_t VBT__MAX_WORD_LENGTH = 20;
-  const vbt_size_t VBT__MAX_HASH_VALUE = 560;
+  vbt__pool_work(pool, &pool->workers[0]);
 
-  if (len <= VBT__MAX_WORD_LENGTH && len >= VBT__MIN_WORD_LENGTH) {
-    vbt_size_t key = vbt__hash (value, len);
+  pthread_mutex_lock(&pool->lock);
+  while (pool->running > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pool->batch = NULL;
+  pthread_mutex_unlock(&pool->lock);
 
-    if (key <= VBT__MAX_HASH_VALUE && len == lengthtable[key] && vbt__casecmp(value, wordlist[key].name, len) == 0) {
-      return &wordlist[key];
+  for (unsigned i = 0; i < pool->count; i++) {
+    if (pool->workers[i].failed) {
+      result = VBT_ERR;
     }
   }
 
-  return &EMPTY;
+  pthread_mutex_unlock(&pool->submit);
+  return result;
+}
+
+VBTDEF int vbt_color_resolve_batch_mt(vbt_pool_t* pool,
+                                      vbt_color_t* colors,
+                                      vbt_size_t count,
+                                      vbt_recv_t* recv,
+                                      int* err) {
+  vbt__batch_t batch = {NULL, NULL, colors, recv, err, count};
+
+  if (count > 0 && (!colors || !recv)) {
+    return VBT_ERR;
+  }
+
+  return vbt__pool_run(pool, &batch);
 }
-// clang-format on
 
+#ifndef VIBRANT_NO_PARSE
+VBTDEF int vbt_parse_batch_mt(vbt_pool_t* pool,
+                              const char* const* values,
+                              const vbt_size_t* lens,
+                              vbt_size_t count,
+                              vbt_recv_t* recv,
+                              int* err) {
+  vbt__batch_t batch = {values, lens, NULL, recv, err, count};
+
+  if (count > 0 && (!values || !recv)) {
+    return VBT_ERR;
+  }
+
+  return vbt__pool_run(pool, &batch);
+}
 #endif  // VIBRANT_NO_PARSE
 
+#endif  // VIBRANT_THREADS
+
+#ifdef VIBRANT_DETERMINISTIC
+#if defined(__clang__) || defined(_MSC_VER)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif  // VIBRANT_DETERMINISTIC
+
 #undef VIBRANT_IMPLEMENTATION
 
 #endif  // VIBRANT_IMPLEMENTATION
@@ -0,0 +1,86 @@
+#include "test-common.h"
+
+TEST(vbt_parse_batch) {
+  static const char* const input[] = {
+      "red",
+      "#12345678",
+      "notacolor",
+      "hsl(120 100% 25% / 0.5)",
+      "",
+      "oklch(70% 0.1 200)",
+  };
+  vbt_size_t lens[vu_arr_len(input)];
+  vbt_recv_t recv[vu_arr_len(input)];
+  int err[vu_arr_len(input)];
+  int res;
+
+  for (size_t i = 0; i < vu_arr_len(input); i++) {
+    lens[i] = strlen(input[i]);
+  }
+
+  CASE("zero terminated") {
+    for (size_t i = 0; i < vu_arr_len(input); i++) {
+      recv[i] = vbt_recv_init();
+    }
+
+    res = vbt_parse_batch(input, NULL, vu_arr_len(input), recv, err);
+
+    ASSERT_EQ(res, VBT_ERR);
+    for (size_t i = 0; i < vu_arr_len(input); i++) {
+      vbt_recv_t expected = vbt_recv_init();
+      ASSERT_EQ(err[i], vbt_parse_z(input[i], &expected));
+      if (err[i] == VBT_SUCCESS) {
+        ASSERT_RECV_U8(err[i], recv[i], expected.u.val.u8.r,
+                       expected.u.val.u8.g, expected.u.val.u8.b,
+                       expected.u.val.u8.a);
+      }
+    }
+  }
+
+  CASE("with lengths") {
+    for (size_t i = 0; i < vu_arr_len(input); i++) {
+      recv[i] = vbt_recv_init();
+    }
+
+    res = vbt_parse_batch(input, lens, vu_arr_len(input), recv, err);
+
+    ASSERT_EQ(res, VBT_ERR);
+    ASSERT_EQ(err[0], VBT_SUCCESS);
+    ASSERT_EQ(err[2], VBT_ERR);
+    ASSERT_EQ(err[4], VBT_ERR);
+    ASSERT_RECV_U8(err[1], recv[1], 0x12, 0x34, 0x56, 0x78);
+  }
+
+  CASE("all valid, no err") {
+    for (size_t i = 0; i < 2; i++) {
+      recv[i] = vbt_recv_init();
+    }
+
+    res = vbt_parse_batch(input, lens, 2, recv, NULL);
+
+    ASSERT_EQ(res, VBT_SUCCESS);
+    ASSERT_RECV_U8(res, recv[0], 255, 0, 0, 255);
+  }
+
+  CASE("invalid arguments") {
+    ASSERT_EQ(vbt_parse_batch(NULL, NULL, 1, recv, err), VBT_ERR);
+    ASSERT_EQ(vbt_parse_batch(input, NULL, 1, NULL, err), VBT_ERR);
+    ASSERT_EQ(vbt_parse_batch(NULL, NULL, 0, NULL, NULL), VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_color_resolve_batch) {
+  vbt_color_t colors[3] = {
+      vbt_color_init(VBT_COLOR_RGB, 1, 2, 3, 1),
+      vbt_color_init(VBT_COLOR_HSL, NAN, 0, 0, 1),
+      vbt_color_init(VBT_COLOR_HWB, 0, 0, 0, 1),
+  };
+  vbt_recv_t recv[3] = {vbt_recv_init(), vbt_recv_init(), vbt_recv_init()};
+  int err[3];
+
+  ASSERT_EQ(vbt_color_resolve_batch(colors, 3, recv, err), VBT_ERR);
+  ASSERT_EQ(err[1], VBT_ERR);
+  ASSERT_RECV_U8(err[0], recv[0], 1, 2, 3, 255);
+  ASSERT_RECV_U8(err[2], recv[2], 255, 0, 0, 255);
+  ASSERT_EQ(vbt_color_resolve_batch(NULL, 3, recv, err), VBT_ERR);
+}
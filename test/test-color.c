@@ -549,3 +549,61 @@ TEST(vbt_oklch_errors) {
     ASSERT_EQ(vbt_oklch(0, 0, 0, -INF, &recv), VBT_ERR);
   }
 }
+
+TEST(vbt_color_resolve) {
+  vbt_color_t color;
+  vbt_recv_t recv;
+  int err;
+
+  CASE("same result as conversion function") {
+    vbt_recv_t expected = vbt_recv_init();
+
+    ASSERT_EQ(
+        vbt_oklch((vbt_number_t)0.7, (vbt_number_t)0.1, 200, 1, &expected),
+        VBT_SUCCESS);
+
+    color = vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.7,
+                           (vbt_number_t)0.1, 200, 1);
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, expected.u.val.u8.r, expected.u.val.u8.g,
+                   expected.u.val.u8.b, expected.u.val.u8.a);
+  }
+
+  CASE("conversion is memoized") {
+    color = vbt_color_init(VBT_COLOR_HSL, 0, 100, 50, 1);
+    recv = vbt_recv_init();
+    ASSERT_EQ(vbt_color_resolve(&color, &recv), VBT_SUCCESS);
+
+    // args are not looked at once the color is resolved
+    color.arg[0] = 120;
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, 255, 0, 0, 255);
+  }
+
+  CASE("rgb keeps u8 values") {
+    double r, g, b, a;
+
+    color = vbt_color_init(VBT_COLOR_RGB, 50, 100, 200, 1);
+    recv = vbt_recv_init_ref_f64(&r, &g, &b, &a);
+    ASSERT_EQ(vbt_color_resolve(&color, &recv), VBT_SUCCESS);
+    ASSERT_DOUBLE_EQ(r, 50.0 / 255.0);
+    ASSERT_DOUBLE_EQ(g, 100.0 / 255.0);
+    ASSERT_DOUBLE_EQ(b, 200.0 / 255.0);
+    ASSERT_DOUBLE_EQ(a, 1.0);
+  }
+
+  CASE("errors") {
+    recv = vbt_recv_init();
+    color = vbt_color_init(VBT_COLOR_LAB, 0, 0, 0, 1);
+    ASSERT_EQ(vbt_color_resolve(NULL, &recv), VBT_ERR);
+    ASSERT_EQ(vbt_color_resolve(&color, NULL), VBT_ERR);
+
+    color = vbt_color_init(VBT_COLOR_NONE, 0, 0, 0, 1);
+    ASSERT_EQ(vbt_color_resolve(&color, &recv), VBT_ERR);
+
+    color = vbt_color_init(VBT_COLOR_LAB, NAN, 0, 0, 1);
+    ASSERT_EQ(vbt_color_resolve(&color, &recv), VBT_ERR);
+  }
+}
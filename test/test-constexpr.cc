@@ -0,0 +1,152 @@
+#include "test-common.h"
+
+using namespace vbt::literals;
+
+static_assert(vbt::parse("#6495ed") == vbt::rgba8{100, 149, 237, 255}, "");
+static_assert("cornflowerblue"_vbt == vbt::rgba8{100, 149, 237, 255}, "");
+static_assert("rgb(255 0 0 / 50%)"_vbt == vbt::rgba8{255, 0, 0, 128}, "");
+static_assert("hsl(120, 100%, 50%)"_vbt == "lime"_vbt, "");
+static_assert("rgb(calc(1 + 2) 0 0)"_vbt == vbt::rgba8{3, 0, 0, 255}, "");
+static_assert(vbt::relative("rgb(from var b g r)", "blue") == "red"_vbt, "");
+
+// asserts that vbt::parse() evaluated by the compiler matches vbt_parse()
+#define ASSERT_CONSTEXPR_PARSE(STR)                                \
+  do {                                                             \
+    constexpr vbt::rgba8 color = vbt::parse(STR);                  \
+    vbt_recv_t recv = vbt_recv_init();                             \
+    int err = vbt_parse_z(STR, &recv);                             \
+    ASSERT_RECV_U8(err, recv, color.r, color.g, color.b, color.a); \
+  } while (0)
+
+TEST(vbt_constexpr_parse) {
+  CASE("hex") {
+    ASSERT_CONSTEXPR_PARSE("#fff");
+    ASSERT_CONSTEXPR_PARSE("#0a0b");
+    ASSERT_CONSTEXPR_PARSE("#C0FFEE");
+    ASSERT_CONSTEXPR_PARSE("#12345678");
+  }
+
+  CASE("names") {
+    ASSERT_CONSTEXPR_PARSE("red");
+    ASSERT_CONSTEXPR_PARSE("CornflowerBlue");
+    ASSERT_CONSTEXPR_PARSE("lightgoldenrodyellow");
+    ASSERT_CONSTEXPR_PARSE("transparent");
+  }
+
+  CASE("rgb") {
+    ASSERT_CONSTEXPR_PARSE("rgb(255, 128, 0)");
+    ASSERT_CONSTEXPR_PARSE("rgba(10%, 20%, 30%, 0.4)");
+    ASSERT_CONSTEXPR_PARSE("rgb( 12.5 300 -4 / 25% )");
+    ASSERT_CONSTEXPR_PARSE("rgb(1e2 2.5E1 +7)");
+    ASSERT_CONSTEXPR_PARSE("rgb(1e-33 1.00000000000000000000 0)");
+  }
+
+  CASE("hsl and hwb") {
+    ASSERT_CONSTEXPR_PARSE("hsl(180.0, 50%, 50%)");
+    ASSERT_CONSTEXPR_PARSE("hsla(-30, 80%, 40%, 0.5)");
+    ASSERT_CONSTEXPR_PARSE("hsl(725 100 25 / 1)");
+    ASSERT_CONSTEXPR_PARSE("hwb(90 10% 20%)");
+    ASSERT_CONSTEXPR_PARSE("hwb(200 60% 70%)");
+  }
+
+  CASE("lab and lch") {
+    ASSERT_CONSTEXPR_PARSE("lab(52.2345% 40.1645 59.9971)");
+    ASSERT_CONSTEXPR_PARSE("lab(29% 20% -40% / 0.5)");
+    ASSERT_CONSTEXPR_PARSE("lch(52.2345% 72.2 56.2)");
+    ASSERT_CONSTEXPR_PARSE("lch(80 30% 300)");
+  }
+
+  CASE("oklab and oklch") {
+    ASSERT_CONSTEXPR_PARSE("oklab(40.1% 0.1143 0.045)");
+    ASSERT_CONSTEXPR_PARSE("oklab(0.5 -20% 30%)");
+    ASSERT_CONSTEXPR_PARSE("oklch(70% 0.1 200)");
+    ASSERT_CONSTEXPR_PARSE("oklch(0.4 0.2 -90 / 75%)");
+  }
+
+  CASE("out of gamut") {
+    ASSERT_CONSTEXPR_PARSE("oklch(90% 0.4 30)");
+    ASSERT_CONSTEXPR_PARSE("lab(90% -120 100)");
+  }
+
+  CASE("calc") {
+    ASSERT_CONSTEXPR_PARSE("rgb(calc(255 / 3) calc(10% * 2) 0)");
+    ASSERT_CONSTEXPR_PARSE("hsl(calc(360 - 90) 50% calc((20% + 10%) * 2))");
+  }
+
+  CASE("color-mix") {
+    ASSERT_CONSTEXPR_PARSE("color-mix(in srgb, red, blue)");
+    ASSERT_CONSTEXPR_PARSE("color-mix(in srgb-linear, red 30%, #00f8)");
+    ASSERT_CONSTEXPR_PARSE("color-mix(in lab, teal, orange)");
+    ASSERT_CONSTEXPR_PARSE("color-mix(in oklch longer hue, red, blue 75%)");
+  }
+}
+
+// asserts that vbt::relative() evaluated by the compiler matches
+// vbt_relative_apply()
+#define ASSERT_CONSTEXPR_RELATIVE(STR, ORIGIN)                     \
+  do {                                                             \
+    constexpr vbt::rgba8 color = vbt::relative(STR, ORIGIN);       \
+    vbt_relative_t rel;                                            \
+    vbt_color_t origin, result;                                    \
+    vbt_recv_t recv = vbt_recv_init();                             \
+    ASSERT_EQ(vbt_relative_compile_z(STR, &rel), VBT_SUCCESS);     \
+    ASSERT_EQ(vbt_parse_color_z(ORIGIN, &origin), VBT_SUCCESS);    \
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &result),          \
+              VBT_SUCCESS);                                        \
+    int err = vbt_color_resolve(&result, &recv);                   \
+    ASSERT_RECV_U8(err, recv, color.r, color.g, color.b, color.a); \
+  } while (0)
+
+TEST(vbt_constexpr_relative) {
+  ASSERT_CONSTEXPR_RELATIVE("rgb(from var r g b / 50%)", "teal");
+  ASSERT_CONSTEXPR_RELATIVE("hsl(from var calc(h + 180) s l)", "#6495ed");
+  ASSERT_CONSTEXPR_RELATIVE("oklch(from var l c calc(h + 180))", "teal");
+  ASSERT_CONSTEXPR_RELATIVE("lab(from var calc(l * 0.5) a b / alpha)",
+                            "color-mix(in srgb, red, blue)");
+}
+
+TEST(vbt_constexpr_parse_err) {
+  static const char* const input[] = {
+      "",
+      "#ff",
+      "#ggg",
+      "notacolor",
+      "rgb(1, 2)",
+      "rgb(1 2, 3)",
+      "rgba(1 2 3)",
+      "hsl(1, 2 3)",
+      "oklch(1e99 0 0)",
+      "rgb(- 0 0)",
+      "rgb(. 0 0)",
+      "rgb(calc(1 +) 0 0)",
+      "color-mix(in srgb, red)",
+  };
+
+  for (size_t i = 0; i < vu_arr_len(input); i++) {
+    CASE(input[i]) {
+      vbt::rgba8 color{1, 2, 3, 4};
+      ASSERT_EQ(vbt::parse(input[i], strlen(input[i]), color), VBT_ERR);
+      ASSERT_EQ(vbt_validate_z(input[i]), VBT_ERR);
+    }
+  }
+
+  CASE("char array") {
+    // only the string up to the first NUL is parsed, at runtime
+    constexpr vbt::rgba8 red = "red"_vbt;
+    char buf[32] = {0};
+    vbt::rgba8 color{1, 2, 3, 4};
+    strcpy(buf, "red");
+    ASSERT_EQ(vbt::parse(buf, color), VBT_SUCCESS);
+    ASSERT_EQ(color == red, true);
+    strcpy(buf, "nope");
+    ASSERT_EQ(vbt::parse(buf, color), VBT_ERR);
+  }
+
+  CASE("relative") {
+    vbt::rgba8 color{1, 2, 3, 4};
+    ASSERT_EQ(vbt::relative("rgb(from var r g)", 17, "red", 3, color),
+              VBT_ERR);
+    ASSERT_EQ(vbt::relative("rgb(from var r g b)", 19, "nope", 4, color),
+              VBT_ERR);
+  }
+}
@@ -0,0 +1,64 @@
+#include "test-common.h"
+
+// VIBRANT_DETERMINISTIC results, bit for bit. these must not change across
+// platforms, compilers or compiler flags.
+TEST(vbt_deterministic) {
+  vbt_color_t colors[] = {
+      vbt_color_init(VBT_COLOR_HSL, 725, 80, 40, 1),
+      vbt_color_init(VBT_COLOR_LAB, 52.2345f, 40.1645f, 59.9971f, 1),
+      vbt_color_init(VBT_COLOR_LCH, 52.2345f, 72.2f, 56.2f, 1),
+      vbt_color_init(VBT_COLOR_OKLAB, 0.401f, 0.1143f, 0.045f, 1),
+      vbt_color_init(VBT_COLOR_OKLCH, 0.7f, 0.1f, -3000.5f, 1),
+      vbt_color_init(VBT_COLOR_LCH, 60, 40, 123, 1),
+  };
+  // clang-format off
+#if defined(VIBRANT_DOUBLE_PRECISION)
+  static const vbt_number_t expected[][3] = {
+      {0x1.70a3d70a3d70bp-1, 0x1.111111111110ap-3, 0x1.47ae147ae1478p-4},
+      {0x1.96c57802c7ee4p-1, 0x1.726f2dec0b071p-2, 0x1.86af793e1f96fp-6},
+      {0x1.96c57e3e7526cp-1, 0x1.726f236f59bedp-2, 0x1.86b1a816a2b56p-6},
+      {0x1.f599c9835d2a3p-2, 0x1.1e0af4260bd45p-3, 0x1.47bbbbef5da97p-3},
+      {0x1.803fcfe9c8741p-2, 0x1.4edf5e5d646fep-1, 0x1.adec7a5f6c97p-1},
+      {0x1.fae3ca144a809p-2, 0x1.34be73746d2d1p-1, 0x1.502c0e39e29afp-2},
+  };
+#else
+  static const vbt_number_t expected[][3] = {
+      {0x1.70a3d8p-1f, 0x1.11111cp-3f, 0x1.47ae1p-4f},
+      {0x1.96c574p-1f, 0x1.726f2cp-2f, 0x1.86af22p-6f},
+      {0x1.96c578p-1f, 0x1.726f22p-2f, 0x1.86b14p-6f},
+      {0x1.f599c8p-2f, 0x1.1e0ae8p-3f, 0x1.47bbbcp-3f},
+      {0x1.803fdep-2f, 0x1.4edf5cp-1f, 0x1.adec7cp-1f},
+      {0x1.fae3c8p-2f, 0x1.34be72p-1f, 0x1.502c1p-2f},
+  };
+#endif
+  // clang-format on
+
+  for (size_t i = 0; i < vu_arr_len(colors); i++) {
+    CASE("conversion") {
+      ASSERT_EQ(vbt_color_eval(&colors[i]), VBT_SUCCESS);
+      ASSERT_EQ(colors[i].srgb.n[0] == expected[i][0], 1);
+      ASSERT_EQ(colors[i].srgb.n[1] == expected[i][1], 1);
+      ASSERT_EQ(colors[i].srgb.n[2] == expected[i][2], 1);
+    }
+  }
+
+  CASE("non-finite and huge arguments") {
+    // these used to loop forever in the math replacements
+    vbt_color_t odd[] = {
+        vbt_color_init(VBT_COLOR_HSL, INFINITY, 50, 50, 1),
+        vbt_color_init(VBT_COLOR_HWB, -INFINITY, 10, 10, 1),
+        vbt_color_init(VBT_COLOR_LCH, 50, 40, NAN, 1),
+        vbt_color_init(VBT_COLOR_OKLCH, 0.5f, 0.1f, INFINITY, 1),
+        vbt_color_init(VBT_COLOR_LAB, 50, 1e30f, -1e30f, 1),
+        vbt_color_init(VBT_COLOR_OKLAB, 0, 0, 0, 1),
+    };
+
+    for (size_t i = 0; i < vu_arr_len(odd); i++) {
+      vbt_recv_t recv = vbt_recv_init();
+      vbt_color_resolve(&odd[i], &recv);
+    }
+
+    ASSERT_EQ(vbt_color_eval(&odd[vu_arr_len(odd) - 1]), VBT_SUCCESS);
+    ASSERT_EQ(odd[vu_arr_len(odd) - 1].srgb.n[0] == 0, 1);
+  }
+}
@@ -0,0 +1,131 @@
+#include "test-common.h"
+
+#include <array>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// enough items for a parallel backend to split the range
+#define EXECUTION_LEN (10007)
+
+static const char* const execution_input[] = {
+    "red",
+    "#abc",
+    "lightgoldenrodyellow",
+    "rgba(10%, 20%, 30%, 0.4)",
+    "oklch(0.4 0.2 -90 / 75%)",
+    "notacolor",
+};
+
+TEST(vbt_transform_parse) {
+  std::vector<std::string> values;
+  std::vector<vbt::rgba8> colors(EXECUTION_LEN);
+  std::vector<int> err(EXECUTION_LEN);
+
+  for (size_t i = 0; i < EXECUTION_LEN; i++) {
+    values.push_back(execution_input[i % vu_arr_len(execution_input)]);
+  }
+
+  CASE("par_unseq") {
+    auto end = vbt::transform_parse(std::execution::par_unseq, values.begin(),
+                                    values.end(), colors.begin());
+    ASSERT_EQ(end == colors.end(), true);
+
+    for (size_t i = 0; i < EXECUTION_LEN; i++) {
+      vbt::rgba8 expected = {0, 0, 0, 0};
+      vbt::parse(values[i].data(), values[i].size(), expected);
+      ASSERT_EQ(colors[i] == expected, true);
+    }
+  }
+
+  CASE("err") {
+    auto end = vbt::transform_parse(std::execution::par, values.begin(),
+                                    values.end(), colors.begin(), err.begin());
+    ASSERT_EQ(end == colors.end(), true);
+
+    for (size_t i = 0; i < EXECUTION_LEN; i++) {
+      vbt::rgba8 expected = {0, 0, 0, 0};
+      ASSERT_EQ(err[i], vbt::parse_z(values[i].c_str(), expected));
+      ASSERT_EQ(colors[i] == expected, true);
+    }
+  }
+
+  CASE("err, not contiguous") {
+    std::deque<std::string> chunks(values.begin(), values.end());
+    auto end = vbt::transform_parse(std::execution::par, chunks.begin(),
+                                    chunks.end(), colors.begin(), err.begin());
+    ASSERT_EQ(end == colors.end(), true);
+
+    for (size_t i = 0; i < EXECUTION_LEN; i++) {
+      vbt::rgba8 expected = {0, 0, 0, 0};
+      ASSERT_EQ(err[i], vbt::parse_z(chunks[i].c_str(), expected));
+      ASSERT_EQ(colors[i] == expected, true);
+    }
+  }
+
+  CASE("string_view, rgba_f32") {
+    std::array<std::string_view, 2> views = {"#ff000080", "bad"};
+    std::array<vbt::rgba_f32, 2> out;
+
+    vbt::transform_parse(std::execution::seq, views.begin(), views.end(),
+                         out.begin());
+
+    ASSERT_FLOAT_EQ(out[0].r, 1.0f);
+    ASSERT_FLOAT_EQ(out[0].a, 128.0f / 255.0f);
+    ASSERT_FLOAT_EQ(out[1].r, 0.0f);
+    ASSERT_FLOAT_EQ(out[1].a, 0.0f);
+  }
+}
+
+TEST(vbt_transform_color) {
+  std::vector<std::tuple<float, float, float, float>> args;
+  std::vector<vbt_color_t> colors;
+  std::vector<vbt::rgba8> out(EXECUTION_LEN);
+
+  for (size_t i = 0; i < EXECUTION_LEN; i++) {
+    float hue = (float)(i % 360);
+    args.emplace_back(hue, 100.0f, 50.0f, 1.0f);
+    colors.push_back(vbt_color_init(VBT_COLOR_HSL, hue, 100, 50, 1));
+  }
+  colors[7].arg[0] = NAN;
+
+  CASE("tuples") {
+    vbt::transform_color(std::execution::par_unseq, VBT_COLOR_HSL,
+                         args.begin(), args.end(), out.begin());
+
+    for (size_t i = 0; i < EXECUTION_LEN; i++) {
+      vbt::rgba8 expected;
+      vbt::hsl(std::get<0>(args[i]), 100, 50, 1, expected);
+      ASSERT_EQ(out[i] == expected, true);
+    }
+  }
+
+  CASE("colors") {
+    vbt::transform_color(std::execution::par, colors.begin(), colors.end(),
+                         out.begin());
+
+    const vbt::rgba8 transparent = {0, 0, 0, 0};
+    ASSERT_EQ(out[7] == transparent, true);
+    for (size_t i = 0; i < EXECUTION_LEN; i++) {
+      vbt::rgba8 expected = {0, 0, 0, 0};
+      vbt::color_resolve(colors[i], expected);
+      ASSERT_EQ(out[i] == expected, true);
+    }
+  }
+
+  CASE("arrays, rgba_f64") {
+    std::array<double, 4> oklab[] = {{0.5, 0.1, -0.1, 1}, {0, 0, 0, INF}};
+    vbt::rgba_f64 result[2];
+    vbt::rgba_f64 expected = {0, 0, 0, 0};
+
+    vbt::transform_color(std::execution::unseq, VBT_COLOR_OKLAB, oklab,
+                         oklab + 2, result);
+
+    vbt::oklab(0.5f, 0.1f, -0.1f, 1, expected);
+    ASSERT_DOUBLE_EQ(result[0].r, expected.r);
+    ASSERT_DOUBLE_EQ(result[0].b, expected.b);
+    ASSERT_DOUBLE_EQ(result[1].a, 0.0);
+  }
+}
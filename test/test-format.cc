@@ -0,0 +1,146 @@
+#include "test-common.h"
+
+TEST(vbt_format_values) {
+  int err;
+
+  CASE("rgba8") {
+    vbt::rgba8 out;
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(out.r, 50);
+    ASSERT_EQ(out.g, 100);
+    ASSERT_EQ(out.b, 200);
+    ASSERT_EQ(out.a, 255);
+  }
+
+  CASE("rgba_f32") {
+    vbt::rgba_f32 out;
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out.r, 50.0f / 255.0f);
+    ASSERT_FLOAT_EQ(out.g, 100.0f / 255.0f);
+    ASSERT_FLOAT_EQ(out.b, 200.0f / 255.0f);
+    ASSERT_FLOAT_EQ(out.a, 255.0f / 255.0f);
+  }
+
+  CASE("rgba_f64") {
+    vbt::rgba_f64 out;
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_DOUBLE_EQ(out.r, 50.0 / 255.0);
+    ASSERT_DOUBLE_EQ(out.g, 100.0 / 255.0);
+    ASSERT_DOUBLE_EQ(out.b, 200.0 / 255.0);
+    ASSERT_DOUBLE_EQ(out.a, 255.0 / 255.0);
+  }
+}
+
+TEST(vbt_format_refs) {
+  int err;
+
+  CASE("ref_u8") {
+    vbt_u8_t r, g, b, a;
+    vbt::ref_u8 out = {&r, &g, &b, &a};
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(r, 50);
+    ASSERT_EQ(g, 100);
+    ASSERT_EQ(b, 200);
+    ASSERT_EQ(a, 255);
+  }
+
+  CASE("ref_f32") {
+    float r, g, b, a;
+    vbt::ref_f32 out = {&r, &g, &b, &a};
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(r, 50.0f / 255.0f);
+    ASSERT_FLOAT_EQ(g, 100.0f / 255.0f);
+    ASSERT_FLOAT_EQ(b, 200.0f / 255.0f);
+    ASSERT_FLOAT_EQ(a, 255.0f / 255.0f);
+  }
+
+  CASE("ref_f64") {
+    double r, g, b, a;
+    vbt::ref_f64 out = {&r, &g, &b, &a};
+    err = vbt::rgb(50, 100, 200, 1, out);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_DOUBLE_EQ(r, 50.0 / 255.0);
+    ASSERT_DOUBLE_EQ(g, 100.0 / 255.0);
+    ASSERT_DOUBLE_EQ(b, 200.0 / 255.0);
+    ASSERT_DOUBLE_EQ(a, 255.0 / 255.0);
+  }
+}
+
+// every format must receive what the matching vbt_recv_tag_t receives
+TEST(vbt_format_matches_recv) {
+  static const char* const input[] = {
+      "#abcdef80",
+      "cornflowerblue",
+      "hsl(120 100% 25% / 0.3)",
+      "oklch(70% 0.1 200)",
+      "lab(29% 20% -40%)",
+  };
+
+  for (size_t i = 0; i < vu_arr_len(input); i++) {
+    CASE(input[i]) {
+      vbt_recv_t recv_u8 = vbt_recv_init_tag(VBT_RECV_VAL_U8);
+      vbt_recv_t recv_f32 = vbt_recv_init_tag(VBT_RECV_VAL_F32);
+      vbt_recv_t recv_f64 = vbt_recv_init_tag(VBT_RECV_VAL_F64);
+      vbt::rgba8 u8;
+      vbt::rgba_f32 f32;
+      vbt::rgba_f64 f64;
+      double r, g, b, a;
+      vbt::ref_f64 ref = {&r, &g, &b, &a};
+
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_u8), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_f32), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_f64), VBT_SUCCESS);
+      ASSERT_EQ(vbt::parse_z(input[i], u8), VBT_SUCCESS);
+      ASSERT_EQ(vbt::parse_z(input[i], f32), VBT_SUCCESS);
+      ASSERT_EQ(vbt::parse(input[i], strlen(input[i]), f64), VBT_SUCCESS);
+      ASSERT_EQ(vbt::parse_z(input[i], ref), VBT_SUCCESS);
+
+      ASSERT_RECV_U8(VBT_SUCCESS, recv_u8, u8.r, u8.g, u8.b, u8.a);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.r, f32.r);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.g, f32.g);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.b, f32.b);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.a, f32.a);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.r, f64.r);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.g, f64.g);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.b, f64.b);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.a, f64.a);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.r, r);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.a, a);
+    }
+  }
+}
+
+TEST(vbt_format_errors) {
+  vbt::rgba8 out = {1, 2, 3, 4};
+
+  CASE("invalid color string") {
+    ASSERT_EQ(vbt::parse_z("rgb(1, 2)", out), VBT_ERR);
+    ASSERT_EQ(vbt::parse("red", 0, out), VBT_ERR);
+    ASSERT_EQ(out.r, 1);
+  }
+
+  CASE("arg = NAN") {
+    ASSERT_EQ(vbt::oklab(NAN, 0, 0, 1, out), VBT_ERR);
+    ASSERT_EQ(vbt::hsl(0, 0, 0, NAN, out), VBT_ERR);
+    ASSERT_EQ(out.r, 1);
+  }
+
+  CASE("arg = INF") {
+    ASSERT_EQ(vbt::lch(INF, 0, 0, 1, out), VBT_ERR);
+    ASSERT_EQ(vbt::oklch(0, 0, -INF, 1, out), VBT_ERR);
+    ASSERT_EQ(vbt::hwb(0, INF, 0, 1, out), VBT_ERR);
+    ASSERT_EQ(vbt::lab(0, 0, INF, 1, out), VBT_ERR);
+    ASSERT_EQ(out.r, 1);
+  }
+}
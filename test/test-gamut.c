@@ -0,0 +1,76 @@
+#include "test-common.h"
+
+// a JND in OKLab, plus the rounding of the result to u8
+#define GAMUT_MAX_ERROR 0.025
+#define GAMUT_RAD (3.14159265358979323846 / 180)
+
+TEST(vbt_gamut_map) {
+  vbt_recv_t recv;
+  int err;
+
+  CASE("in gamut colors are not changed") {
+    recv = vbt_recv_init();
+    err = vbt_oklch((vbt_number_t)0.7, (vbt_number_t)0.1, 200, 1, &recv);
+    ASSERT_RECV_U8(err, recv, 64, 177, 183, 255);
+  }
+
+  CASE("colors that clamp to less than a JND are clamped") {
+    recv = vbt_recv_init();
+    err = vbt_lab((vbt_number_t)53.23, (vbt_number_t)80.11, (vbt_number_t)67.22,
+                  1, &recv);
+    ASSERT_RECV_U8(err, recv, 255, 0, 0, 255);
+  }
+
+  CASE("lightness out of range is black or white") {
+    recv = vbt_recv_init();
+    err = vbt_oklch(1, (vbt_number_t)0.3, 30, 1, &recv);
+    ASSERT_RECV_U8(err, recv, 255, 255, 255, 255);
+    err = vbt_oklch(0, (vbt_number_t)0.3, 30, 1, &recv);
+    ASSERT_RECV_U8(err, recv, 0, 0, 0, 255);
+    err = vbt_lab(100, 60, 0, 1, &recv);
+    ASSERT_RECV_U8(err, recv, 255, 255, 255, 255);
+  }
+
+  CASE("alpha is kept") {
+    recv = vbt_recv_init();
+    err = vbt_oklch((vbt_number_t)0.6, (vbt_number_t)0.4, 30,
+                    (vbt_number_t)0.5, &recv);
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(recv.u.val.u8.a, 128);
+  }
+}
+
+// mapped colors keep their Oklch lightness and hue, and only lose chroma
+TEST(vbt_gamut_map_keeps_hue) {
+  CASE("oklch") {
+    double max_error = 0;
+    int lowered = 0;
+
+    for (int l = 3; l <= 9; l++) {
+      for (int c = 2; c <= 4; c++) {
+        for (int h = 0; h < 360; h += 10) {
+          vbt_color_t color =
+              vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)l / 10,
+                             (vbt_number_t)c / 10, (vbt_number_t)h, 1);
+          vbt_number_t out[4];
+          double dl, da, db, e;
+
+          ASSERT_EQ(vbt_to_oklch(&color, out), VBT_SUCCESS);
+
+          // distance to the color of the same chroma, at the input
+          // lightness and hue
+          dl = out[0] - l / 10.0;
+          da = out[1] * (cos(out[2] * GAMUT_RAD) - cos(h * GAMUT_RAD));
+          db = out[1] * (sin(out[2] * GAMUT_RAD) - sin(h * GAMUT_RAD));
+          e = sqrt(dl * dl + da * da + db * db);
+
+          max_error = e > max_error ? e : max_error;
+          lowered += out[1] < c / 10.0;
+        }
+      }
+    }
+
+    ASSERT_EQ(max_error < GAMUT_MAX_ERROR, 1);
+    ASSERT_EQ(lowered > 700, 1);
+  }
+}
@@ -0,0 +1,149 @@
+#include "test-common.h"
+
+TEST(vbt_typed_receivers) {
+  int err;
+
+  CASE("u8") {
+    vbt_u8_t rgba[4];
+    err = vbt_parse_z_u8("hsl(120 100% 25% / 0.5)", rgba);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(rgba[0], 0);
+    ASSERT_EQ(rgba[1], 128);
+    ASSERT_EQ(rgba[2], 0);
+    ASSERT_EQ(rgba[3], 128);
+  }
+
+  CASE("f32") {
+    float rgba[4];
+    err = vbt_parse_f32("#3264c8", 7, rgba);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(rgba[0], 50.0f / 255.0f);
+    ASSERT_FLOAT_EQ(rgba[1], 100.0f / 255.0f);
+    ASSERT_FLOAT_EQ(rgba[2], 200.0f / 255.0f);
+    ASSERT_FLOAT_EQ(rgba[3], 1.0f);
+  }
+
+  CASE("f64") {
+    double rgba[4];
+    vbt_color_t color = vbt_color_init(VBT_COLOR_HWB, 0, 0, 0, 1);
+    err = vbt_color_resolve_f64(&color, rgba);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_DOUBLE_EQ(rgba[0], 1.0);
+    ASSERT_DOUBLE_EQ(rgba[1], 0.0);
+    ASSERT_DOUBLE_EQ(rgba[2], 0.0);
+    ASSERT_DOUBLE_EQ(rgba[3], 1.0);
+  }
+
+  CASE("u32 is packed 0xRRGGBBAA") {
+    uint32_t rgba = 0;
+    err = vbt_parse_z_u32("#12345678", &rgba);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(rgba, 0x12345678u);
+  }
+
+  CASE("errors") {
+    vbt_u8_t rgba[4];
+    uint32_t packed;
+    vbt_color_t color = vbt_color_init(VBT_COLOR_LAB, NAN, 0, 0, 1);
+
+    ASSERT_EQ(vbt_parse_z_u8("rgb(1, 2)", rgba), VBT_ERR);
+    ASSERT_EQ(vbt_parse_u32("red", 0, &packed), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z_f32("red", NULL), VBT_ERR);
+    ASSERT_EQ(vbt_color_resolve_u8(&color, rgba), VBT_ERR);
+    ASSERT_EQ(vbt_color_resolve_u8(NULL, rgba), VBT_ERR);
+  }
+}
+
+// every typed receiver must receive what the matching vbt_recv_t receives
+TEST(vbt_typed_receivers_match_recv) {
+  static const char* const input[] = {
+      "#abcdef80",
+      "cornflowerblue",
+      "hsl(120 100% 25% / 0.3)",
+      "oklch(70% 0.1 200)",
+      "lab(29% 20% -40%)",
+  };
+
+  for (size_t i = 0; i < vu_arr_len(input); i++) {
+    CASE(input[i]) {
+      vbt_recv_t recv_u8 = vbt_recv_init_tag(VBT_RECV_VAL_U8);
+      vbt_recv_t recv_f32 = vbt_recv_init_tag(VBT_RECV_VAL_F32);
+      vbt_recv_t recv_f64 = vbt_recv_init_tag(VBT_RECV_VAL_F64);
+      vbt_u8_t u8[4];
+      float f32[4];
+      double f64[4];
+      uint32_t packed;
+
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_u8), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_f32), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z(input[i], &recv_f64), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z_to(input[i], u8), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z_to(input[i], f32), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_to(input[i], strlen(input[i]), f64), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z_to(input[i], &packed), VBT_SUCCESS);
+
+      ASSERT_RECV_U8(VBT_SUCCESS, recv_u8, u8[0], u8[1], u8[2], u8[3]);
+      ASSERT_EQ(packed, ((uint32_t)u8[0] << 24) | ((uint32_t)u8[1] << 16) |
+                            ((uint32_t)u8[2] << 8) | u8[3]);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.r, f32[0]);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.g, f32[1]);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.b, f32[2]);
+      ASSERT_FLOAT_EQ(recv_f32.u.val.f32.a, f32[3]);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.r, f64[0]);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.g, f64[1]);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.b, f64[2]);
+      ASSERT_DOUBLE_EQ(recv_f64.u.val.f64.a, f64[3]);
+    }
+  }
+}
+
+TEST(vbt_typed_conversions) {
+  vbt_u8_t u8[4];
+  float f32[4];
+  int err;
+
+  CASE("rgb") {
+    err = vbt_rgb_to(50, 100, 200, (vbt_number_t)0.5, u8);
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(u8[0], 50);
+    ASSERT_EQ(u8[3], 128);
+  }
+
+  CASE("hsl, hwb") {
+    ASSERT_EQ(vbt_hsl_to(0, 100, 50, 1, u8), VBT_SUCCESS);
+    ASSERT_EQ(u8[0], 255);
+    ASSERT_EQ(vbt_hwb_to(0, 100, 100, 1, f32), VBT_SUCCESS);
+#ifdef VIBRANT_FIXED_POINT
+    // float receivers get the u8 color
+    ASSERT_FLOAT_EQ(f32[0], 128 / 255.0f);
+#else
+    ASSERT_FLOAT_EQ(f32[0], 0.5f);
+#endif
+  }
+
+  CASE("lab, lch, oklab, oklch") {
+    vbt_recv_t recv = vbt_recv_init();
+
+    ASSERT_EQ(vbt_lab_to(50, 20, -30, 1, u8), VBT_SUCCESS);
+    ASSERT_RECV_U8(vbt_lab(50, 20, -30, 1, &recv), recv, u8[0], u8[1], u8[2],
+                   u8[3]);
+    ASSERT_EQ(vbt_lch_to(50, 20, 30, 1, u8), VBT_SUCCESS);
+    ASSERT_RECV_U8(vbt_lch(50, 20, 30, 1, &recv), recv, u8[0], u8[1], u8[2],
+                   u8[3]);
+    ASSERT_EQ(vbt_oklab_to(0.5f, 0.1f, -0.1f, 1, u8), VBT_SUCCESS);
+    ASSERT_RECV_U8(vbt_oklab(0.5f, 0.1f, -0.1f, 1, &recv), recv, u8[0], u8[1],
+                   u8[2], u8[3]);
+    ASSERT_EQ(vbt_oklch_to(0.5f, 0.1f, 200, 1, u8), VBT_SUCCESS);
+    ASSERT_RECV_U8(vbt_oklch(0.5f, 0.1f, 200, 1, &recv), recv, u8[0], u8[1],
+                   u8[2], u8[3]);
+  }
+
+  CASE("non-finite arguments") {
+    ASSERT_EQ(vbt_oklab_to(NAN, 0, 0, 1, f32), VBT_ERR);
+    ASSERT_EQ(vbt_hsl_to(0, 0, 0, INF, u8), VBT_ERR);
+  }
+}
@@ -0,0 +1,415 @@
+#include "test-common.h"
+
+// out is within a u8 step of the color resolved by vbt_color_resolve(),
+// which VIBRANT_FIXED_POINT rounds to u8
+static int near_resolved(const vbt_number_t* out, vbt_color_t color) {
+  float rgba[4];
+  vbt_recv_t recv =
+      vbt_recv_init_ref_f32(&rgba[0], &rgba[1], &rgba[2], &rgba[3]);
+
+  if (vbt_color_resolve(&color, &recv) != VBT_SUCCESS) {
+    return 0;
+  }
+
+  for (int i = 0; i < 4; i++) {
+    if (fabs(out[i] - rgba[i]) > 1.0 / 255) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+TEST(vbt_interpolate_n) {
+  vbt_number_t out[5 * 4];
+
+  CASE("srgb") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1),
+        vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1),
+    };
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 2,
+                                3, out),
+              VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out[0], 1.0f);
+    ASSERT_FLOAT_EQ(out[2], 0.0f);
+    ASSERT_FLOAT_EQ(out[4], 0.5f);
+    ASSERT_FLOAT_EQ(out[5], 0.0f);
+    ASSERT_FLOAT_EQ(out[6], 0.5f);
+    ASSERT_FLOAT_EQ(out[7], 1.0f);
+    ASSERT_FLOAT_EQ(out[10], 1.0f);
+  }
+
+  CASE("stops are evenly spaced") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1),
+        vbt_color_init(VBT_COLOR_RGB, 0, 255, 0, 1),
+        vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1),
+    };
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 3,
+                                5, out),
+              VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out[4], 0.5f);
+    ASSERT_FLOAT_EQ(out[5], 0.5f);
+    ASSERT_FLOAT_EQ(out[8], 0.0f);
+    ASSERT_FLOAT_EQ(out[9], 1.0f);
+    ASSERT_FLOAT_EQ(out[13], 0.5f);
+    ASSERT_FLOAT_EQ(out[14], 0.5f);
+    ASSERT_FLOAT_EQ(out[18], 1.0f);
+
+    // a single color is the first stop
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 3,
+                                1, out),
+              VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out[0], 1.0f);
+    ASSERT_FLOAT_EQ(out[1], 0.0f);
+  }
+
+  CASE("oklch is the same as vbt_oklch()") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.7, (vbt_number_t)0.1,
+                       20, 1),
+        vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.5, (vbt_number_t)0.3,
+                       300, 1),
+    };
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLCH, VBT_HUE_SHORTER, 1, stops, 2,
+                                5, out),
+              VBT_SUCCESS);
+
+    for (int i = 0; i < 5; i++) {
+      const vbt_number_t t = (vbt_number_t)i / 4;
+      vbt_color_t color = vbt_color_init(
+          VBT_COLOR_OKLCH, (vbt_number_t)0.7 - (vbt_number_t)0.2 * t,
+          (vbt_number_t)0.1 + (vbt_number_t)0.2 * t, 380 - 80 * t, 1);
+
+      ASSERT_EQ(near_resolved(&out[i * 4], color), 1);
+    }
+  }
+
+#ifndef VIBRANT_FIXED_POINT
+  CASE("integer and other hues are exactly vbt_color_eval()") {
+    // more colors than a chunk of vbt__sincos_chunk()
+    static const vbt_number_t first[] = {10, (vbt_number_t)10.25};
+    vbt_number_t ramp[301 * 4];
+
+    for (int k = 0; k < 2; k++) {
+      vbt_color_t stops[] = {
+          vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.6,
+                         (vbt_number_t)0.05, first[k], 1),
+          vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.6,
+                         (vbt_number_t)0.05, first[k] + 300, 1),
+      };
+
+      ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLCH, VBT_HUE_INCREASING, 1,
+                                  stops, 2, 301, ramp),
+                VBT_SUCCESS);
+
+      for (int i = 0; i < 301; i++) {
+        vbt_color_t color =
+            vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.6,
+                           (vbt_number_t)0.05, first[k] + i, 1);
+
+        ASSERT_EQ(vbt_color_eval(&color), VBT_SUCCESS);
+        ASSERT_EQ(ramp[i * 4 + 0] == color.srgb.n[0], 1);
+        ASSERT_EQ(ramp[i * 4 + 1] == color.srgb.n[1], 1);
+        ASSERT_EQ(ramp[i * 4 + 2] == color.srgb.n[2], 1);
+      }
+    }
+  }
+#endif
+
+  CASE("hue methods") {
+    static const struct {
+      vbt_hue_method_t method;
+      vbt_number_t hue;
+    } methods[] = {
+        {VBT_HUE_SHORTER, 340},
+        {VBT_HUE_LONGER, 160},
+        {VBT_HUE_INCREASING, 160},
+        {VBT_HUE_DECREASING, 340},
+    };
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_LCH, 60, 40, 20, 1),
+        vbt_color_init(VBT_COLOR_LCH, 60, 40, 300, 1),
+    };
+
+    for (size_t i = 0; i < vu_arr_len(methods); i++) {
+      vbt_color_t mid =
+          vbt_color_init(VBT_COLOR_LCH, 60, 40, methods[i].hue, 1);
+
+      ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_LCH, methods[i].method, 1, stops,
+                                  2, 3, out),
+                VBT_SUCCESS);
+      ASSERT_EQ(near_resolved(&out[4], mid), 1);
+    }
+  }
+
+  CASE("a color with no chroma takes the hue of the other") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 255, 255, 1),
+        vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.6, (vbt_number_t)0.2,
+                       250, 1),
+    };
+    vbt_color_t mid = vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.8,
+                                     (vbt_number_t)0.1, 250, 1);
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLCH, VBT_HUE_SHORTER, 1, stops, 2,
+                                3, out),
+              VBT_SUCCESS);
+    ASSERT_EQ(near_resolved(&out[4], mid), 1);
+  }
+
+  CASE("premultiplied alpha") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1),
+        vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 0),
+    };
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, 1, stops, 2,
+                                3, out),
+              VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out[4], 1.0f);
+    ASSERT_FLOAT_EQ(out[6], 0.0f);
+    ASSERT_FLOAT_EQ(out[7], 0.5f);
+    ASSERT_FLOAT_EQ(out[8], 0.0f);
+    ASSERT_FLOAT_EQ(out[11], 0.0f);
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 0, stops, 2,
+                                3, out),
+              VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(out[4], 0.5f);
+    ASSERT_FLOAT_EQ(out[6], 0.5f);
+    ASSERT_FLOAT_EQ(out[7], 0.5f);
+  }
+
+  CASE("invalid arguments") {
+    vbt_color_t stops[] = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1),
+        vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1),
+        vbt_color_init(VBT_COLOR_HSL, NAN, 0, 0, 1),
+    };
+
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 1,
+                                3, out),
+              VBT_ERR);
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1,
+                                &stops[1], 2, 3, out),
+              VBT_ERR);
+    ASSERT_EQ(vbt_interpolate_n((vbt_space_t)6, VBT_HUE_SHORTER, 1, stops, 2,
+                                3, out),
+              VBT_ERR);
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 2,
+                                3, NULL),
+              VBT_ERR);
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_SRGB, VBT_HUE_SHORTER, 1, stops, 2,
+                                0, NULL),
+              VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_gradient_bake) {
+  vbt_u8_t rgba8[8 * 4];
+
+  CASE("stops at their positions") {
+    vbt_gradient_stop_t stops[] = {
+        {vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1), (vbt_number_t)0.25},
+        {vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1), (vbt_number_t)0.75},
+    };
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 2,
+                                VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_SUCCESS);
+
+    // texels centered before the first stop and after the last
+    for (int i = 0; i < 2; i++) {
+      ASSERT_EQ(rgba8[i * 4 + 0], 255);
+      ASSERT_EQ(rgba8[i * 4 + 2], 0);
+      ASSERT_EQ(rgba8[(7 - i) * 4 + 0], 0);
+      ASSERT_EQ(rgba8[(7 - i) * 4 + 2], 255);
+      ASSERT_EQ(rgba8[(7 - i) * 4 + 3], 255);
+    }
+  }
+
+  CASE("a texel is the interpolated color at its center") {
+    vbt_color_t colors[] = {
+        vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.7, (vbt_number_t)0.1,
+                       20, 1),
+        vbt_color_init(VBT_COLOR_OKLCH, (vbt_number_t)0.5, (vbt_number_t)0.15,
+                       300, 1),
+    };
+    vbt_gradient_stop_t stops[] = {{colors[0], 0}, {colors[1], 1}};
+    vbt_number_t out[17 * 4];
+    int mismatches = 0;
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLCH, VBT_HUE_SHORTER, stops, 2,
+                                VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLCH, VBT_HUE_SHORTER, 1, colors, 2,
+                                17, out),
+              VBT_SUCCESS);
+
+    // texel i of 8 is sample 2 * i + 1 of 17
+    for (int i = 0; i < 8; i++) {
+      for (int j = 0; j < 4; j++) {
+        const int u8 = (int)(out[(2 * i + 1) * 4 + j] * 255 + 0.5);
+        mismatches += abs(u8 - rgba8[i * 4 + j]) > 1;
+      }
+    }
+
+    ASSERT_EQ(mismatches, 0);
+  }
+
+  CASE("a stop before the previous one is moved to it") {
+    vbt_gradient_stop_t stops[] = {
+        {vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1), (vbt_number_t)0.5},
+        {vbt_color_init(VBT_COLOR_RGB, 0, 255, 0, 1), (vbt_number_t)0.2},
+        {vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1), 1},
+    };
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB, VBT_HUE_SHORTER, stops, 3,
+                                VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_SUCCESS);
+
+    // a hard edge at 0.5, then 1 / 8 of the way from green to blue
+    ASSERT_EQ(rgba8[3 * 4 + 0], 255);
+    ASSERT_EQ(rgba8[3 * 4 + 1], 0);
+    ASSERT_EQ(rgba8[4 * 4 + 0], 0);
+    ASSERT_EQ(abs(rgba8[4 * 4 + 1] - 223) <= 1, 1);
+    ASSERT_EQ(abs(rgba8[4 * 4 + 2] - 32) <= 1, 1);
+  }
+
+  CASE("float formats are linear light") {
+    vbt_gradient_stop_t stops[] = {
+        {vbt_color_init(VBT_COLOR_RGB, 255, 255, 255, 1), 0},
+        {vbt_color_init(VBT_COLOR_RGB, 0, 0, 0, 1), 1},
+    };
+    vbt_gradient_stop_t fade[] = {
+        {vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1), 0},
+        {vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 0), 1},
+    };
+    float rgba32f[2 * 4];
+    vbt_u16_t rgba16f[2 * 4];
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB_LINEAR, VBT_HUE_SHORTER, stops,
+                                2, VBT_TEXEL_RGBA32F, 0, 2, rgba32f),
+              VBT_SUCCESS);
+    ASSERT_EQ(fabs(rgba32f[0] - 0.75) < 0.001, 1);
+    ASSERT_EQ(fabs(rgba32f[4] - 0.25) < 0.001, 1);
+    ASSERT_FLOAT_EQ(rgba32f[7], 1.0f);
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB_LINEAR, VBT_HUE_SHORTER, stops,
+                                2, VBT_TEXEL_RGBA16F, 0, 2, rgba16f),
+              VBT_SUCCESS);
+    ASSERT_EQ(rgba16f[0], 0x3A00);
+    ASSERT_EQ(rgba16f[4], 0x3400);
+    ASSERT_EQ(rgba16f[7], 0x3C00);
+
+    // interpolated in sRGB, 0.75 and 0.25 are 0.522 and 0.051 in linear light
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB, VBT_HUE_SHORTER, stops, 2,
+                                VBT_TEXEL_RGBA32F, 0, 2, rgba32f),
+              VBT_SUCCESS);
+    ASSERT_EQ(fabs(rgba32f[0] - 0.5225) < 0.001, 1);
+    ASSERT_EQ(fabs(rgba32f[4] - 0.0508) < 0.001, 1);
+
+    // with premultiplied alpha, a fade out keeps its color
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB_LINEAR, VBT_HUE_SHORTER, fade,
+                                2, VBT_TEXEL_RGBA16F, 0, 2, rgba16f),
+              VBT_SUCCESS);
+    ASSERT_EQ(rgba16f[0], 0x3C00);
+    ASSERT_EQ(rgba16f[3], 0x3A00);
+    ASSERT_EQ(rgba16f[4], 0x3C00);
+    ASSERT_EQ(rgba16f[7], 0x3400);
+  }
+
+  CASE("half floats round ties to even") {
+    // the alpha of a stop in space is kept, 1.5 and 2.5 times 2^-24 are
+    // halfway between two subnormal halfs
+    static const float alpha[] = {0x1.8p-24f, 0x1.4p-23f, 0x1.2p-14f};
+    static const vbt_u16_t expected[] = {0x0002, 0x0002, 0x0480};
+    vbt_u16_t rgba16f[4];
+
+    for (int i = 0; i < 3; i++) {
+      vbt_gradient_stop_t stop = {
+          vbt_color_init(VBT_COLOR_OKLAB, 0, 0, 0, alpha[i]), 0};
+
+      ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER,
+                                  &stop, 1, VBT_TEXEL_RGBA16F, 0, 1, rgba16f),
+                VBT_SUCCESS);
+      ASSERT_EQ(rgba16f[3], expected[i]);
+    }
+  }
+
+  CASE("dithering keeps the average") {
+    static vbt_u8_t ramp[1024 * 4];
+    vbt_color_t color =
+        vbt_color_init(VBT_COLOR_OKLAB, (vbt_number_t)0.5, (vbt_number_t)0.05,
+                       (vbt_number_t)0.05, 1);
+    vbt_color_t colors[] = {color, color};
+    vbt_gradient_stop_t stop = {color, 0};
+    vbt_number_t out[4];
+    double red, sum = 0;
+    int spread = 0;
+
+    // vbt_color_resolve() rounds to u8 under VIBRANT_FIXED_POINT
+    ASSERT_EQ(vbt_interpolate_n(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, 1, colors, 2,
+                                1, out),
+              VBT_SUCCESS);
+    red = out[0] * 255.0;
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, &stop, 1,
+                                VBT_TEXEL_RGBA8, 1, 1024, ramp),
+              VBT_SUCCESS);
+
+    for (int i = 0; i < 1024; i++) {
+      sum += ramp[i * 4];
+      spread += fabs(ramp[i * 4] - red) >= 1;
+    }
+
+    ASSERT_EQ(spread, 0);
+    ASSERT_EQ(fabs(sum / 1024 - red) < 0.02, 1);
+  }
+
+  CASE("alpha is not dithered") {
+    static vbt_u8_t ramp[256 * 4];
+    vbt_gradient_stop_t stop = {
+        vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, (vbt_number_t)0.5), 0};
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_SRGB, VBT_HUE_SHORTER, &stop, 1,
+                                VBT_TEXEL_RGBA8, 1, 256, ramp),
+              VBT_SUCCESS);
+
+    for (int i = 0; i < 256; i++) {
+      ASSERT_EQ(ramp[i * 4 + 3], 128);
+    }
+  }
+
+  CASE("invalid arguments") {
+    vbt_gradient_stop_t stops[] = {
+        {vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1), 0},
+        {vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1), NAN},
+        {vbt_color_init(VBT_COLOR_HSL, NAN, 0, 0, 1), 1},
+    };
+
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 0,
+                                VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_ERR);
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 2,
+                                VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_ERR);
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, &stops[1],
+                                2, VBT_TEXEL_RGBA8, 0, 8, rgba8),
+              VBT_ERR);
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 1,
+                                (vbt_texel_format_t)3, 0, 8, rgba8),
+              VBT_ERR);
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 1,
+                                VBT_TEXEL_RGBA8, 0, 8, NULL),
+              VBT_ERR);
+    ASSERT_EQ(vbt_gradient_bake(VBT_SPACE_OKLAB, VBT_HUE_SHORTER, stops, 1,
+                                VBT_TEXEL_RGBA8, 0, 0, NULL),
+              VBT_SUCCESS);
+  }
+}
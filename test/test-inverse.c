@@ -0,0 +1,340 @@
+#include "test-common.h"
+
+typedef int (*inverse_fn_t)(vbt_color_t*, vbt_number_t*);
+typedef int (*forward_fn_t)(vbt_number_t,
+                            vbt_number_t,
+                            vbt_number_t,
+                            vbt_number_t,
+                            vbt_recv_t*);
+
+// rounds x to n decimal places, as an int
+#define ROUND_TO(x, n) ((int)floor((double)(x) * pow(10, n) + 0.5))
+
+TEST(vbt_inverse_values) {
+  vbt_color_t red = vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 0.5);
+  vbt_color_t gray = vbt_color_init(VBT_COLOR_RGB, 119, 119, 119, 1);
+  vbt_number_t out[4];
+
+  CASE("hsl") {
+    ASSERT_EQ(vbt_to_hsl(&red, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 3), 0);
+    ASSERT_EQ(ROUND_TO(out[1], 3), 100000);
+    ASSERT_EQ(ROUND_TO(out[2], 3), 50000);
+    ASSERT_EQ(ROUND_TO(out[3], 3), 502);
+  }
+
+  CASE("hwb") {
+    vbt_color_t teal = vbt_color_init(VBT_COLOR_RGB, 0, 128, 128, 1);
+    ASSERT_EQ(vbt_to_hwb(&teal, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 3), 180000);
+    ASSERT_EQ(ROUND_TO(out[1], 3), 0);
+    ASSERT_EQ(ROUND_TO(out[2], 2), 4980);
+  }
+
+  CASE("lab and lch") {
+    ASSERT_EQ(vbt_to_lab(&red, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 2), 5324);
+    ASSERT_EQ(ROUND_TO(out[1], 1), 801);
+    ASSERT_EQ(ROUND_TO(out[2], 1), 672);
+    ASSERT_EQ(vbt_to_lch(&red, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 2), 5324);
+    ASSERT_EQ(ROUND_TO(out[1], 1), 1046);
+    ASSERT_EQ(ROUND_TO(out[2], 1), 400);
+  }
+
+  CASE("oklab and oklch") {
+    ASSERT_EQ(vbt_to_oklab(&red, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 4), 6280);
+    ASSERT_EQ(ROUND_TO(out[1], 4), 2249);
+    ASSERT_EQ(ROUND_TO(out[2], 4), 1258);
+    ASSERT_EQ(vbt_to_oklch(&red, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[1], 4), 2577);
+    ASSERT_EQ(ROUND_TO(out[2], 2), 2923);
+  }
+
+  CASE("grays have no hue or chroma") {
+    ASSERT_EQ(vbt_to_hsl(&gray, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 3), 0);
+    ASSERT_EQ(ROUND_TO(out[1], 3), 0);
+    ASSERT_EQ(vbt_to_oklch(&gray, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[1], 4), 0);
+  }
+
+  CASE("invalid arguments") {
+    vbt_color_t nan = vbt_color_init(VBT_COLOR_HSL, NAN, 0, 0, 1);
+    ASSERT_EQ(vbt_to_oklab(&nan, out), VBT_ERR);
+    ASSERT_EQ(vbt_to_lab(NULL, out), VBT_ERR);
+    ASSERT_EQ(vbt_to_hsl(&red, NULL), VBT_ERR);
+  }
+}
+
+// sRGB -> space -> sRGB must give back the same u8 color
+TEST(vbt_inverse_round_trip) {
+  static const struct {
+    const char* name;
+    inverse_fn_t inverse;
+    forward_fn_t forward;
+  } spaces[] = {
+      {"hsl", vbt_to_hsl, vbt_hsl},       {"hwb", vbt_to_hwb, vbt_hwb},
+      {"lab", vbt_to_lab, vbt_lab},       {"lch", vbt_to_lch, vbt_lch},
+      {"oklab", vbt_to_oklab, vbt_oklab}, {"oklch", vbt_to_oklch, vbt_oklch},
+  };
+
+  for (size_t i = 0; i < vu_arr_len(spaces); i++) {
+    CASE(spaces[i].name) {
+      int mismatches = 0;
+
+      for (int c = 0; c < 16 * 16 * 16; c++) {
+        const int r = c / 256 * 17, g = c / 16 % 16 * 17, b = c % 16 * 17;
+        vbt_color_t color = vbt_color_init(VBT_COLOR_RGB, r, g, b, 1);
+        vbt_recv_t recv = vbt_recv_init();
+        vbt_number_t out[4];
+
+        ASSERT_EQ(spaces[i].inverse(&color, out), VBT_SUCCESS);
+        spaces[i].forward(out[0], out[1], out[2], out[3], &recv);
+        mismatches += recv.u.val.u8.r != r || recv.u.val.u8.g != g ||
+                      recv.u.val.u8.b != b || recv.u.val.u8.a != 255;
+      }
+
+      ASSERT_EQ(mismatches, 0);
+    }
+  }
+}
+
+TEST(vbt_inverse_batch) {
+  static const vbt_u8_t rgba8[] = {
+      255, 0, 0, 255, 51, 102, 153, 128, 128, 128, 128, 255,
+  };
+  vbt_number_t rgba[12];
+  vbt_number_t batch[12];
+  vbt_number_t out[4];
+
+  for (int i = 0; i < 12; i++) {
+    rgba[i] = (vbt_number_t)rgba8[i] / (vbt_number_t)255;
+  }
+
+  // the batch results are the same as the scalar ones
+  CASE("oklch") {
+    ASSERT_EQ(vbt_to_oklch_batch(rgba, 3, batch), VBT_SUCCESS);
+
+    for (int i = 0; i < 3; i++) {
+      const vbt_u8_t* c = &rgba8[i * 4];
+      vbt_color_t color = vbt_color_init(VBT_COLOR_RGB, c[0], c[1], c[2],
+                                         (vbt_number_t)c[3] / 255);
+
+      ASSERT_EQ(vbt_to_oklch(&color, out), VBT_SUCCESS);
+      ASSERT_EQ(memcmp(out, &batch[i * 4], sizeof(out)), 0);
+    }
+  }
+
+  CASE("every space") {
+    ASSERT_EQ(vbt_to_hsl_batch(rgba, 3, batch), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(batch[4], 3), 210000);
+    ASSERT_EQ(vbt_to_hwb_batch(rgba, 3, batch), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(batch[6], 3), 40000);
+    ASSERT_EQ(vbt_to_lab_batch(rgba, 3, batch), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(batch[0], 2), 5324);
+    ASSERT_EQ(vbt_to_lch_batch(rgba, 3, batch), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(batch[2], 1), 400);
+    ASSERT_EQ(vbt_to_oklab_batch(rgba, 3, batch), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(batch[0], 4), 6280);
+    ASSERT_EQ(ROUND_TO(batch[11], 1), 10);
+  }
+
+  CASE("invalid arguments") {
+    ASSERT_EQ(vbt_to_lab_batch(NULL, 1, batch), VBT_ERR);
+    ASSERT_EQ(vbt_to_lab_batch(rgba, 1, NULL), VBT_ERR);
+    ASSERT_EQ(vbt_to_lab_batch(NULL, 0, NULL), VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_in_gamut_batch) {
+  vbt_u8_t mask[3];
+
+  CASE("colors inside and outside of sRGB") {
+    static const vbt_number_t oklch[] = {
+        (vbt_number_t)0.7, (vbt_number_t)0.1, 200, 1,  // in
+        (vbt_number_t)0.7, (vbt_number_t)0.4, 150, 1,  // out
+        1,                 0,                 0,   1,  // white, in
+        (vbt_number_t)0.5, 0,                 0,   1,  // gray, in
+        0,                 0,                 0,   1,  // black, in
+        NAN,               0,                 0,   1,  // invalid, out
+        (vbt_number_t)0.6, (vbt_number_t)0.4, 30,  1,  // out
+        (vbt_number_t)0.6, (vbt_number_t)0.1, 30,  0,  // in
+        (vbt_number_t)0.5, (vbt_number_t)0.1, INF, 1,  // invalid, out
+        (vbt_number_t)1.1, 0,                 0,   1,  // lighter than white
+    };
+
+    mask[2] = 0xAA;
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_OKLCH, oklch, 10, mask),
+              VBT_SUCCESS);
+    ASSERT_EQ(mask[0], 0x9D);
+    ASSERT_EQ(mask[1], 0x00);
+    ASSERT_EQ(mask[2], 0xAA);
+  }
+
+  CASE("lab, lch and oklab") {
+    static const vbt_number_t lab[] = {
+        (vbt_number_t)53.24, (vbt_number_t)80.09, (vbt_number_t)67.2,  1,
+        50,                  100,                 -100,                1,
+    };
+    static const vbt_number_t lch[] = {
+        50, 20,  40, 1,
+        50, 150, 40, 1,
+    };
+    static const vbt_number_t oklab[] = {
+        (vbt_number_t)0.5, (vbt_number_t)-0.05, (vbt_number_t)0.05, 1,
+        (vbt_number_t)0.5, (vbt_number_t)0.3,   (vbt_number_t)0.3,  1,
+    };
+
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_LAB, lab, 2, mask), VBT_SUCCESS);
+    ASSERT_EQ(mask[0], 1);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_LCH, lch, 2, mask), VBT_SUCCESS);
+    ASSERT_EQ(mask[0], 1);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_OKLAB, oklab, 2, mask),
+              VBT_SUCCESS);
+    ASSERT_EQ(mask[0], 1);
+  }
+
+  CASE("sRGB converted to oklch is inside") {
+    vbt_number_t rgba[16 * 4];
+    vbt_number_t oklch[16 * 4];
+
+    for (int i = 0; i < 16; i++) {
+      rgba[i * 4 + 0] = (vbt_number_t)(i & 1);
+      rgba[i * 4 + 1] = (vbt_number_t)(i >> 1 & 1);
+      rgba[i * 4 + 2] = (vbt_number_t)(i >> 2 & 1);
+      rgba[i * 4 + 3] = 1;
+
+      if (i >= 8) {
+        rgba[i * 4 + i % 3] = (vbt_number_t)0.25;
+      }
+    }
+
+    ASSERT_EQ(vbt_to_oklch_batch(rgba, 16, oklch), VBT_SUCCESS);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_OKLCH, oklch, 16, mask),
+              VBT_SUCCESS);
+    ASSERT_EQ(mask[0], 0xFF);
+    ASSERT_EQ(mask[1], 0xFF);
+  }
+
+  CASE("integer and other hues, over more than one chunk") {
+    vbt_number_t oklch[300 * 4];
+    vbt_u8_t bits[38];
+
+    // chroma around the edge of sRGB, so that each hue decides
+    for (int i = 0; i < 300; i++) {
+      oklch[i * 4 + 0] = (vbt_number_t)0.7;
+      oklch[i * 4 + 1] = (vbt_number_t)(0.1 + (i % 7) * 0.02);
+      oklch[i * 4 + 2] = (vbt_number_t)(i % 3 ? i * 7 : i * 7 + 0.5);
+      oklch[i * 4 + 3] = 1;
+    }
+
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_OKLCH, oklch, 300, bits),
+              VBT_SUCCESS);
+
+    for (int i = 0; i < 300; i++) {
+      ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_OKLCH, &oklch[i * 4], 1, mask),
+                VBT_SUCCESS);
+      ASSERT_EQ(bits[i / 8] >> (i % 8) & 1, mask[0]);
+    }
+  }
+
+  CASE("invalid arguments") {
+    static const vbt_number_t hsl[] = {0, 0, 0, 1};
+
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_HSL, hsl, 1, mask), VBT_ERR);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_LAB, NULL, 1, mask), VBT_ERR);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_LAB, hsl, 1, NULL), VBT_ERR);
+    ASSERT_EQ(vbt_in_gamut_batch(VBT_COLOR_LAB, NULL, 0, NULL), VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_delta_e) {
+  // pairs from the CIEDE2000 test data of Sharma, Wu and Dalal
+  static const vbt_number_t x[] = {
+      50,                    (vbt_number_t)2.6772,   (vbt_number_t)-79.7751, 1,
+      50,                    0,                      0,                      1,
+      50,                    (vbt_number_t)2.49,     (vbt_number_t)-0.001,   1,
+      50,                    (vbt_number_t)2.49,     (vbt_number_t)-0.001,   1,
+      50,                    (vbt_number_t)-0.001,   (vbt_number_t)2.49,     1,
+      50,                    (vbt_number_t)2.5,      0,                      1,
+      50,                    (vbt_number_t)2.5,      0,                      1,
+      (vbt_number_t)60.2574, (vbt_number_t)-34.0099, (vbt_number_t)36.2677,  1,
+      (vbt_number_t)90.9257, (vbt_number_t)-0.5406,  (vbt_number_t)-0.9208,  1,
+  };
+  static const vbt_number_t y[] = {
+      50,                    0,                      (vbt_number_t)-82.7485, 1,
+      50,                    -1,                     2,                      1,
+      50,                    (vbt_number_t)-2.49,    (vbt_number_t)0.0009,   1,
+      50,                    (vbt_number_t)-2.49,    (vbt_number_t)0.0011,   1,
+      50,                    (vbt_number_t)0.0009,   (vbt_number_t)-2.49,    1,
+      73,                    25,                     -18,                    1,
+      50,                    (vbt_number_t)3.1736,   (vbt_number_t)0.5854,   1,
+      (vbt_number_t)60.4626, (vbt_number_t)-34.1751, (vbt_number_t)39.4387,  1,
+      (vbt_number_t)88.6381, (vbt_number_t)-0.8985,  (vbt_number_t)-0.7239,  1,
+  };
+  static const int expected[] = {
+      20425, 23669, 71792, 72195, 48045, 271492, 10000, 12644, 15381,
+  };
+  vbt_number_t out[9];
+
+  CASE("ciede2000") {
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_2000, x, y, 9, out), VBT_SUCCESS);
+
+    for (int i = 0; i < 9; i++) {
+      ASSERT_EQ(ROUND_TO(out[i], 4), expected[i]);
+    }
+  }
+
+  CASE("cie76 and ok are the distance") {
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_76, x, y, 9, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[1], 4), 22361);
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_OK, x, y, 9, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[5], 3), 36868);
+  }
+
+  CASE("one color to many is the same as pairs") {
+    vbt_number_t ref[9 * 4];
+    vbt_number_t pairs[9];
+
+    for (int i = 0; i < 9 * 4; i++) {
+      ref[i] = x[i % 4 + 5 * 4];
+    }
+
+    ASSERT_EQ(vbt_delta_e_ref_batch(VBT_DELTA_E_2000, &x[5 * 4], y, 9, out),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_2000, ref, y, 9, pairs),
+              VBT_SUCCESS);
+    ASSERT_EQ(memcmp(out, pairs, sizeof(out)), 0);
+    ASSERT_EQ(ROUND_TO(out[6], 4), 10000);
+  }
+
+  CASE("colors") {
+    vbt_color_t red = vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1);
+    vbt_color_t same = vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 0);
+    vbt_color_t blue = vbt_color_init(VBT_COLOR_RGB, 0, 0, 255, 1);
+
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_2000, &red, &same, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 4), 0);
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_2000, &red, &blue, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 1), 529);
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_76, &red, &blue, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 0), 176);
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_OK, &red, &blue, out), VBT_SUCCESS);
+    ASSERT_EQ(ROUND_TO(out[0], 2), 54);
+  }
+
+  CASE("invalid arguments") {
+    vbt_color_t red = vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1);
+
+    ASSERT_EQ(vbt_delta_e((vbt_delta_e_t)3, &red, &red, out), VBT_ERR);
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_OK, &red, NULL, out), VBT_ERR);
+    ASSERT_EQ(vbt_delta_e(VBT_DELTA_E_OK, &red, &red, NULL), VBT_ERR);
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_76, x, NULL, 1, out), VBT_ERR);
+    ASSERT_EQ(vbt_delta_e_ref_batch(VBT_DELTA_E_76, NULL, y, 1, out),
+              VBT_ERR);
+    ASSERT_EQ(vbt_delta_e_batch(VBT_DELTA_E_76, NULL, NULL, 0, NULL),
+              VBT_SUCCESS);
+  }
+}
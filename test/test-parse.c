@@ -118,6 +118,15 @@ TEST(vbt_parse_z_invalid_args) {
   }
 }
 
+// string -> vbt_number_t, correctly rounded
+static vbt_number_t strton(const char* str) {
+#if defined(VIBRANT_DOUBLE_PRECISION)
+  return strtod(str, NULL);
+#else
+  return strtof(str, NULL);
+#endif
+}
+
 TEST(vbt_parse_z_parse_number_limits) {
   const char* in;
   vbt_recv_t recv = vbt_recv_init();
@@ -140,6 +149,73 @@ TEST(vbt_parse_z_parse_number_limits) {
     err = vbt_parse_z(in, &recv);
     ASSERT_RECV_U8(err, recv, 64, 191, 98, 255);
   }
+
+  CASE("exponents") {
+    in = "hsl(1.2e2, 5E1%, 500e-1%)";
+    err = vbt_parse_z(in, &recv);
+    ASSERT_RECV_U8(err, recv, 64, 191, 64, 255);
+  }
+
+  // rgb() numbers are passed through, so the parsed values can be compared
+  // against the correctly rounded libc conversion
+  const char* numbers[] = {
+      "0.1",
+      "1.2345678e-1",
+      "119.9999999999",
+      "0.1000000000000000055",
+      "16777215.5",
+      "8388609.5",
+      "0.000000000000000000000000000000123456789",
+      "1.000000178813934326",
+      "0.5000000298023224",
+      "2.2250738585072011e-20",
+      "9007199254740993e-10",
+      "119.99999999999999999",
+      "12345678901234567890123e-20",
+      // halfway between two floats, below, exactly, and above
+      "1.0000000596046447753906249999999999",
+      "1.000000059604644775390625",
+      "1.0000000596046447753906250000000001",
+      // halfway between two doubles, exactly and above
+      "1.00000000000000011102230246251565404236316680908203125",
+      "1.0000000000000001110223024625156540423631668090820312500000000000001",
+      "0.00000000000000000000000000000012345678901234567890123456789",
+  };
+
+  for (size_t i = 0; i < vu_arr_len(numbers); i++) {
+    CASE(numbers[i]) {
+      char buf[128];
+      vbt_color_t color;
+
+      snprintf(buf, sizeof(buf), "rgb(%s 0 0)", numbers[i]);
+      ASSERT_EQ(vbt_parse_color_z(buf, &color), VBT_SUCCESS);
+      ASSERT_EQ(color.arg[0], strton(numbers[i]));
+    }
+  }
+
+  CASE("numbers too small flush to 0") {
+    vbt_color_t color;
+    ASSERT_EQ(vbt_parse_color_z("rgb(1e-33 -9e-40 1e-10000)", &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.arg[0], 0);
+    ASSERT_EQ(color.arg[1], 0);
+    ASSERT_EQ(color.arg[2], 0);
+  }
+
+  CASE("trailing zeros of the fraction are not significant") {
+    vbt_color_t color;
+    ASSERT_EQ(vbt_parse_color_z("rgb(1.00000000000000000000 "
+                                "0.12345678900000000000000000 "
+                                "100.000000000000000000000e-2)",
+                                &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.arg[0], 1);
+    ASSERT_EQ(color.arg[1], strton("0.123456789"));
+    ASSERT_EQ(color.arg[2], 1);
+    ASSERT_EQ(vbt_parse_color_z("rgb(1.00000000000000000001 0 0)", &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.arg[0], 1);
+  }
 }
 
 TEST(vbt_parse_z_parse_err) {
@@ -214,6 +290,28 @@ TEST(vbt_parse_z_parse_err) {
     ASSERT_EQ(vbt_parse_z(in, &recv), VBT_ERR);
   }
 
+  // rejected by the first byte, or by the single path it picks
+  const char* not_a_color_in[] = {
+      "10px",
+      "-red",
+      " red",
+      "(0, 0, 0)",
+      "inherit",
+      "var(--x)",
+      "rgbx(0, 0, 0)",
+      "hslx(0, 0, 0)",
+      "okl(0, 0, 0)",
+      "oranges",
+      "r",
+      "rebeccapurplee",
+  };
+
+  for (size_t i = 0; i < vu_arr_len(not_a_color_in); i++) {
+    CASE(not_a_color_in[i]) {
+      ASSERT_EQ(vbt_parse_z(not_a_color_in[i], &recv), VBT_ERR);
+    }
+  }
+
   // argument parsing
   const char* params_in[] = {
       "rgb()",
@@ -240,6 +338,15 @@ TEST(vbt_parse_z_parse_err) {
       "rgb(0, 0,",
       "rgb(0, 0, 0",
       "rgb(0, 0, 0 /",
+      "rgb(0,0 0)",
+      "rgb(0 0,0)",
+      "rgb(0 0 0 0)",
+      "rgb(0 0 0 / 0 / 0)",
+      "rgb(0 0 0 /)",
+      "rgb(0% % 0 0)",
+      "rgba(0 0 0 / 0)",
+      "rgb a(0, 0, 0, 0)",
+      "rgb(0, 0, 0) x",
   };
 
   for (size_t i = 0; i < vu_arr_len(params_in); i++) {
@@ -248,11 +355,30 @@ TEST(vbt_parse_z_parse_err) {
     }
   }
 
-  CASE("more than 9 digits after decimal") {
-    in = "hsl(119.9999999999, 50%, 50%)";
+  CASE("more than 19 significant digits, too large") {
+    in = "hsl(16777217.00000000000000000001, 50%, 50%)";
     ASSERT_EQ(vbt_parse_z(in, &recv), VBT_ERR);
   }
 
+  CASE("exceeds int max with exponent") {
+    in = "hsl(1.6777217e7, 50%, 50%)";
+    ASSERT_EQ(vbt_parse_z(in, &recv), VBT_ERR);
+  }
+
+  CASE("sign or point without digits") {
+    ASSERT_EQ(vbt_parse_z("rgb(- 0 0)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("rgb(+ 0 0)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("rgb(. 0 0)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("rgb(-. 0 0)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("rgb(.e1 0 0)", &recv), VBT_ERR);
+  }
+
+  CASE("exponent without digits") {
+    ASSERT_EQ(vbt_parse_z("hsl(1e, 50%, 50%)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("hsl(1e+, 50%, 50%)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_z("hsl(1em, 50%, 50%)", &recv), VBT_ERR);
+  }
+
   CASE("exceeds int max") {
     in = "hsl(16777217, 50%, 50%)";
     ASSERT_EQ(vbt_parse_z(in, &recv), VBT_ERR);
@@ -697,6 +823,651 @@ TEST(vbt_parse_oklab) {
   }
 }
 
+TEST(vbt_parse_color_mix) {
+  static const struct {
+    const char* in;
+    vbt_u8_t rgba[4];
+  } mixes[] = {
+      {"color-mix(in srgb, red, blue)", {128, 0, 128, 255}},
+      {"color-mix(in srgb, red 75%, blue)", {191, 0, 64, 255}},
+      {"color-mix(in srgb, 25% red, blue)", {64, 0, 191, 255}},
+      {"color-mix(in srgb, red 75%, blue 75%)", {128, 0, 128, 255}},
+      {"color-mix(in srgb, red 25%, blue 25%)", {128, 0, 128, 128}},
+      {"color-mix(in srgb, transparent, red)", {255, 0, 0, 128}},
+      {"color-mix(in srgb, rgb(255, 0, 0), rgb(0 0 255 / 1))",
+       {128, 0, 128, 255}},
+      {"color-mix( in srgb-linear , 50% white , black )", {188, 188, 188, 255}},
+      {"color-mix(in oklab, red 30%, #00f)", {93, 75, 200, 255}},
+      {"color-mix(in srgb, color-mix(in srgb, red, blue), lime)",
+       {64, 128, 64, 255}},
+  };
+
+  for (size_t i = 0; i < vu_arr_len(mixes); i++) {
+    CASE(mixes[i].in) {
+      vbt_recv_t recv = vbt_recv_init();
+      int err = vbt_parse_z(mixes[i].in, &recv);
+      ASSERT_RECV_U8(err, recv, mixes[i].rgba[0], mixes[i].rgba[1],
+                     mixes[i].rgba[2], mixes[i].rgba[3]);
+    }
+  }
+
+  CASE("colors in the space are mixed in their arguments") {
+    vbt_color_t color;
+
+    ASSERT_EQ(vbt_parse_color_z("color-mix(in oklch increasing hue, "
+                                "oklch(0.7 0.1 20), oklch(0.5 0.3 300))",
+                                &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_OKLCH);
+    ASSERT_EQ(fabs(color.arg[0] - 0.6) < 0.0001, 1);
+    ASSERT_EQ(fabs(color.arg[1] - 0.2) < 0.0001, 1);
+    ASSERT_EQ(fabs(color.arg[2] - 160) < 0.001, 1);
+    ASSERT_FLOAT_EQ((float)color.arg[3], 1.0f);
+    ASSERT_EQ(color.unit[0], VBT_UNIT_NUMBER);
+
+    ASSERT_EQ(vbt_parse_color_z("color-mix(in lab, lab(50 20 30), "
+                                "lch(70 40 90) 25%)",
+                                &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_LAB);
+    ASSERT_EQ(fabs(color.arg[0] - 55) < 0.001, 1);
+    ASSERT_EQ(fabs(color.arg[1] - 15) < 0.001, 1);
+    ASSERT_EQ(fabs(color.arg[2] - 32.5) < 0.001, 1);
+  }
+
+  CASE("other Lab colors are mixed outside of sRGB") {
+    vbt_color_t color;
+
+    // oklch(0.7 0.4 150) is lab(69.834 -141.206 133.528), far outside of
+    // sRGB, which clamped would mix to about lab(62.4 -37.7 36.4)
+    ASSERT_EQ(vbt_parse_color_z("color-mix(in lab, oklch(0.7 0.4 150), "
+                                "lab(50 0 0))",
+                                &color),
+              VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_LAB);
+    ASSERT_EQ(fabs(color.arg[0] - 59.917) < 0.01, 1);
+    ASSERT_EQ(fabs(color.arg[1] - -70.603) < 0.01, 1);
+    ASSERT_EQ(fabs(color.arg[2] - 66.764) < 0.01, 1);
+  }
+}
+
+TEST(vbt_relative) {
+  static const struct {
+    const char* rel;
+    const char* origin;
+    const char* expected;
+  } templates[] = {
+      {"oklch(from var l c calc(h + 180))", "oklch(0.7 0.1 20)",
+       "oklch(0.7 0.1 200)"},
+      {"rgb(from var calc(255 - r) calc(255 - g) calc(255 - b) / "
+       "calc(alpha * 0.5))",
+       "rgb(255 0 51 / 0.5)", "rgb(0 255 204 / 0.25)"},
+      {"hsla(from var(--base) h 50% l)", "hsl(120 100% 25%)",
+       "hsl(120 50% 25%)"},
+      {"lab(from var l -a calc(-1 * b) / 0.5)", "lab(50 20 -30)",
+       "lab(50 -20 30 / 0.5)"},
+      {"oklab(from var calc((l + 1) / 2) calc(a*2) b)", "oklab(0.4 0.1 0.2)",
+       "oklab(0.7 0.2 0.2)"},
+      {"rgb(from var r g b)", "#f00", "rgb(255 0 0)"},
+      // percentages in calc() follow the same rules as in rgb(calc(...))
+      {"rgb(from var r calc(50% + 10%) b / calc(alpha * 50%))",
+       "rgb(100 0 51 / 0.5)", "rgb(100 153 51 / 0.25)"},
+      {"oklch(from var l c calc((((((((h + 1)))))))))",
+       "oklch(0.7 0.1 20)", "oklch(0.7 0.1 21)"},
+  };
+
+  for (size_t i = 0; i < vu_arr_len(templates); i++) {
+    CASE(templates[i].rel) {
+      vbt_relative_t rel;
+      vbt_color_t origin, color, expected;
+
+      ASSERT_EQ(vbt_relative_compile_z(templates[i].rel, &rel), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_color_z(templates[i].origin, &origin), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_color_z(templates[i].expected, &expected),
+                VBT_SUCCESS);
+      ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_SUCCESS);
+      ASSERT_EQ(color.fn, expected.fn);
+      for (int j = 0; j < 4; j++) {
+        ASSERT_EQ(fabs(color.arg[j] - expected.arg[j]) < 0.001, 1);
+        ASSERT_EQ(color.unit[j], VBT_UNIT_NUMBER);
+      }
+    }
+  }
+
+  CASE("origins of another function are converted") {
+    vbt_relative_t rel;
+    vbt_color_t origin, color;
+    vbt_number_t out[4];
+
+    ASSERT_EQ(vbt_relative_compile_z("oklch(from var l c h)", &rel),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_parse_color_z("#f80", &origin), VBT_SUCCESS);
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_SUCCESS);
+    ASSERT_EQ(vbt_to_oklch(&origin, out), VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_OKLCH);
+    for (int j = 0; j < 4; j++) {
+      ASSERT_EQ(fabs(color.arg[j] - out[j]) < 0.001, 1);
+    }
+  }
+
+  CASE("origins outside of sRGB are not clamped") {
+    vbt_relative_t rel;
+    vbt_color_t origin, color;
+
+    ASSERT_EQ(vbt_relative_compile_z("oklab(from var l a b)", &rel),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_parse_color_z("lab(50 100 -100)", &origin), VBT_SUCCESS);
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_OKLAB);
+    ASSERT_EQ(fabs(color.arg[0] - 0.6172) < 0.0001, 1);
+    ASSERT_EQ(fabs(color.arg[1] - 0.1862) < 0.0001, 1);
+    ASSERT_EQ(fabs(color.arg[2] + 0.2860) < 0.0001, 1);
+
+    // rgb() channels go past 0 and 255
+    ASSERT_EQ(vbt_relative_compile_z("rgb(from var r g b)", &rel),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_SUCCESS);
+    ASSERT_EQ(color.arg[1] < 0, 1);
+    ASSERT_EQ(color.arg[2] > 255, 1);
+  }
+
+  CASE("batch matches single applies") {
+    vbt_relative_t rel;
+    vbt_color_t origins[150], colors[150], color;
+    int err[150];
+
+    ASSERT_EQ(vbt_relative_compile_z("oklch(from var calc(l * 0.9) c "
+                                     "calc(h + 30))",
+                                     &rel),
+              VBT_SUCCESS);
+    for (int i = 0; i < 150; i++) {
+      origins[i] = i % 3 ? vbt_color_init(VBT_COLOR_OKLCH,
+                                          (vbt_number_t)(i % 10) / 10,
+                                          (vbt_number_t)0.1, (vbt_number_t)i, 1)
+                         : vbt_color_init(VBT_COLOR_RGB, (vbt_number_t)i, 40,
+                                          (vbt_number_t)(150 - i), 1);
+    }
+
+    ASSERT_EQ(vbt_relative_apply_batch(&rel, origins, 150, colors, err),
+              VBT_SUCCESS);
+    for (int i = 0; i < 150; i++) {
+      ASSERT_EQ(err[i], VBT_SUCCESS);
+      ASSERT_EQ(vbt_relative_apply(&rel, &origins[i], &color), VBT_SUCCESS);
+      ASSERT_EQ(colors[i].fn, VBT_COLOR_OKLCH);
+      for (int j = 0; j < 4; j++) {
+        ASSERT_EQ(fabs(colors[i].arg[j] - color.arg[j]) < 0.0001, 1);
+      }
+    }
+  }
+
+  CASE("failed items are reported per item") {
+    vbt_relative_t rel;
+    vbt_color_t origins[3], colors[3];
+    int err[3];
+
+    ASSERT_EQ(vbt_relative_compile_z("rgb(from var calc(255 / r) g b)", &rel),
+              VBT_SUCCESS);
+    origins[0] = vbt_color_init(VBT_COLOR_RGB, 255, 0, 0, 1);
+    origins[1] = vbt_color_init(VBT_COLOR_RGB, 0, 0, 0, 1);
+    origins[2] = vbt_color_init(VBT_COLOR_RGB, 51, 0, 0, 1);
+
+    ASSERT_EQ(vbt_relative_apply_batch(&rel, origins, 3, colors, err),
+              VBT_ERR);
+    ASSERT_EQ(err[0], VBT_SUCCESS);
+    ASSERT_EQ(err[1], VBT_ERR);
+    ASSERT_EQ(err[2], VBT_SUCCESS);
+    ASSERT_EQ(fabs(colors[2].arg[0] - 5) < 0.0001, 1);
+  }
+
+  CASE("invalid templates") {
+    static const char* invalid[] = {
+        "oklch(l c h)",
+        "oklch(from l c h)",
+        "oklch(from red l c h)",
+        "oklch(from var l c)",
+        "oklch(from var l c h h)",
+        "oklch(from var l c h / alpha / alpha)",
+        "oklch(from var l c calc(h + 10%))",
+        "oklch(from var l c calc(h * 10% * 10%))",
+        "oklch(from var l c calc(h / 10%))",
+        "oklch(from var l c calc(((((((((h))))))))))",
+        "oklch(from var l c calc(h + r))",
+        "oklch(from var l c calc(h +))",
+        "oklch(from var l c calc(h + 1)",
+        "oklch(from var(--x l c h)",
+        "oklch(from var l c ((((((((((h)))))))))))",
+        "oklch(from var l c calc(h*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1"
+        "*1*1*1*1*1*1*1*1*1*1*1*1*1*1*1))",
+        "oklch(from var l c calc(h*1*2*3*4*5*6*7*8*9*10*11*12*13*14*15*16*17))",
+        "oklch(from var l c calc(h+1))",
+        "oklch(from var l c calc(h -1))",
+        "oklch(from var l c calc(- h))",
+        "color(from var srgb r g b)",
+        "",
+    };
+
+    for (size_t i = 0; i < vu_arr_len(invalid); i++) {
+      vbt_relative_t rel;
+      ASSERT_EQ(vbt_relative_compile_z(invalid[i], &rel), VBT_ERR);
+    }
+  }
+
+  CASE("invalid arguments") {
+    vbt_relative_t rel;
+    vbt_color_t origin = vbt_color_init(VBT_COLOR_RGB, 0, 0, 0, 1);
+    vbt_color_t color;
+
+    ASSERT_EQ(vbt_relative_compile_z(NULL, &rel), VBT_ERR);
+    ASSERT_EQ(vbt_relative_compile_z("rgb(from var r g b)", NULL), VBT_ERR);
+    ASSERT_EQ(vbt_relative_compile_z("rgb(from var r g b)", &rel),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_relative_apply(NULL, &origin, &color), VBT_ERR);
+    ASSERT_EQ(vbt_relative_apply(&rel, NULL, &color), VBT_ERR);
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, NULL), VBT_ERR);
+    ASSERT_EQ(vbt_relative_apply_batch(&rel, NULL, 0, NULL, NULL),
+              VBT_SUCCESS);
+
+    memset(&rel, 0, sizeof(rel));
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+  }
+
+  CASE("programs that were not compiled are refused") {
+    vbt_relative_t compiled;
+    vbt_relative_t rel;
+    vbt_color_t origin = vbt_color_init(VBT_COLOR_RGB, 1, 2, 3, 1);
+    vbt_color_t color;
+
+    // rgb: const 0, store 0, channel g, store 1, channel b, store 2,
+    // channel alpha, store 3
+    ASSERT_EQ(vbt_relative_compile_z("rgb(from var 5 g b)", &compiled),
+              VBT_SUCCESS);
+    ASSERT_EQ(compiled.op_count, 16);
+    ASSERT_EQ(vbt_relative_apply(&compiled, &origin, &color), VBT_SUCCESS);
+
+    rel = compiled;
+    rel.ops[0] = 200;  // unknown opcode
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.ops[1] = VBT__RELATIVE_MAX_CONSTS;  // constant out of range
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.ops[5] = 9;  // channel out of range
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.ops[3] = 2;  // channel 0 is never stored
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.ops[4] = 2;  // add with one operand
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.op_count = 15;  // store without its channel
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+
+    rel = compiled;
+    rel.op_count = VBT__RELATIVE_MAX_OPS;  // pushes and never stores
+    for (int pc = 16; pc < rel.op_count; pc += 2) {
+      rel.ops[pc] = 0;
+      rel.ops[pc + 1] = 0;
+    }
+    ASSERT_EQ(vbt_relative_apply(&rel, &origin, &color), VBT_ERR);
+  }
+}
+
+TEST(vbt_parse_calc) {
+  static const struct {
+    const char* in;
+    const char* expected;
+  } folds[] = {
+      {"rgb(calc(255 / 2) 0 calc(10% * 5))", "rgb(127.5 0 50%)"},
+      {"rgb(calc(1 + 2 * 3) calc((1 + 2) * 3) calc(-10 * -2))",
+       "rgb(7 9 20)"},
+      {"rgba(calc( 1 ),calc(2)  ,calc(3), calc(50%))", "rgba(1, 2, 3, 50%)"},
+      {"hsl(calc(120 + 60) calc(50% + 10%) calc(2 * 20%))",
+       "hsl(180 60% 40%)"},
+      {"lab(calc(100% / 4) calc(-10 - 20) calc(calc(2) * (3 - 1)))",
+       "lab(25% -30 4)"},
+      {"rgb(calc(10 - -5) calc(-(5) + 10) calc(\t1\t+\t2))", "rgb(15 5 3)"},
+      {"oklch(calc(0.5 + 0.2) calc(0.1*2) calc(((((((1 + 29))))))) / "
+       "CALC(1 / 2))",
+       "oklch(0.7 0.2 30 / 0.5)"},
+  };
+
+  for (size_t i = 0; i < vu_arr_len(folds); i++) {
+    CASE(folds[i].in) {
+      vbt_color_t color, expected;
+
+      ASSERT_EQ(vbt_parse_color_z(folds[i].in, &color), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_color_z(folds[i].expected, &expected),
+                VBT_SUCCESS);
+      ASSERT_EQ(color.fn, expected.fn);
+
+      for (int j = 0; j < 4; j++) {
+        ASSERT_EQ(fabs(color.arg[j] - expected.arg[j]) < 0.0001, 1);
+        ASSERT_EQ(color.unit[j], expected.unit[j]);
+      }
+    }
+  }
+}
+
+TEST(vbt_vars) {
+  static vbt_var_t storage[16];
+  vbt_vars_t vars;
+  vbt_recv_t recv;
+  vbt_color_t color;
+  int err;
+
+  ASSERT_EQ(vbt_vars_init(&vars, storage, vu_arr_len(storage)), VBT_SUCCESS);
+  ASSERT_EQ(vbt_vars_define_z(&vars, "--hue", "120"), VBT_SUCCESS);
+  ASSERT_EQ(vbt_vars_define_z(&vars, "--red", " #f00 "), VBT_SUCCESS);
+  ASSERT_EQ(vbt_vars_define_z(&vars, "--green", "hsl(var(--hue) 100% 25%)"),
+            VBT_SUCCESS);
+  ASSERT_EQ(vbt_vars_define_z(&vars, "--mix",
+                              "color-mix(in srgb, var(--red), "
+                              "var(--blue, blue))"),
+            VBT_SUCCESS);
+
+  CASE("references are substituted") {
+    recv = vbt_recv_init();
+    err = vbt_parse_vars_z(&vars, "var(--red)", &recv);
+    ASSERT_RECV_U8(err, recv, 255, 0, 0, 255);
+    err = vbt_parse_vars_z(&vars, " var( --green ) ", &recv);
+    ASSERT_RECV_U8(err, recv, 0, 128, 0, 255);
+    err = vbt_parse_vars_z(&vars, "rgb(calc(var(--hue) + 1) 0 0)", &recv);
+    ASSERT_RECV_U8(err, recv, 121, 0, 0, 255);
+    err = vbt_parse_vars_z(&vars, "var(--mix)", &recv);
+    ASSERT_RECV_U8(err, recv, 128, 0, 128, 255);
+  }
+
+  CASE("fallbacks replace undefined and invalid properties") {
+    recv = vbt_recv_init();
+    err = vbt_parse_vars_z(&vars, "var(--unknown, rgb(0 0 255))", &recv);
+    ASSERT_RECV_U8(err, recv, 0, 0, 255, 255);
+    err = vbt_parse_vars_z(&vars, "var(--unknown, var(--red))", &recv);
+    ASSERT_RECV_U8(err, recv, 255, 0, 0, 255);
+    ASSERT_EQ(vbt_parse_vars_z(&vars, "var(--unknown)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_vars_z(&vars, "var(--hue)", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--hue", &color), VBT_ERR);
+  }
+
+  CASE("only dependents of a changed definition are resolved again") {
+    uint32_t stamp;
+
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--green", &color), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--mix", &color), VBT_SUCCESS);
+    stamp = vars.stamp;
+
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--mix", &color), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--red", " #f00 "), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--hue", "240"), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--mix", &color), VBT_SUCCESS);
+    ASSERT_EQ(vars.stamp, stamp);
+
+    recv = vbt_recv_init();
+    err = vbt_parse_vars_z(&vars, "var(--green)", &recv);
+    ASSERT_RECV_U8(err, recv, 0, 0, 128, 255);
+    ASSERT_EQ(vars.stamp, stamp + 2);
+
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--blue", "lime"), VBT_SUCCESS);
+    err = vbt_parse_vars_z(&vars, "var(--mix)", &recv);
+    ASSERT_RECV_U8(err, recv, 128, 128, 0, 255);
+
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--red", NULL), VBT_SUCCESS);
+    ASSERT_EQ(vbt_parse_vars_z(&vars, "var(--mix)", &recv), VBT_ERR);
+  }
+
+  CASE("properties on a cycle are invalid") {
+    uint32_t stamp;
+
+    recv = vbt_recv_init();
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--a", "var(--b)"), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--b", "var(--a, red)"), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--c", "var(--a, lime)"), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--a", &color), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--b", &color), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--c", &color), VBT_SUCCESS);
+
+    // the cycle and its dependents stay cached
+    stamp = vars.stamp;
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--b", &color), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--a", &color), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--c", &color), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--a", &color), VBT_ERR);
+    ASSERT_EQ(vars.stamp, stamp);
+
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--self", "var(--self, red)"),
+              VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--self", &color), VBT_ERR);
+
+    err = vbt_parse_vars_z(&vars, "var(--a, white)", &recv);
+    ASSERT_RECV_U8(err, recv, 255, 255, 255, 255);
+
+    stamp = vars.stamp;
+    ASSERT_EQ(vbt_vars_define_z(&vars, "--b", "blue"), VBT_SUCCESS);
+    err = vbt_parse_vars_z(&vars, "var(--a)", &recv);
+    ASSERT_RECV_U8(err, recv, 0, 0, 255, 255);
+    ASSERT_EQ(vbt_vars_get_z(&vars, "--c", &color), VBT_SUCCESS);
+    ASSERT_EQ(vars.stamp, stamp + 3);
+  }
+
+  CASE("invalid arguments") {
+    vbt_vars_t small;
+
+    ASSERT_EQ(vbt_vars_init(NULL, storage, 1), VBT_ERR);
+    ASSERT_EQ(vbt_vars_init(&small, NULL, 1), VBT_ERR);
+    ASSERT_EQ(vbt_vars_init(&small, storage, 1), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--x", "red"), VBT_SUCCESS);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--y", "red"), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(&small, "-x", "red"), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--", "red"), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--x y", "red"), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(NULL, "--x", "red"), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--x", long_string()), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&small, "--x", NULL), VBT_ERR);
+    ASSERT_EQ(vbt_vars_get_z(&small, "--y", &color), VBT_ERR);
+    ASSERT_EQ(vbt_vars_define_z(&small, "--y", NULL), VBT_SUCCESS);
+    ASSERT_EQ(small.count, 1);
+    ASSERT_EQ(vbt_parse_vars_z(NULL, "red", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_vars_z(&small, "red", NULL), VBT_ERR);
+    ASSERT_EQ(vbt_parse_vars_z(&small, "", &recv), VBT_ERR);
+    ASSERT_EQ(vbt_parse_color_vars_z(&small, "var(--x", &color), VBT_ERR);
+    ASSERT_EQ(vbt_parse_color_vars_z(&small, "var(--x)", &color),
+              VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_validate) {
+  // clang-format off
+  const char* valid_input[] = {
+      "#fff",
+      "#ffffffff",
+      "rgb(255, 255, 255)",
+      "rgba(100%, 100%, 100%, 100%)",
+      "hsl(119.999999999, 50.000000001%, 50%)",
+      "hsl(16777216.999999999, 50%, 50%)",
+      "hsl(119.99999999999999999, 50%, 50%)",
+      "hsl(1.2e2, 5E1%, 50%)",
+      "hwb(0 100 0 / 1)",
+      "lch(53.23% 104.55 40 / 100%)",
+      "laba(53.23, 80.11, 67.22, 1)",
+      "oklch(0.627955 0.25766 29.233)",
+      "oklab(-0.5 +0.5 .5)",
+      "cornflowerblue",
+      "CORNFLOWERBLUE",
+      "color-mix(in oklch longer hue, red 10%, lab(50 20 30) 20%)",
+      "rgb(calc(255 / 2) calc(10% * 5) Calc(1))",
+      "hsla(calc((60 + 60) * 2), calc(50% - 10%), 50%, calc(1 / 2))",
+  };
+  const char* invalid_input[] = {
+      "",
+      "unknown",
+      "inherit",
+      "10px",
+      "var(--x)",
+      "#",
+      "#ff",
+      "#fffff",
+      "#ggg",
+      "#fff ;",
+      "xxx(0, 0, 0)",
+      "rgb(0, 0)",
+      "rgb(0, 0, 0, 0)",
+      "rgb(0 0, 0)",
+      "rgba(0, 0, 0)",
+      "rgb(0, 0, 0",
+      "rgb(0, 0, 0x)",
+      "hsl(16777217, 50%, 50%)",
+      "hsl(16777217.00000000000000000001, 50%, 50%)",
+      "color-mix(in srgb, red)",
+      "color-mix(in srgb, red, blue, lime)",
+      "color-mix(in srgb red, blue)",
+      "color-mix(srgb, red, blue)",
+      "color-mix(in hsl, red, blue)",
+      "color-mix(in srgb longer hue, red, blue)",
+      "color-mix(in oklch longer, red, blue)",
+      "color-mix(in srgb, red, blue",
+      "color-mix(in srgb, red), blue)",
+      "color-mix(in srgb, red 101%, blue)",
+      "color-mix(in srgb, red -1%, blue)",
+      "color-mix(in srgb, red 0%, blue 0%)",
+      "color-mix(in srgb, red 50, blue)",
+      "color-mix(in srgb, red50%, blue)",
+      "color-mix(in srgb, 50%, blue)",
+      "color-mix(in srgb, red 10% 10%, blue)",
+      "color-mix(in srgb, unknown, blue)",
+      "rgb(calc(1 + 10%) 0 0)",
+      "rgb(calc(10% * 10%) 0 0)",
+      "rgb(calc(1 / 10%) 0 0)",
+      "rgb(calc(1 / 0) 0 0)",
+      "rgb(calc(1)% 0 0)",
+      "rgb(calc() 0 0)",
+      "rgb(calc(1 +) 0 0)",
+      "rgb(calc(10+20) 0 0)",
+      "rgb(calc(10 +20) 0 0)",
+      "rgb(calc(10+ 20) 0 0)",
+      "rgb(calc(10--5) 0 0)",
+      "rgb(calc(- 50) 0 0)",
+      "rgb(calc(+ 50) 0 0)",
+      "rgb(calc(--5) 0 0)",
+      "rgb(calc(1 2) 0 0)",
+      "rgb(calc(1 0 0)",
+      "rgb(calc((1) 0 0)",
+      "rgb(cal(1) 0 0)",
+      "rgb(calc (1) 0 0)",
+      "rgb(calc(1px) 0 0)",
+      "rgb(calc(((((((((1))))))))) 0 0)",
+  };
+  // clang-format on
+
+  for (size_t i = 0; i < vu_arr_len(valid_input); i++) {
+    CASE(valid_input[i]) {
+      vbt_recv_t recv = vbt_recv_init();
+      ASSERT_EQ(vbt_validate(valid_input[i], strlen(valid_input[i])),
+                VBT_SUCCESS);
+      ASSERT_EQ(vbt_validate_z(valid_input[i]), VBT_SUCCESS);
+      ASSERT_EQ(vbt_parse_z(valid_input[i], &recv), VBT_SUCCESS);
+    }
+  }
+
+  for (size_t i = 0; i < vu_arr_len(invalid_input); i++) {
+    CASE(invalid_input[i]) {
+      vbt_recv_t recv = vbt_recv_init();
+      ASSERT_EQ(vbt_validate(invalid_input[i], strlen(invalid_input[i])),
+                VBT_ERR);
+      ASSERT_EQ(vbt_validate_z(invalid_input[i]), VBT_ERR);
+      ASSERT_EQ(vbt_parse_z(invalid_input[i], &recv), VBT_ERR);
+    }
+  }
+
+  CASE("invalid args") {
+    ASSERT_EQ(vbt_validate(NULL, 0), VBT_ERR);
+    ASSERT_EQ(vbt_validate("#fff", 0), VBT_ERR);
+    ASSERT_EQ(vbt_validate_z(NULL), VBT_ERR);
+    ASSERT_EQ(vbt_validate_z(long_string()), VBT_ERR);
+  }
+}
+
+TEST(vbt_parse_color) {
+  vbt_color_t color;
+  vbt_recv_t recv;
+  int err;
+
+  CASE("function args are normalized, not converted") {
+    err = vbt_parse_color_z("oklch(62.7955% 0.25766 29.233 / 50%)", &color);
+
+    ASSERT_EQ(err, VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_OKLCH);
+    ASSERT_FLOAT_EQ((float)color.arg[0], 0.627955f);
+    ASSERT_FLOAT_EQ((float)color.arg[1], 0.25766f);
+    ASSERT_FLOAT_EQ((float)color.arg[2], 29.233f);
+    ASSERT_FLOAT_EQ((float)color.arg[3], 0.5f);
+    ASSERT_EQ(color.unit[0], VBT_UNIT_PERCENT);
+    ASSERT_EQ(color.unit[1], VBT_UNIT_NUMBER);
+    ASSERT_EQ(color.unit[2], VBT_UNIT_NUMBER);
+    ASSERT_EQ(color.unit[3], VBT_UNIT_PERCENT);
+  }
+
+  CASE("resolve matches vbt_parse") {
+    const char* in = "lab(53.23 80.11 67.22 / 0.5)";
+    vbt_recv_t expected = vbt_recv_init();
+
+    ASSERT_EQ(vbt_parse_z(in, &expected), VBT_SUCCESS);
+    ASSERT_EQ(vbt_parse_color_z(in, &color), VBT_SUCCESS);
+
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, expected.u.val.u8.r, expected.u.val.u8.g,
+                   expected.u.val.u8.b, expected.u.val.u8.a);
+  }
+
+  CASE("resolve into many receivers") {
+    float r, g, b, a;
+
+    ASSERT_EQ(vbt_parse_color_z("hsl(120 100% 50%)", &color), VBT_SUCCESS);
+
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, 0, 255, 0, 255);
+
+    recv = vbt_recv_init_ref_f32(&r, &g, &b, &a);
+    ASSERT_EQ(vbt_color_resolve(&color, &recv), VBT_SUCCESS);
+    ASSERT_FLOAT_EQ(r, 0.0f);
+    ASSERT_FLOAT_EQ(g, 1.0f);
+    ASSERT_FLOAT_EQ(b, 0.0f);
+    ASSERT_FLOAT_EQ(a, 1.0f);
+  }
+
+  CASE("hex and names hold rgb") {
+    ASSERT_EQ(vbt_parse_color_z("#ff000080", &color), VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_RGB);
+    ASSERT_FLOAT_EQ((float)color.arg[0], 255.0f);
+    ASSERT_FLOAT_EQ((float)color.arg[1], 0.0f);
+
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, 255, 0, 0, 128);
+
+    ASSERT_EQ(vbt_parse_color_z("cornflowerblue", &color), VBT_SUCCESS);
+    ASSERT_EQ(color.fn, VBT_COLOR_RGB);
+
+    recv = vbt_recv_init();
+    err = vbt_color_resolve(&color, &recv);
+    ASSERT_RECV_U8(err, recv, 0x64, 0x95, 0xed, 255);
+  }
+
+  CASE("errors") {
+    ASSERT_EQ(vbt_parse_color_z("#fff", NULL), VBT_ERR);
+    ASSERT_EQ(vbt_parse_color_z(NULL, &color), VBT_ERR);
+    ASSERT_EQ(vbt_parse_color_z("unknown", &color), VBT_ERR);
+    ASSERT_EQ(vbt_parse_color(long_string(), strlen(long_string()), &color),
+              VBT_ERR);
+  }
+}
+
 // string that exceeds vibrant's parser string limit of 128. returned value
 // is from static memory.
 static const char* long_string(void) {
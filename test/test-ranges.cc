@@ -0,0 +1,118 @@
+#include "test-common.h"
+
+#include <array>
+#include <forward_list>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+static_assert(std::ranges::forward_range<decltype(std::vector<std::string>() |
+                                                  vbt::views::parse)>);
+static_assert(std::ranges::sized_range<decltype(std::vector<std::string>() |
+                                                vbt::views::parse)>);
+
+TEST(vbt_views_parse) {
+  const std::vector<std::string_view> values = {
+      "red", "#00ff00", "notacolor", "blue", "rgb(1, 2)", "white",
+  };
+
+  CASE("all elements") {
+    std::vector<std::optional<vbt::rgba8>> colors;
+
+    for (auto color : values | vbt::views::parse) {
+      colors.push_back(color);
+    }
+
+    ASSERT_EQ(colors.size(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      vbt::rgba8 expected;
+      int err = vbt::parse(values[i].data(), values[i].size(), expected);
+      ASSERT_EQ(colors[i].has_value(), err == VBT_SUCCESS);
+      if (colors[i]) {
+        ASSERT_EQ(*colors[i] == expected, true);
+      }
+    }
+  }
+
+  CASE("lazy, with early termination") {
+    size_t reads = 0;
+    auto count_reads = [&reads](std::string_view value) {
+      reads++;
+      return value;
+    };
+    auto valid = [](const auto& color) { return color.has_value(); };
+    size_t taken = 0;
+
+    for (auto color : values | std::views::transform(count_reads) |
+                          vbt::views::parse | std::views::take_while(valid)) {
+      ASSERT_EQ(color.has_value(), true);
+      taken++;
+    }
+
+    // take_while and the loop both read an element, it is parsed once.
+    // "notacolor" stops the loop, nothing after it is read.
+    ASSERT_EQ(taken, 2);
+    ASSERT_EQ(reads, 3);
+  }
+
+  CASE("filter, parse_as") {
+    std::vector<vbt::rgba_f32> colors;
+
+    for (auto color : std::views::all(values) |
+                          vbt::views::parse_as<vbt::rgba_f32> |
+                          std::views::filter([](const auto& color) {
+                            return color.has_value();
+                          })) {
+      colors.push_back(*color);
+    }
+
+    ASSERT_EQ(colors.size(), 4);
+    ASSERT_FLOAT_EQ(colors[1].g, 1.0f);
+    ASSERT_FLOAT_EQ(colors[3].b, 1.0f);
+  }
+
+  CASE("forward_list, called") {
+    std::forward_list<std::string> list = {"lime", "#0000"};
+    auto view = vbt::views::parse(list);
+    auto it = view.begin();
+
+    ASSERT_EQ((*it)->g, 255);
+    ++it;
+    ASSERT_EQ((*it)->a, 0);
+    ASSERT_EQ(++it == view.end(), true);
+  }
+}
+
+TEST(vbt_views_convert) {
+  const std::vector<std::tuple<float, float, float, float>> args = {
+      {0.5f, 0.1f, -0.1f, 1.0f},
+      {0.7f, 0.0f, 0.0f, NAN},
+      {0.0f, 0.0f, 0.0f, 0.5f},
+  };
+  std::vector<std::optional<vbt::rgba_f64>> colors;
+
+  for (auto color : args | vbt::views::convert<VBT_COLOR_OKLAB,
+                                               vbt::rgba_f64>) {
+    colors.push_back(color);
+  }
+
+  vbt::rgba_f64 expected;
+  vbt::oklab(0.5f, 0.1f, -0.1f, 1, expected);
+
+  ASSERT_EQ(colors.size(), 3);
+  ASSERT_DOUBLE_EQ(colors[0]->r, expected.r);
+  ASSERT_DOUBLE_EQ(colors[0]->g, expected.g);
+  ASSERT_EQ(colors[1].has_value(), false);
+  ASSERT_DOUBLE_EQ(colors[2]->a, 0.5);
+
+  CASE("rgba8 default, arrays") {
+    const std::array<int, 4> hsl[] = {{120, 100, 50, 1}};
+    auto view = hsl | vbt::views::convert<VBT_COLOR_HSL>;
+
+    ASSERT_EQ(view.size(), 1);
+    ASSERT_EQ(*view.front() == (vbt::rgba8{0, 255, 0, 255}), true);
+  }
+}
@@ -0,0 +1,133 @@
+#include "test-common.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+static std::vector<vbt::scan_record> scan_all(vbt::scanner& scan) {
+  std::vector<vbt::scan_record> records;
+
+  for (const vbt::scan_record& record : scan) {
+    records.push_back(record);
+  }
+
+  return records;
+}
+
+static const char* const scan_input =
+    "a { color: red; background: #00ff0080 } bored\n"
+    "b { border: 1px solid rgb(0 0 255 / 50%); x: notacolor(1) }\n"
+    "c { fill: hsl(120, 100%, 25%) }";
+
+TEST(vbt_scan_generator) {
+  const std::string_view input(scan_input);
+  vbt::scanner scan = vbt::scan_generator(input);
+  std::vector<vbt::scan_record> records = scan_all(scan);
+
+  ASSERT_EQ(scan.done(), true);
+  ASSERT_EQ(records.size(), 4);
+  ASSERT_EQ(input.substr(records[0].offset, records[0].length) == "red", true);
+  ASSERT_EQ(input.substr(records[1].offset, records[1].length) == "#00ff0080",
+            true);
+  ASSERT_EQ(input.substr(records[2].offset, records[2].length) ==
+                "rgb(0 0 255 / 50%)",
+            true);
+  ASSERT_EQ(input.substr(records[3].offset, records[3].length) ==
+                "hsl(120, 100%, 25%)",
+            true);
+  ASSERT_EQ(records[0].color == (vbt::rgba8{255, 0, 0, 255}), true);
+  ASSERT_EQ(records[2].color == (vbt::rgba8{0, 0, 255, 128}), true);
+
+  CASE("empty and colorless input") {
+    vbt::scanner empty = vbt::scan_generator("");
+    vbt::scanner words = vbt::scan_generator("no colors (here) #xyz");
+    ASSERT_EQ(scan_all(empty).size(), 0);
+    ASSERT_EQ(scan_all(words).size(), 0);
+    ASSERT_EQ(words.done(), true);
+  }
+
+  CASE("color at end of input") {
+    vbt::scanner end = vbt::scan_generator("color: blue");
+    std::vector<vbt::scan_record> found = scan_all(end);
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0].offset, 7);
+    ASSERT_EQ(found[0].color.b, 255);
+  }
+
+  CASE("unclosed function") {
+    std::string text = "rgb(1 2 3" + std::string(200, ' ') + "red";
+    vbt::scanner unclosed = vbt::scan_generator(text);
+    std::vector<vbt::scan_record> found = scan_all(unclosed);
+    ASSERT_EQ(found.size(), 1);
+    ASSERT_EQ(found[0].offset, text.size() - 3);
+  }
+
+  CASE("nested parentheses") {
+    const std::string_view text =
+        "a: color-mix(in srgb, rgb(1 2 3), red); b: rgb(calc(1 + 2) 0 0)";
+    vbt::scanner nested = vbt::scan_generator(text);
+    std::vector<vbt::scan_record> found = scan_all(nested);
+    ASSERT_EQ(found.size(), 2);
+    ASSERT_EQ(text.substr(found[0].offset, found[0].length) ==
+                  "color-mix(in srgb, rgb(1 2 3), red)",
+              true);
+    ASSERT_EQ(text.substr(found[1].offset, found[1].length) ==
+                  "rgb(calc(1 + 2) 0 0)",
+              true);
+    ASSERT_EQ(found[1].color == (vbt::rgba8{3, 0, 0, 255}), true);
+  }
+
+  CASE("begin() twice does not skip a color") {
+    vbt::scanner twice = vbt::scan_generator("red blue");
+    twice.begin();
+    vbt::scanner::iterator it = twice.begin();
+    ASSERT_EQ(it->color.r, 255);
+    ++it;
+    ASSERT_EQ(it->color.b, 255);
+  }
+}
+
+// every split of the input into chunks finds the same colors
+TEST(vbt_scan_generator_chunks) {
+  const std::string_view input(scan_input);
+  vbt::scanner whole = vbt::scan_generator(input);
+  const std::vector<vbt::scan_record> expected = scan_all(whole);
+  static const size_t chunk_sizes[] = {1, 2, 3, 7, 16, 64};
+
+  for (size_t c = 0; c < vu_arr_len(chunk_sizes); c++) {
+    CASE("chunk size") {
+      const size_t size = chunk_sizes[c];
+      std::vector<vbt::scan_record> records;
+      std::string chunk(input.substr(0, size));
+      vbt::scanner scan = vbt::scan_generator(chunk, false);
+      size_t pos = size;
+
+      for (;;) {
+        for (const vbt::scan_record& record : scan) {
+          records.push_back(record);
+        }
+        if (scan.done()) {
+          break;
+        }
+
+        ASSERT_EQ(scan.needs_input(), true);
+        if (pos >= input.size()) {
+          scan.finish();
+          continue;
+        }
+
+        // overwrites the previous chunk, the scan must not read it again
+        chunk.assign(input.substr(pos, size));
+        pos += size;
+        scan.feed(chunk);
+      }
+
+      ASSERT_EQ(records.size(), expected.size());
+      for (size_t i = 0; i < records.size(); i++) {
+        ASSERT_EQ(records[i].offset, expected[i].offset);
+        ASSERT_EQ(records[i].length, expected[i].length);
+        ASSERT_EQ(records[i].color == expected[i].color, true);
+      }
+    }
+  }
+}
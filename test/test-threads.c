@@ -0,0 +1,132 @@
+#include "test-common.h"
+
+// enough items for many chunks, with skewed lengths and some failures
+#define THREADS_BATCH_LEN (20011)
+
+static const char* const threads_input[] = {
+    "red",
+    "#abc",
+    "lightgoldenrodyellow",
+    "rgba(10%, 20%, 30%, 0.4)",
+    "oklch(0.4 0.2 -90 / 75%)",
+    "lab(52.2345% 40.1645 59.9971)",
+    "notacolor",
+    "hsl(1, 2 3)",
+};
+
+static const char* threads_value(size_t i) {
+  // long runs of the same kind leave static partitions unbalanced
+  return threads_input[(i / 1000 + i % 3) % vu_arr_len(threads_input)];
+}
+
+TEST(vbt_parse_batch_mt) {
+  static const char* values[THREADS_BATCH_LEN];
+  static vbt_recv_t recv[THREADS_BATCH_LEN];
+  static vbt_recv_t expected[THREADS_BATCH_LEN];
+  static int err[THREADS_BATCH_LEN];
+  static int expected_err[THREADS_BATCH_LEN];
+  static const unsigned threads[] = {1, 2, 3, 8, 0};
+  int expected_res;
+
+  for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+    values[i] = threads_value(i);
+    expected[i] = vbt_recv_init();
+  }
+
+  expected_res = vbt_parse_batch(values, NULL, THREADS_BATCH_LEN, expected,
+                                 expected_err);
+  ASSERT_EQ(expected_res, VBT_ERR);
+
+  for (size_t t = 0; t < vu_arr_len(threads); t++) {
+    CASE("pool") {
+      vbt_pool_t* pool = vbt_pool_create(threads[t]);
+      ASSERT_EQ(pool != NULL, 1);
+
+      // a pool is reused across batches
+      for (int run = 0; run < 3; run++) {
+        for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+          recv[i] = vbt_recv_init();
+          err[i] = 42;
+        }
+
+        ASSERT_EQ(vbt_parse_batch_mt(pool, values, NULL, THREADS_BATCH_LEN,
+                                     recv, err),
+                  expected_res);
+
+        for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+          ASSERT_EQ(err[i], expected_err[i]);
+          ASSERT_EQ(recv[i].u.val.u8.r, expected[i].u.val.u8.r);
+          ASSERT_EQ(recv[i].u.val.u8.g, expected[i].u.val.u8.g);
+          ASSERT_EQ(recv[i].u.val.u8.b, expected[i].u.val.u8.b);
+          ASSERT_EQ(recv[i].u.val.u8.a, expected[i].u.val.u8.a);
+        }
+      }
+
+      vbt_pool_destroy(pool);
+    }
+  }
+
+  CASE("built-in pool") {
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, values, NULL, THREADS_BATCH_LEN, recv,
+                                 err),
+              expected_res);
+    for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+      ASSERT_EQ(err[i], expected_err[i]);
+    }
+
+    // all valid items
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, values, NULL, 3, recv, NULL),
+              VBT_SUCCESS);
+
+    // it is created again after it is destroyed
+    vbt_pool_destroy_default();
+    vbt_pool_destroy_default();
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, values, NULL, THREADS_BATCH_LEN, recv,
+                                 err),
+              expected_res);
+    vbt_pool_destroy_default();
+  }
+
+  CASE("invalid arguments") {
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, NULL, NULL, 1, recv, err), VBT_ERR);
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, values, NULL, 1, NULL, err), VBT_ERR);
+    ASSERT_EQ(vbt_parse_batch_mt(NULL, NULL, NULL, 0, NULL, NULL),
+              VBT_SUCCESS);
+  }
+}
+
+TEST(vbt_color_resolve_batch_mt) {
+  static vbt_color_t colors[THREADS_BATCH_LEN];
+  static vbt_recv_t recv[THREADS_BATCH_LEN];
+  static int err[THREADS_BATCH_LEN];
+  vbt_pool_t* pool = vbt_pool_create(4);
+
+  ASSERT_EQ(pool != NULL, 1);
+
+  for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+    vbt_number_t hue = (vbt_number_t)(i % 360);
+    vbt_number_t alpha = i % 1000 == 7 ? NAN : 1;
+    colors[i] = vbt_color_init(VBT_COLOR_HSL, hue, 100, 50, alpha);
+    recv[i] = vbt_recv_init();
+  }
+
+  ASSERT_EQ(vbt_color_resolve_batch_mt(pool, colors, THREADS_BATCH_LEN, recv,
+                                       err),
+            VBT_ERR);
+
+  for (size_t i = 0; i < THREADS_BATCH_LEN; i++) {
+    vbt_recv_t expected = vbt_recv_init();
+    vbt_number_t hue = (vbt_number_t)(i % 360);
+
+    if (i % 1000 == 7) {
+      ASSERT_EQ(err[i], VBT_ERR);
+      continue;
+    }
+
+    ASSERT_EQ(vbt_hsl(hue, 100, 50, 1, &expected), VBT_SUCCESS);
+    ASSERT_RECV_U8(err[i], recv[i], expected.u.val.u8.r, expected.u.val.u8.g,
+                   expected.u.val.u8.b, expected.u.val.u8.a);
+  }
+
+  vbt_pool_destroy(pool);
+}